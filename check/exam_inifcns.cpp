@@ -191,6 +191,59 @@ static unsigned inifcns_consist_psi()
 	return result;
 }
 
+/* Numerical tests on the gamma and psi functions, at a precision where the
+ * Lanczos coefficients are used and at one where they are not. */
+static unsigned inifcns_evalf_gamma()
+{
+	using GiNaC::log;
+	using GiNaC::tgamma;
+	using GiNaC::lgamma;
+
+	unsigned result = 0;
+	const int digits[] = { 17, 120 };
+	for (int d=0; d<2; ++d) {
+		Digits = digits[d];
+		const ex prec = pow(10, 5 - (ex)Digits);
+		const numeric x1 = ex_to<numeric>(numeric(7,2).evalf());
+		const numeric z1 = ex_to<numeric>((numeric(3,10) + 2*I).evalf());
+
+		exvector vals, refs;
+		vals.push_back(tgamma(x1).evalf());
+		refs.push_back((numeric(15,8)*sqrt(Pi)).evalf());
+		vals.push_back(exp(lgamma(z1)).evalf());
+		refs.push_back(tgamma(z1).evalf());
+		vals.push_back(lgamma(x1 + 7).evalf());
+		refs.push_back(log(tgamma(x1 + 7)).evalf());
+		vals.push_back(psi(numeric(1).evalf()).evalf());
+		refs.push_back((-Euler).evalf());
+		vals.push_back(psi(numeric(-1,2).evalf()).evalf());
+		refs.push_back((2 - Euler - 2*log(2)).evalf());
+		vals.push_back(psi(1, numeric(1).evalf()).evalf());
+		refs.push_back((pow(Pi, 2)/6).evalf());
+		vals.push_back(psi(2, numeric(1).evalf()).evalf());
+		refs.push_back((-2*zeta(3)).evalf());
+		exvector x;
+		x.push_back(x1);
+		x.push_back(z1);
+		const exvector batch = evalf_tgamma(x);
+		for (size_t i=0; i<x.size(); ++i) {
+			vals.push_back(batch[i]);
+			refs.push_back(tgamma(x[i]).evalf());
+		}
+
+		for (size_t i=0; i<vals.size(); ++i) {
+			if (!is_a<numeric>(vals[i]) || abs(vals[i] - refs[i]) > prec*abs(refs[i])) {
+				clog << "numerical test " << i << " of gamma and psi at Digits=" << Digits
+				     << " erroneously returned " << vals[i] << " instead of " << refs[i] << endl;
+				++result;
+			}
+		}
+	}
+	Digits = 17;
+
+	return result;
+}
+
 /* Simple tests on the Riemann Zeta function.  We stuff in arguments where the
  * result exists in closed form and check if it's ok.  Of course, this checks
  * the Bernoulli numbers as a side effect. */
@@ -337,6 +390,54 @@ static unsigned inifcns_consist_various()
 	return result;
 }
 
+/* Test finding all roots of a function numerically. */
+static unsigned inifcns_fsolve_all()
+{
+	unsigned result = 0;
+	symbol x("x");
+
+	// Roots at 0, Pi, 2*Pi and 3*Pi
+	const lst roots = fsolve_all(sin(x), x, -1, 10);
+	if (roots.nops() != 4) {
+		clog << "ERROR: fsolve_all(sin(x),x,-1,10) erroneously returned " << roots << endl;
+		++result;
+	} else {
+		for (size_t k=0; k<roots.nops(); ++k) {
+			if (abs(ex_to<numeric>(roots.op(k)) - ex_to<numeric>(k*Pi.evalf())) > 1e-14) {
+				clog << "ERROR: fsolve_all(sin(x),x,-1,10) erroneously returned " << roots << endl;
+				++result;
+				break;
+			}
+		}
+	}
+
+	// Both roots of the quadratic in one call
+	const lst roots2 = fsolve_all(pow(x, 2) == 2, x, -2, 2, 10);
+	if (roots2.nops() != 2
+	 || abs(ex_to<numeric>(roots2.op(0)) + sqrt(numeric(2))) > 1e-14
+	 || abs(ex_to<numeric>(roots2.op(1)) - sqrt(numeric(2))) > 1e-14) {
+		clog << "ERROR: fsolve_all(x^2==2,x,-2,2) erroneously returned " << roots2 << endl;
+		++result;
+	}
+
+	// The same with the interval split among worker processes
+	const lst roots3 = fsolve_all(sin(x), x, -1, 10, 1000, 3);
+	if (roots3.nops() != roots.nops()) {
+		clog << "ERROR: fsolve_all(sin(x),x,-1,10,1000,3) erroneously returned " << roots3 << endl;
+		++result;
+	} else {
+		for (size_t k=0; k<roots.nops(); ++k) {
+			if (abs(ex_to<numeric>(roots3.op(k)) - ex_to<numeric>(roots.op(k))) > 1e-14) {
+				clog << "ERROR: fsolve_all(sin(x),x,-1,10,1000,3) erroneously returned " << roots3 << endl;
+				++result;
+				break;
+			}
+		}
+	}
+
+	return result;
+}
+
 unsigned exam_inifcns()
 {
 	unsigned result = 0;
@@ -346,11 +447,13 @@ unsigned exam_inifcns()
 	result += inifcns_consist_trans();  cout << '.' << flush;
 	result += inifcns_consist_gamma();  cout << '.' << flush;
 	result += inifcns_consist_psi();  cout << '.' << flush;
+	result += inifcns_evalf_gamma();  cout << '.' << flush;
 	result += inifcns_consist_zeta();  cout << '.' << flush;
 	result += inifcns_consist_abs();  cout << '.' << flush;
 	result += inifcns_consist_exp();  cout << '.' << flush;
 	result += inifcns_consist_log();  cout << '.' << flush;
 	result += inifcns_consist_various();  cout << '.' << flush;
+	result += inifcns_fsolve_all();  cout << '.' << flush;
 	
 	return result;
 }
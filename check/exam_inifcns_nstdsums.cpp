@@ -22,10 +22,14 @@
  */
 
 #include "ginac.h"
+#include "worker_processes.h"
 using namespace GiNaC;
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 using namespace std;
 
 
@@ -366,6 +370,433 @@ static unsigned inifcns_test_legacy()
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+//  tables exam - Bernoulli numbers and saved coefficient tables
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+
+static unsigned inifcns_test_tables()
+{
+	unsigned result = 0;
+
+	// The table of Bernoulli numbers is rebuilt when it grows
+	if (bernoulli(60) != numeric("-1215233140483755572040304994079820246041491/56786730")
+	 || bernoulli(20) != numeric(-174611, 330)) {
+		clog << "Bernoulli numbers seem to be wrong." << endl;
+		result++;
+	}
+
+	Digits = 60;
+	const ex x = numeric(2, 5);
+	const ex r1 = Li(6, x).evalf();
+
+	// The tables survive a round trip through a stream
+	stringstream tables;
+	write_polylog_tables(tables);
+	const string saved = tables.str();
+	read_polylog_tables(tables);
+	stringstream again;
+	write_polylog_tables(again);
+	if (again.str() != saved) {
+		clog << "read_polylog_tables() did not restore the tables." << endl;
+		result++;
+	}
+	const ex r2 = Li(6, x).evalf();
+	if (!(r1 - r2).is_zero()) {
+		clog << "Li(6,2/5) changed after reading the tables." << endl;
+		result++;
+	}
+
+	// Tables built in worker processes give the sum of the series
+	build_polylog_tables(9, 201, 2);
+	stringstream built;
+	write_polylog_tables(built);
+	string magic;
+	int version = 0, rows = 0, length = 0;
+	built >> magic >> version >> rows >> length;
+	if (rows < 8 || length != 202) {
+		clog << "build_polylog_tables() built " << rows << " tables of length " << length
+		     << " instead of 8 of length 202." << endl;
+		result++;
+	}
+	numeric sum = 0, xk = 1;
+	for (int k=1; k<=200; ++k) {
+		xk *= numeric(2, 5);
+		sum += xk / numeric(k).power(8);
+	}
+	const ex r3 = Li(8, x).evalf();
+	if (abs(ex_to<numeric>(r3 - sum.evalf())) > numeric(1, 10).power(50)) {
+		clog << "Li(8,2/5) erroneously evaluated to " << r3 << " with built tables." << endl;
+		result++;
+	}
+
+	stringstream bad("ginac-polylog-tables 1 2 25");
+	try {
+		read_polylog_tables(bad);
+		clog << "read_polylog_tables() accepted malformed tables." << endl;
+		result++;
+	} catch (const std::runtime_error &) {}
+
+	Digits = 17;
+	return result;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  batch exam - evaluation at many points
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+
+static unsigned inifcns_test_batch()
+{
+	unsigned result = 0;
+	Digits = 17;
+	const ex prec = 5 * pow(10, -(ex)Digits);
+
+	// The transformations are cached by the ordering of |a_i| and y and by
+	// their coincidences, so the references must not go through G.  With
+	//   G(0,a;y) = -Li2(y/a),  G(a,0;y) = log(y)*log(1-y/a) + Li2(y/a)
+	// the points lie below, at and above |a| for the real a.
+	const ex avals[] = { numeric(-3, 2), numeric(-1, 2) + I };
+	exvector y;
+	for (int i=1; i<=12; ++i)
+		y.push_back(numeric(i, 4));
+	for (int k=0; k<2; ++k) {
+		const ex & a = avals[k];
+		const lst a0(a, 0), za(0, a);
+		const exvector ga0 = evalf_G(a0, y);
+		const exvector gza = evalf_G(za, y);
+		for (size_t i=0; i<y.size(); ++i) {
+			const ex ref_za = (-Li(2, y[i]/a)).evalf();
+			const ex ref_a0 = (log(y[i])*log(1-y[i]/a) + Li(2, y[i]/a)).evalf();
+			if (!is_a<numeric>(gza[i]) || abs(gza[i] - ref_za) > prec*abs(ref_za)) {
+				clog << "evalf_G(" << za << ", " << y[i] << ") erroneously returned "
+				     << gza[i] << " (instead of " << ref_za << ")" << endl;
+				result++;
+			}
+			if (!is_a<numeric>(ga0[i]) || abs(ga0[i] - ref_a0) > prec*abs(ref_a0)) {
+				clog << "evalf_G(" << a0 << ", " << y[i] << ") erroneously returned "
+				     << ga0[i] << " (instead of " << ref_a0 << ")" << endl;
+				result++;
+			}
+		}
+	}
+
+	// For negative a and b,
+	//   G(a,b;y) = log(1-a/b)*log(1-y/a) - Li2((y-a)/(b-a)) + Li2(a/(a-b)).
+	// The point y=1 coincides with |a|, y=2 with |b|, while y=3 and y=4
+	// have the ordering of y=2 without the coincidence.
+	const ex a1 = -1, b1 = -2;
+	const lst ab(a1, b1);
+	exvector yab;
+	for (int i=1; i<=8; ++i)
+		yab.push_back(numeric(i, 2));
+	const exvector gab = evalf_G(ab, yab);
+	for (size_t i=0; i<yab.size(); ++i) {
+		const ex ref = (log(1-a1/b1)*log(1-yab[i]/a1) - Li(2, (yab[i]-a1)/(b1-a1))
+		                + Li(2, a1/(a1-b1))).evalf();
+		if (!is_a<numeric>(gab[i]) || abs(gab[i] - ref) > prec*abs(ref)) {
+			clog << "evalf_G(" << ab << ", " << yab[i] << ") erroneously returned "
+			     << gab[i] << " (instead of " << ref << ")" << endl;
+			result++;
+		}
+	}
+
+	const lst m(1, -2, 1);
+	exvector x;
+	for (int i=1; i<=12; ++i)
+		x.push_back(numeric(i, 5));
+	x.push_back(numeric(-9, 5));
+	x.push_back(numeric(1, 2) + I);
+	const exvector h = evalf_H(m, x);
+	for (size_t i=0; i<x.size(); ++i) {
+		const ex ref = H(m, x[i]).evalf();
+		if (!is_a<numeric>(ref))  // not evaluated numerically
+			continue;
+		if (!is_a<numeric>(h[i]) || abs(h[i] - ref) > prec*abs(ref)) {
+			clog << "evalf_H(" << m << ", " << x[i] << ") erroneously returned "
+			     << h[i] << " (instead of " << ref << ")" << endl;
+			result++;
+		}
+	}
+
+	// the same in worker processes
+	const exvector gabp = evalf_G(ab, yab, 2);
+	for (size_t i=0; i<yab.size(); ++i) {
+		if (!is_a<numeric>(gabp[i]) || abs(gabp[i] - gab[i]) > prec*abs(gab[i])) {
+			clog << "evalf_G(" << ab << ", " << yab[i] << ", 2) erroneously returned "
+			     << gabp[i] << " (instead of " << gab[i] << ")" << endl;
+			result++;
+		}
+	}
+	const exvector hp = evalf_H(m, x, 2);
+	for (size_t i=0; i<x.size(); ++i) {
+		if (!is_a<numeric>(h[i]))
+			continue;
+		if (!is_a<numeric>(hp[i]) || abs(hp[i] - h[i]) > prec*abs(h[i])) {
+			clog << "evalf_H(" << m << ", " << x[i] << ", 2) erroneously returned "
+			     << hp[i] << " (instead of " << h[i] << ")" << endl;
+			result++;
+		}
+	}
+
+	return result;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  binary splitting exam - exact arguments at high precision
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+
+static unsigned inifcns_test_binsplit()
+{
+	unsigned result = 0;
+	Digits = 200;
+	const ex prec = 5 * pow(10, -(ex)Digits + 5);
+
+	// exact arguments are summed by binary splitting, floating point ones
+	// term by term
+	const numeric x1(1, 5), x2(-1, 3), x3 = numeric(1, 4) + numeric(1, 5)*I;
+	exvector exact, inexact;
+	exact.push_back(Li2(x2));
+	inexact.push_back(Li2(x2.evalf()));
+	exact.push_back(Li(3, x1));
+	inexact.push_back(Li(3, x1.evalf()));
+	exact.push_back(Li(5, x3));
+	inexact.push_back(Li(5, x3.evalf()));
+	exact.push_back(Li(lst(2,1), lst(x2, x1)));
+	inexact.push_back(Li(lst(2,1), lst(x2.evalf(), x1.evalf())));
+	exact.push_back(S(2, 2, x1));
+	inexact.push_back(S(2, 2, x1.evalf()));
+	exact.push_back(H(lst(3,1), x2));
+	inexact.push_back(H(lst(3,1), x2.evalf()));
+
+	for (size_t i=0; i<exact.size(); ++i) {
+		const ex e1 = exact[i].evalf();
+		const ex e2 = inexact[i].evalf();
+		if (!is_a<numeric>(e1) || abs(e1 - e2) > prec*abs(e2)) {
+			clog << exact[i] << " erroneously evaluated to " << e1
+			     << " (instead of " << e2 << ")" << endl;
+			result++;
+		}
+	}
+
+	return result;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  shared evaluation exam - repeated calls in large sums
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+
+/** Numerical values of Li(2, i/7) times a symbol, computed by workers. */
+class li2_jobs : public worker_jobs
+{
+public:
+	li2_jobs(const symbol & x_) : x(x_) {}
+	exvector compute(size_t i) { return exvector(1, x*Li(2, numeric(i+1, 7)).evalf()); }
+private:
+	symbol x;
+};
+
+static unsigned inifcns_test_shared()
+{
+	unsigned result = 0;
+	Digits = 30;
+	const ex prec = 5 * pow(10, -(ex)Digits);
+
+	ex e;
+	for (int i=1; i<=10; ++i)
+		e += Li(2, numeric(1,3)) * Li(3, numeric(i,20)) + H(lst(1,2), numeric(1,5)) * pow(zeta(3), i);
+
+	const ex e1 = evalf_shared(e);
+	const ex e2 = e.evalf();
+	if (!is_a<numeric>(e1) || abs(e1 - e2) > prec*abs(e2)) {
+		clog << "evalf_shared(" << e << ") erroneously returned " << e1
+		     << " (instead of " << e2 << ")" << endl;
+		result++;
+	}
+
+	for (unsigned processes=1; processes<=3; ++processes) {
+		const ex e3 = evalf_parallel(e, processes);
+		if (!is_a<numeric>(e3) || abs(e3 - e2) > prec*abs(e2)) {
+			clog << "evalf_parallel(" << e << ", " << processes << ") erroneously returned "
+			     << e3 << " (instead of " << e2 << ")" << endl;
+			result++;
+		}
+	}
+
+	// The final evaluation of evalf_parallel() computes whatever the
+	// workers failed to deliver, so check the workers by themselves
+	if (have_worker_processes()) {
+		const symbol x("x");
+		li2_jobs jobs(x);
+		std::vector<exvector> values;
+		std::vector<bool> done;
+		const size_t n = 5;
+		const size_t count = compute_in_processes(jobs, n, 2, lst(x), values, done);
+		if (count != n) {
+			clog << "worker processes delivered " << count << " of " << n << " results" << endl;
+			result++;
+		}
+		for (size_t i=0; i<n; ++i) {
+			if (!done[i])
+				continue;
+			const exvector ref = jobs.compute(i);
+			if (values[i].size() != 1 || !(values[i][0] - ref[0]).is_zero()) {
+				clog << "worker process erroneously returned " << values[i][0]
+				     << " (instead of " << ref[0] << ")" << endl;
+				result++;
+			}
+		}
+	}
+
+	return result;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  multiple zeta value exam - relations to a basis
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+
+static unsigned inifcns_test_zeta_relations()
+{
+	unsigned result = 0;
+	Digits = 40;
+	const ex prec = 5 * pow(10, -(ex)Digits);
+
+	// start from and leave behind the built-in relations only
+	reset_zeta_relations();
+
+	if (!reduce_zeta(zeta(lst(2,1)) + zeta(lst(3,2))).is_equal(zeta(3) + 3*zeta(2)*zeta(3) - numeric(11,2)*zeta(5))) {
+		clog << "reduce_zeta() failed on built-in relations" << endl;
+		result++;
+	}
+
+	// zeta(5,1) by summation, then by Euler's relation
+	const ex direct = zeta(lst(5,1)).evalf();
+	std::istringstream rel("# Euler\n\nzeta({5,1}) = 3/4*zeta(6)-1/2*zeta(3)^2\n");
+	read_zeta_relations(rel);
+	const ex reduced = zeta(lst(5,1)).evalf();
+	if (!is_a<numeric>(reduced) || abs(reduced - direct) > prec*abs(direct)) {
+		clog << "zeta({5,1}) by relation erroneously returned " << reduced
+		     << " (instead of " << direct << ")" << endl;
+		result++;
+	}
+	if (!reduce_zeta(zeta(lst(5,1))).is_equal(numeric(3,4)*zeta(6) - numeric(1,2)*pow(zeta(3),2))) {
+		clog << "reduce_zeta() failed on a relation read" << endl;
+		result++;
+	}
+
+	reset_zeta_relations();
+	if (!reduce_zeta(zeta(lst(5,1))).is_equal(zeta(lst(5,1)))) {
+		clog << "reset_zeta_relations() kept a relation read" << endl;
+		result++;
+	}
+
+	// the same relation with two large terms that cancel numerically only,
+	// read on its own
+	std::istringstream big("zeta({5,1}) = 3/4*zeta(6)-1/2*zeta(3)^2"
+	                       "+10^30*zeta({2,1})-10^30*zeta(3)\n");
+	read_zeta_relations(big);
+	const ex cancelled = zeta(lst(5,1)).evalf();
+	if (!is_a<numeric>(cancelled) || abs(cancelled - direct) > prec*abs(direct)) {
+		clog << "zeta({5,1}) by a cancelling relation erroneously returned " << cancelled
+		     << " (instead of " << direct << ")" << endl;
+		result++;
+	}
+
+	std::istringstream bad("zeta({1,2}) = zeta(3)\n");
+	try {
+		read_zeta_relations(bad);
+		clog << "read_zeta_relations() accepted a divergent multiple zeta value" << endl;
+		result++;
+	} catch (const std::runtime_error &e) { }
+
+	reset_zeta_relations();
+
+	return result;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  accuracy exam - evaluation to a target accuracy
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+
+static unsigned inifcns_test_accuracy()
+{
+	unsigned result = 0;
+	Digits = 17;
+	const numeric accuracy = numeric(10).power(-60);
+	numeric error;
+
+	// zeta(3) minus its first 40 digits cancels to order 10^-40
+	const ex e1 = zeta(3) - numeric("1202056903159594285399738161511449990764/1000000000000000000000000000000000000000");
+	const ex r1 = evalf_to_accuracy(e1, accuracy, error);
+	if (Digits != 17) {
+		clog << "evalf_to_accuracy() did not restore Digits." << endl;
+		result++;
+	}
+	Digits = 100;
+	const ex ref1 = e1.evalf();
+	Digits = 17;
+	if (abs(ex_to<numeric>(r1) - ex_to<numeric>(ref1)) > accuracy || error > accuracy) {
+		clog << "evalf_to_accuracy(" << e1 << ") erroneously returned " << r1
+		     << " with error " << error << " (instead of " << ref1 << ")" << endl;
+		result++;
+	}
+
+	// Euler's reflection formula for the dilogarithm
+	const ex x = numeric(1, 3);
+	const ex e2 = Li(2, x) + Li(2, 1-x) + log(x)*log(1-x) - zeta(2);
+	const ex r2 = evalf_to_accuracy(e2, accuracy, error);
+	if (abs(ex_to<numeric>(r2)) > accuracy) {
+		clog << "evalf_to_accuracy(" << e2 << ") erroneously returned " << r2
+		     << " (instead of 0)" << endl;
+		result++;
+	}
+
+	// Accuracy next to 10^-max_digits still compares two values; 5/8 is
+	// exact in binary floating point, so they agree at any precision
+	const ex e3 = numeric(5, 8);
+	try {
+		const ex r3 = evalf_to_accuracy(e3, numeric(10).power(-59), error, 60);
+		if (!r3.is_equal(e3.evalf()) || !error.is_zero()) {
+			clog << "evalf_to_accuracy(" << e3 << ", 10^-59, 60) erroneously returned "
+			     << r3 << " with error " << error << endl;
+			result++;
+		}
+	} catch (std::exception &e) {
+		clog << "evalf_to_accuracy(" << e3 << ", 10^-59, 60) threw " << e.what() << endl;
+		result++;
+	}
+
+	// max_digits must leave room above Digits
+	bool thrown = false;
+	try {
+		evalf_to_accuracy(e3, accuracy, error, Digits);
+	} catch (std::invalid_argument &) {
+		thrown = true;
+	}
+	if (!thrown) {
+		clog << "evalf_to_accuracy() with max_digits == Digits did not throw" << endl;
+		result++;
+	}
+
+	return result;
+}
+
+
 unsigned exam_inifcns_nstdsums(void)
 {
 	unsigned result = 0;
@@ -377,6 +808,12 @@ unsigned exam_inifcns_nstdsums(void)
 	result += inifcns_test_HLi();
 	result += inifcns_test_LiG();
 	result += inifcns_test_legacy();
+	result += inifcns_test_tables();
+	result += inifcns_test_batch();
+	result += inifcns_test_binsplit();
+	result += inifcns_test_shared();
+	result += inifcns_test_zeta_relations();
+	result += inifcns_test_accuracy();
 	
 	return result;
 }
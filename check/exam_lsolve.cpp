@@ -187,6 +187,85 @@ static unsigned exam_lsolve3S()
 	return result;
 }
 
+static unsigned exam_lsolve_sparse()
+{
+	// A large bidiagonal system, which is eliminated sparsely...
+	unsigned result = 0;
+	const unsigned n = 20;
+	symbol a("a"), b("b");
+	lst eqns, vars;
+	for (unsigned i=0; i<n; ++i)
+		vars.append(symbol());
+	for (unsigned i=0; i+1<n; ++i)
+		eqns.append((a+i)*vars.op(i) - vars.op(i+1) == b);
+	eqns.append(vars.op(n-1) == 1);
+	ex sol = lsolve(eqns, vars);
+	if (sol.nops() != n) {
+		++result;
+		clog << "solution of the system " << eqns << " for " << vars
+		     << " erroneously returned " << sol << endl;
+	} else {
+		for (unsigned i=0; i<n; ++i) {
+			if (!normal(eqns.op(i).lhs().subs(sol) - eqns.op(i).rhs()).is_zero()) {
+				++result;
+				clog << "solution of the system " << eqns << " for " << vars
+				     << " erroneously returned " << sol << endl;
+				break;
+			}
+		}
+	}
+
+	// ...and the same with an underdetermined and an inconsistent one
+	symbol x("x"), y("y"), z("z");
+	lst eqns2(x+y==a, y/a+z==b), vars2(x, y, z);
+	sol = lsolve(eqns2, vars2, solve_algo::sparse);
+	if (sol.nops() != 3 ||
+	    !normal(eqns2.op(0).lhs().subs(sol) - a).is_zero() ||
+	    !normal(eqns2.op(1).lhs().subs(sol) - b).is_zero()) {
+		++result;
+		clog << "solution of the system " << eqns2 << " for " << vars2
+		     << " erroneously returned " << sol << endl;
+	}
+	lst eqns3(x+y==1, 2*x+2*y==a), vars3(x, y);
+	sol = lsolve(eqns3, vars3, solve_algo::sparse);
+	if (sol.nops() != 0) {
+		++result;
+		clog << "solution of the inconsistent system " << eqns3 << " for " << vars3
+		     << " erroneously returned " << sol << endl;
+	}
+
+	return result;
+}
+
+static unsigned exam_lsolve_blocks()
+{
+	// A system that decouples into two blocks and a single unknown
+	unsigned result = 0;
+	symbol a("a"), b("b"), x("x"), y("y"), z("z"), u("u"), v("v");
+	lst eqns(a*x+y==b, x-b*y==1, u+z==x, u-a*v==y, v==2), vars(u, x, y, v, z);
+	ex sol = lsolve(eqns, vars);
+	bool ok = sol.nops() == 5;
+	for (unsigned i=0; ok && i<eqns.nops(); ++i)
+		ok = normal(eqns.op(i).lhs().subs(sol) - eqns.op(i).rhs().subs(sol)).is_zero();
+	if (!ok) {
+		++result;
+		clog << "solution of the system " << eqns << " for " << vars
+		     << " erroneously returned " << sol << endl;
+	}
+
+	// x, y and v do not depend on each other and are solved in parallel
+	const ex psol = lsolve(eqns, vars, solve_algo::parallel);
+	ok = psol.nops() == 5;
+	for (unsigned i=0; ok && i<psol.nops(); ++i)
+		ok = normal(psol.op(i).rhs() - psol.op(i).lhs().subs(sol)).is_zero();
+	if (!ok) {
+		++result;
+		clog << "parallel solution of the system " << eqns << " for " << vars
+		     << " erroneously returned " << psol << endl;
+	}
+	return result;
+}
+
 unsigned exam_lsolve()
 {
 	unsigned result = 0;
@@ -199,6 +278,8 @@ unsigned exam_lsolve()
 	result += exam_lsolve2c();  cout << '.' << flush;
 	result += exam_lsolve2S();  cout << '.' << flush;
 	result += exam_lsolve3S();  cout << '.' << flush;
+	result += exam_lsolve_sparse();  cout << '.' << flush;
+	result += exam_lsolve_blocks();  cout << '.' << flush;
 	
 	return result;
 }
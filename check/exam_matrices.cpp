@@ -285,6 +285,389 @@ static unsigned matrix_rank()
 	return result;	
 }
 
+static unsigned matrix_numeric()
+{
+	unsigned result = 0;
+
+	// the Hilbert matrix and its exact determinant and inverse
+	matrix H(4,4);
+	for (unsigned r=0; r<4; ++r)
+		for (unsigned c=0; c<4; ++c)
+			H(r,c) = numeric(1,r+c+1);
+	if (H.determinant() != numeric(1,6048000)) {
+		clog << "The determinant of " << H << " erroneously returned "
+		     << H.determinant() << endl;
+		++result;
+	}
+	if (!H.mul(H.inverse()).is_equal(ex_to<matrix>(unit_matrix(4)))) {
+		clog << "The inverse of " << H << " erroneously returned "
+		     << H.inverse() << endl;
+		++result;
+	}
+
+	// a complex rational determinant
+	matrix C(2, 2, lst(I, numeric(1,2), 2, 1-I));
+	if (C.determinant() != I) {
+		clog << "The determinant of " << C << " erroneously returned "
+		     << C.determinant() << endl;
+		++result;
+	}
+
+	// singular rational matrices
+	matrix S(3, 3, lst(1, 2, 3, numeric(1,2), 1, numeric(3,2), 0, 1, 1));
+	if (S.rank() != 2 || S.determinant() != 0) {
+		clog << "The rank of " << S << " was not computed correctly." << endl;
+		++result;
+	}
+	try {
+		S.inverse();
+		clog << "Inverting " << S << " did not fail." << endl;
+		++result;
+	} catch (const std::runtime_error & e) {
+	}
+
+	// a floating point system, which needs pivoting
+	symbol x0("x0"), x1("x1");
+	matrix A(2, 2, lst(numeric("1e-40"), 1, 1, 1));
+	matrix B(2, 1, lst(1, 2));
+	matrix X(2, 1, lst(x0, x1));
+	matrix sol = A.solve(X, B);
+	if (abs(ex_to<numeric>(sol(0,0)) - 1) > numeric("1e-10") ||
+	    abs(ex_to<numeric>(sol(1,0)) - 1) > numeric("1e-10")) {
+		clog << "Solving " << A << " * " << X << " == " << B << endl
+		     << "erroneously returned " << sol << endl;
+		++result;
+	}
+
+	return result;
+}
+
+static unsigned matrix_modular()
+{
+	unsigned result = 0;
+	symbol x("x");
+
+	// an integer matrix with large entries, and a regular rational system
+	matrix A(8,8), B(8,1), X(8,1);
+	for (unsigned r=0; r<8; ++r) {
+		for (unsigned c=0; c<8; ++c)
+			A(r,c) = numeric(((r+1)*(c+3)*(r+c+5)) % 23 - 11) * numeric("1000000000007");
+		A(r,r) += numeric(r+1,3);
+		B(r,0) = numeric(r*r+1,r+2);
+		X(r,0) = symbol();
+	}
+	ex det = A.determinant();
+	if (det != A.determinant(determinant_algo::bareiss)) {
+		clog << "The determinant of " << A << " erroneously returned " << det << endl;
+		++result;
+	}
+	matrix sol = A.solve(X, B);
+	if (!A.mul(sol).is_equal(B)) {
+		clog << "Solving " << A << " * " << X << " == " << B << endl
+		     << "erroneously returned " << sol << endl;
+		++result;
+	}
+
+	// univariate polynomial matrices
+	matrix P(5,5), Q(5,2), Y(5,2);
+	for (unsigned r=0; r<5; ++r) {
+		for (unsigned c=0; c<5; ++c)
+			P(r,c) = pow(x, (r*c)%3) - numeric((r+2*c)%5, 2) * x + numeric(r*c+1);
+		Q(r,0) = x - r;
+		Q(r,1) = pow(x,2) + r;
+		Y(r,0) = symbol();
+		Y(r,1) = symbol();
+	}
+	det = P.determinant();
+	if (det != P.determinant(determinant_algo::laplace)) {
+		clog << "The determinant of " << P << " erroneously returned " << det << endl;
+		++result;
+	}
+	sol = P.solve(Y, Q);
+	matrix res = P.mul(sol).sub(Q);
+	for (unsigned i=0; i<res.nops(); ++i) {
+		if (!normal(res.op(i)).is_zero()) {
+			clog << "Solving " << P << " * " << Y << " == " << Q << endl
+			     << "erroneously returned " << sol << endl;
+			++result;
+			break;
+		}
+	}
+
+	return result;
+}
+
+static unsigned matrix_mul_pow()
+{
+	unsigned result = 0;
+
+	// integer matrices large enough for Strassen's scheme, of odd size
+	const unsigned n = 67;
+	matrix A(n,n), B(n,n);
+	for (unsigned r=0; r<n; ++r) {
+		for (unsigned c=0; c<n; ++c) {
+			A(r,c) = numeric((r*r+3*c) % 19) - 9;
+			B(r,c) = numeric((5*r+c*c) % 23) - 11;
+		}
+	}
+	const matrix C = A.mul(B);
+	for (unsigned r=0; r<n; r+=11) {
+		for (unsigned c=0; c<n; c+=13) {
+			numeric e = 0;
+			for (unsigned k=0; k<n; ++k)
+				e += ex_to<numeric>(A(r,k)) * ex_to<numeric>(B(k,c));
+			if (C(r,c) != e) {
+				clog << "matrix product erroneously returned " << C(r,c)
+				     << " instead of " << e << " at (" << r << "," << c << ")" << endl;
+				++result;
+			}
+		}
+	}
+
+	// Fibonacci numbers from powers of a numeric matrix
+	matrix F(2, 2, lst(1, 1, 1, 0));
+	matrix F50 = F.pow(50);
+	if (F50(0,0) != numeric("20365011074") || F50(0,1) != numeric("12586269025") ||
+	    F50(1,1) != numeric("7778742049")) {
+		clog << F << "^50 erroneously returned " << F50 << endl;
+		++result;
+	}
+
+	// a symbolic product, whose entries are sums of all their terms
+	symbol a("a"), b("b");
+	matrix S(2, 2, lst(a, 1, 0, b));
+	matrix S3 = S.pow(3);
+	if (S3(0,1).expand() != pow(a,2)+a*b+pow(b,2) || S3(1,0) != 0) {
+		clog << S << "^3 erroneously returned " << S3 << endl;
+		++result;
+	}
+
+	return result;
+}
+
+static unsigned matrix_charpoly()
+{
+	unsigned result = 0;
+	symbol lambda("lambda");
+
+	// a dense symbolic matrix, handled by Berkowitz' algorithm
+	symbol a("a"), b("b"), c("c");
+	matrix S = ex_to<matrix>(lst_to_matrix(lst(lst(a, 1, b, 0, 2),
+	                                           lst(c, a, 0, 1, b),
+	                                           lst(1, b, c, a, 0),
+	                                           lst(0, 3, a, b, c),
+	                                           lst(b, 0, 1, c, a))));
+	matrix SL(S);
+	for (unsigned r=0; r<5; ++r)
+		SL(r,r) -= lambda;
+	ex cp = S.charpoly(lambda);
+	ex det = SL.determinant(determinant_algo::laplace);
+	if (!(cp - det).expand().is_zero()) {
+		clog << "charpoly of " << S << " erroneously returned " << cp << endl;
+		++result;
+	}
+
+	// a numeric matrix, handled by Hessenberg reduction, which has to
+	// pivot in its first column
+	matrix N = ex_to<matrix>(lst_to_matrix(lst(lst(2, 1, -1, 0, 3),
+	                                           lst(0, 4, 1, 2, -2),
+	                                           lst(1, 0, 0, 5, 1),
+	                                           lst(-3, 2, 1, 1, 0),
+	                                           lst(1, 1, 2, 0, -1))));
+	matrix NL(N);
+	for (unsigned r=0; r<5; ++r)
+		NL(r,r) -= lambda;
+	cp = N.charpoly(lambda);
+	det = NL.determinant(determinant_algo::laplace);
+	if (!(cp - det).expand().is_zero()) {
+		clog << "charpoly of " << N << " erroneously returned " << cp << endl;
+		++result;
+	}
+
+	return result;
+}
+
+static unsigned matrix_block_triangular()
+{
+	unsigned result = 0;
+	symbol a("a"), b("b"), c("c");
+
+	// two 3x3 blocks and a coupling entry, with permuted rows and columns
+	const unsigned perm_r[6] = { 4, 0, 5, 2, 1, 3 };
+	const unsigned perm_c[6] = { 1, 3, 5, 0, 2, 4 };
+	matrix B = ex_to<matrix>(lst_to_matrix(lst(lst(a, 1, b, 0, 0, 0),
+	                                           lst(c, a, 2, 0, 0, 0),
+	                                           lst(1, b, c, 0, 0, 0),
+	                                           lst(0, a, 0, b, 1, 0),
+	                                           lst(0, 0, 0, 3, a, c),
+	                                           lst(0, 0, 0, a, 0, b))));
+	matrix P(6, 6);
+	for (unsigned r=0; r<6; ++r)
+		for (unsigned co=0; co<6; ++co)
+			P(perm_r[r],perm_c[co]) = B(r,co);
+	ex det = P.determinant();
+	ex det_laplace = P.determinant(determinant_algo::laplace);
+	if (!(det - det_laplace).expand().is_zero()) {
+		clog << "determinant of " << P << " erroneously returned " << det
+		     << " instead of " << det_laplace << endl;
+		++result;
+	}
+	det = P.determinant(determinant_algo::parallel);
+	if (!(det - det_laplace).expand().is_zero()) {
+		clog << "parallel determinant of " << P << " erroneously returned " << det
+		     << " instead of " << det_laplace << endl;
+		++result;
+	}
+
+	// without a zero free diagonal the determinant vanishes
+	P(perm_r[3],perm_c[1]) = 0;
+	P(perm_r[3],perm_c[4]) = 0;
+	P(perm_r[5],perm_c[5]) = 0;
+	det = P.determinant();
+	if (!det.is_zero()) {
+		clog << "determinant of the structurally singular " << P
+		     << " erroneously returned " << det << endl;
+		++result;
+	}
+
+	return result;
+}
+
+static unsigned matrix_updates()
+{
+	unsigned result = 0;
+	symbol a("a"), b("b"), c("c");
+
+	matrix A = ex_to<matrix>(lst_to_matrix(lst(lst(a, 1, 0, b),
+	                                           lst(2, b, c, 0),
+	                                           lst(0, 1, a, 1),
+	                                           lst(c, 0, 3, a))));
+	updatable_matrix U(A);
+	U.set_row(1, matrix(1, 4, lst(1, a, 0, c)));
+	U.set_col(3, matrix(4, 1, lst(b, 0, 1, c)));
+	U.set(0, 2, a*b);
+	const matrix & M = U.get_matrix();
+	ex det = M.determinant();
+	if (!(U.determinant() - det).expand().is_zero()) {
+		clog << "updated determinant of " << M << " erroneously returned "
+		     << U.determinant() << " instead of " << det << endl;
+		++result;
+	}
+	matrix one = M.mul(U.inverse());
+	for (unsigned r=0; r<4; ++r) {
+		for (unsigned co=0; co<4; ++co) {
+			if (!(one(r,co).normal() - (r==co ? 1 : 0)).is_zero()) {
+				clog << "updated inverse of " << M << " erroneously returned "
+				     << U.inverse() << endl;
+				++result;
+				return result;
+			}
+		}
+	}
+
+	// a singular matrix has no inverse until it is regular again
+	U.set_row(3, matrix(1, 4, lst(M(0,0), M(0,1), M(0,2), M(0,3))));
+	if (!U.determinant().is_zero()) {
+		clog << "updated determinant of the singular matrix " << U.get_matrix()
+		     << " erroneously returned " << U.determinant() << endl;
+		++result;
+	}
+	U.set(3, 3, M(0,3) + 1);
+	det = U.get_matrix().determinant();
+	matrix diff = U.inverse().sub(U.get_matrix().inverse());
+	bool ok = (U.determinant() - det).expand().is_zero();
+	for (unsigned r=0; r<4; ++r)
+		for (unsigned co=0; co<4; ++co)
+			ok = ok && diff(r,co).normal().is_zero();
+	if (!ok) {
+		clog << "updated determinant or inverse of " << U.get_matrix()
+		     << " erroneously returned " << U.determinant() << ", "
+		     << U.inverse() << endl;
+		++result;
+	}
+
+	return result;
+}
+
+static unsigned matrix_parallel()
+{
+	unsigned result = 0;
+	symbol a("a"), b("b"), c("c");
+	// a second symbol named a, which worker processes cannot tell apart
+	symbol a2("a");
+
+	matrix M(6,6), X(6,1), B(6,1), N(3,3);
+	for (unsigned r=0; r<6; ++r) {
+		for (unsigned co=0; co<6; ++co)
+			M(r,co) = pow(a, (r+co)%3) - int(r*co)*b + (r==co ? ex(c) : ex(0)) + int((r+2*co)%5);
+		X(r,0) = symbol();
+		B(r,0) = pow(b, r) + 1;
+	}
+	ex det = M.determinant(determinant_algo::parallel);
+	if (!det.is_equal(M.determinant(determinant_algo::bareiss))) {
+		clog << "The parallel determinant of " << M << " erroneously returned " << det << endl;
+		++result;
+	}
+	matrix sol = M.solve(X, B, solve_algo::parallel);
+	matrix ref = M.solve(X, B, solve_algo::bareiss);
+	for (unsigned r=0; r<6; ++r) {
+		if (!(sol(r,0) - ref(r,0)).normal().is_zero()) {
+			clog << "Solving " << M << " * " << X << " == " << B << " in parallel" << endl
+			     << "erroneously returned " << sol << endl;
+			++result;
+			break;
+		}
+	}
+
+	N = matrix(3, 3, lst(a, a2, 1, b, a2, a, 1, a, c));
+	det = N.determinant(determinant_algo::parallel);
+	if (!(det - N.determinant(determinant_algo::laplace)).expand().is_zero()) {
+		clog << "The parallel determinant of " << N << " erroneously returned " << det << endl;
+		++result;
+	}
+
+	// blocks of rows of a product, including those of a symbol shared
+	// by name, which are computed here
+	const matrix P = M.mul(M.transpose(), 3);
+	const matrix Q = M.mul(M.transpose());
+	if (!ex_to<matrix>(P.sub(Q).expand()).is_zero_matrix()) {
+		clog << "The parallel product of " << M << " and its transpose erroneously returned " << P << endl;
+		++result;
+	}
+	const matrix NP = N.mul(N, 2);
+	if (!ex_to<matrix>(NP.sub(N.mul(N)).expand()).is_zero_matrix()) {
+		clog << "The parallel square of " << N << " erroneously returned " << NP << endl;
+		++result;
+	}
+
+	// rational matrices go to the modular method, with the images modulo
+	// the primes computed by the workers
+	matrix R(8,8), Y(8,1), C(8,1);
+	for (unsigned r=0; r<8; ++r) {
+		for (unsigned co=0; co<8; ++co)
+			R(r,co) = numeric(int((3*r+5*co*co)%11) - 4, r+co+1);
+		Y(r,0) = symbol();
+		C(r,0) = numeric(int(r*r) - 7, 3);
+	}
+	det = R.determinant(determinant_algo::parallel);
+	if (!det.is_equal(R.determinant(determinant_algo::bareiss))) {
+		clog << "The parallel determinant of " << R << " erroneously returned " << det << endl;
+		++result;
+	}
+	sol = R.solve(Y, C, solve_algo::parallel);
+	ref = R.solve(Y, C, solve_algo::bareiss);
+	for (unsigned r=0; r<8; ++r) {
+		if (!(sol(r,0) - ref(r,0)).is_zero()) {
+			clog << "Solving " << R << " * " << Y << " == " << C << " in parallel" << endl
+			     << "erroneously returned " << sol << endl;
+			++result;
+			break;
+		}
+	}
+
+	return result;
+}
+
 static unsigned matrix_misc()
 {
 	unsigned result = 0;
@@ -349,6 +732,13 @@ unsigned exam_matrices()
 	result += matrix_solve2();  cout << '.' << flush;
 	result += matrix_evalm();  cout << "." << flush;
 	result += matrix_rank();  cout << "." << flush;
+	result += matrix_numeric();  cout << "." << flush;
+	result += matrix_modular();  cout << "." << flush;
+	result += matrix_mul_pow();  cout << "." << flush;
+	result += matrix_charpoly();  cout << "." << flush;
+	result += matrix_block_triangular();  cout << "." << flush;
+	result += matrix_updates();  cout << "." << flush;
+	result += matrix_parallel();  cout << "." << flush;
 	result += matrix_misc();  cout << '.' << flush;
 	
 	return result;
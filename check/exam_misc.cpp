@@ -298,6 +298,38 @@ static unsigned exam_subs_algebraic()
 	return result;
 }
 
+/* Test numerical integration, at the default and at a higher precision. */
+static unsigned exam_integral_evalf()
+{
+	unsigned result = 0;
+	symbol x("x");
+
+	const ex e[] = { integral(x, 0, 1, exp(x)),
+	                 integral(x, 0, 10, 1/(1 + pow(x, 2))),
+	                 integral(x, 0, 1, sqrt(x)) };
+	const ex v[] = { exp(ex(1)) - 1, atan(ex(10)), numeric(2, 3) };
+
+	for (size_t i=0; i<sizeof(e)/sizeof(e[0]); ++i) {
+		const ex r = e[i].evalf();
+		const ex d = abs(r - v[i].evalf());
+		if (!is_a<numeric>(r) || d > 1e-7*abs(v[i].evalf())) {
+			clog << e[i] << ".evalf() erroneously returned " << r << endl;
+			++result;
+		}
+	}
+
+	const long digits = Digits;
+	Digits = 50;
+	const ex r = adaptivegauss(x, 0, 1, exp(x), pow(ex(10), -40));
+	if (abs(ex_to<numeric>(r) - ex_to<numeric>(exp(ex(1)).evalf()) + 1) > pow(ex(10), -38)) {
+		clog << "adaptivegauss() of exp(x) over [0, 1] erroneously returned " << r << " at Digits=50" << endl;
+		++result;
+	}
+	Digits = digits;
+
+	return result;
+}
+
 unsigned exam_misc()
 {
 	unsigned result = 0;
@@ -312,6 +344,7 @@ unsigned exam_misc()
 	result += exam_subs(); cout << '.' << flush;
 	result += exam_joris(); cout << '.' << flush;
 	result += exam_subs_algebraic(); cout << '.' << flush;
+	result += exam_integral_evalf(); cout << '.' << flush;
 	
 	return result;
 }
@@ -167,6 +167,36 @@ static unsigned exam_normal4()
 	return result;
 }
 
+static unsigned exam_normal5()
+{
+	unsigned result = 0;
+	
+	// Many fractions, pairs of which have equal denominators: the sum is
+	// (y+z)*S/P with P = prod (x+i) and S = sum_j prod_{i!=j} (x+i)
+	const int n = 16;
+	ex e = 0, P = 1, S = 0;
+	for (int i=0; i<n; ++i) {
+		e += y/(x+i) + z/(x+i);
+		S = S*(x+i) + P;
+		P *= x+i;
+	}
+	ex en = e.normal();
+	if (!(en.numer()*P - (y+z)*S*en.denom()).expand().is_zero() ||
+	    en.denom().expand().degree(x) != n) {
+		clog << "normal form of " << e << " erroneously returned " << en << endl;
+		++result;
+	}
+	
+	// The same sum, with blocks of the fractions added in worker processes
+	ex ep = e.normal(0, 3);
+	if (!(ep.numer()*en.denom() - en.numer()*ep.denom()).expand().is_zero()) {
+		clog << "normal form of " << e << " in 3 processes erroneously returned " << ep << endl;
+		++result;
+	}
+	
+	return result;
+}
+
 /* Test content(), integer_content(), primpart(). */
 static unsigned check_content(const ex & e, const ex & x, const ex & ic, const ex & c, const ex & pp)
 {
@@ -228,6 +258,7 @@ unsigned exam_normalization()
 	result += exam_normal2(); cout << '.' << flush;
 	result += exam_normal3(); cout << '.' << flush;
 	result += exam_normal4(); cout << '.' << flush;
+	result += exam_normal5(); cout << '.' << flush;
 	result += exam_content(); cout << '.' << flush;
 	
 	return result;
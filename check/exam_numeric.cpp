@@ -24,6 +24,7 @@
 #include "ginac.h"
 using namespace GiNaC;
 
+#include <cmath>
 #include <iostream>
 #include <sstream>
 using namespace std;
@@ -381,6 +382,147 @@ static unsigned exam_numeric6()
 	return result;
 }
 
+/* Test the double precision evaluation against evalf(). */
+static unsigned exam_numeric7()
+{
+	unsigned result = 0;
+	symbol x("x"), y("y");
+	exmap m;
+	m[x] = numeric(3, 7);
+	m[y] = numeric(-5, 4);
+
+	lst test_exprs;
+	test_exprs.append(x*x*y + 3*y - numeric(1, 3));
+	test_exprs.append(pow(x, numeric(1, 2)) + pow(y, -3));
+	test_exprs.append(sin(x)*exp(y) - atan2(y, x)*Pi);
+	test_exprs.append(log(x + 1)/cosh(y) + asinh(y) + abs(y));
+	test_exprs.append(tgamma(x + 2) + zeta(3)*y);  // no double implementation
+
+	for (lst::const_iterator i = test_exprs.begin(); i != test_exprs.end(); ++i) {
+		const double fast = evalf_double(*i, m);
+		const double slow = ex_to<numeric>(i->subs(m).evalf()).to_double();
+		if (std::fabs(fast - slow) > 1e-12*(1 + std::fabs(slow))) {
+			clog << "evalf_double(" << *i << ") erroneously returned "
+			     << fast << " instead of " << slow << endl;
+			++result;
+		}
+	}
+
+	// Large arguments where x*x overflows
+	exmap big;
+	big[x] = pow(numeric(10), 200);
+	lst big_exprs(acosh(x), asinh(x), asinh(-x));
+	for (lst::const_iterator i = big_exprs.begin(); i != big_exprs.end(); ++i) {
+		const double fast = evalf_double(*i, big);
+		const double slow = ex_to<numeric>(i->subs(big).evalf()).to_double();
+		if (!(std::fabs(fast - slow) <= 1e-12*std::fabs(slow))) {
+			clog << "evalf_double(" << *i << ") erroneously returned "
+			     << fast << " instead of " << slow << " at x=10^200" << endl;
+			++result;
+		}
+	}
+
+	// Non-real results yield NaN
+	const double nan = evalf_double(pow(y, numeric(1, 3)), m);
+	if (nan == nan) {
+		clog << "evalf_double(" << pow(y, numeric(1, 3)) << ") erroneously returned "
+		     << nan << " instead of NaN" << endl;
+		++result;
+	}
+
+	return result;
+}
+
+/* Test evaluation plans against subs() and evalf(). */
+static unsigned exam_numeric8()
+{
+	unsigned result = 0;
+	symbol x("x"), y("y");
+	const ex e = pow(sin(x) + y, 2) + sqrt(sin(x) + y)*exp(-x*y) - Pi*x/3
+	             + tgamma(y + 1);  // tgamma() has no double implementation
+	evalplan plan(e, lst(x, y));
+
+	for (int i=1; i<=5; ++i) {
+		const numeric xv(i, 7), yv(2*i + 1, 3);
+		std::vector<numeric> nv;
+		nv.push_back(xv);
+		nv.push_back(yv);
+		const numeric slow = ex_to<numeric>(e.subs(lst(x == xv, y == yv)).evalf());
+		const numeric fast = plan.evalf(nv);
+		if (abs(fast - slow) > numeric(1, 1000000000)) {
+			clog << "evalplan::evalf() of " << e << " at x=" << xv << ", y=" << yv
+			     << " erroneously returned " << fast << " instead of " << slow << endl;
+			++result;
+		}
+		std::vector<double> dv;
+		dv.push_back(xv.to_double());
+		dv.push_back(yv.to_double());
+		const double dfast = plan.evalf_double(dv);
+		if (std::fabs(dfast - slow.to_double()) > 1e-12*(1 + std::fabs(slow.to_double()))) {
+			clog << "evalplan::evalf_double() of " << e << " at x=" << xv << ", y=" << yv
+			     << " erroneously returned " << dfast << " instead of " << slow << endl;
+			++result;
+		}
+	}
+
+	// x, sin(x), 2, sin(x)^2 and the sum; sin(x) must be compiled only once
+	const ex e2 = pow(sin(x), 2) + sin(x);
+	if (evalplan(e2, lst(x)).size() != 5) {
+		clog << "evalplan of " << e2 << " has " << evalplan(e2, lst(x)).size()
+		     << " instructions instead of 5" << endl;
+		++result;
+	}
+
+	return result;
+}
+
+/* Test enclosures computed by interval arithmetic. */
+static unsigned exam_numeric9()
+{
+	unsigned result = 0;
+	symbol x("x");
+	const ex e[] = { sin(x)*cos(x) + exp(-pow(x, 2))/(1 + pow(x, 2)),
+	                 atan(x) - sqrt(x + 2) + 3*cosh(x)/Pi,
+	                 pow(x, 3) - x*log(abs(x) + 1) };
+
+	for (size_t i=0; i<sizeof(e)/sizeof(e[0]); ++i) {
+		evalplan plan(e[i], lst(x));
+		for (int k=-2; k<=2; ++k) {
+			const interval X(numeric(k, 2), numeric(k + 3, 2));
+			const interval F = plan.evalf_interval(std::vector<interval>(1, X));
+			for (int j=0; j<=10; ++j) {
+				const numeric xv = X.lower() + j*X.width()/10;
+				const numeric fv = ex_to<numeric>(e[i].subs(x == xv).evalf());
+				if (!F.contains(fv)) {
+					clog << "enclosure " << F << " of " << e[i] << " over " << X
+					     << " does not contain its value " << fv << " at x=" << xv << endl;
+					++result;
+				}
+			}
+		}
+	}
+
+	// Exact bounds where no rounding is involved
+	const interval sq = interval(numeric(-1), numeric(2)).power(numeric(2));
+	if (!sq.is_bounded() || sq.lower() != 0 || sq.upper() != 4) {
+		clog << "[-1, 2]^2 erroneously returned " << sq << " instead of [0, 4]" << endl;
+		++result;
+	}
+	// The maximum of sin(x) on [0, 4] is taken inside the interval
+	const interval s = sin(interval(numeric(0), numeric(4)));
+	if (!s.is_bounded() || s.upper() != 1) {
+		clog << "sin([0, 4]) erroneously returned " << s << endl;
+		++result;
+	}
+	// Division by an interval containing zero is unbounded
+	if (interval(numeric(1)).div(interval(numeric(-1), numeric(1))).is_bounded()) {
+		clog << "1/[-1, 1] erroneously returned a bounded interval" << endl;
+		++result;
+	}
+
+	return result;
+}
+
 unsigned exam_numeric()
 {
 	unsigned result = 0;
@@ -393,6 +535,9 @@ unsigned exam_numeric()
 	result += exam_numeric4();  cout << '.' << flush;
 	result += exam_numeric5();  cout << '.' << flush;
 	result += exam_numeric6();  cout << '.' << flush;
+	result += exam_numeric7();  cout << '.' << flush;
+	result += exam_numeric8();  cout << '.' << flush;
+	result += exam_numeric9();  cout << '.' << flush;
 	
 	return result;
 }
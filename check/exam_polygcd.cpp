@@ -22,6 +22,7 @@
  */
 
 #include "ginac.h"
+#include "polynomial/sparse_gcd.h"
 using namespace GiNaC;
 
 #include <iostream>
@@ -230,6 +231,46 @@ static unsigned poly_gcd7()
 	return 0;
 }
 
+// Sparse polynomials in many variables, for the sparse modular algorithm
+static unsigned poly_gcd8()
+{
+	symbol a("a"), b("b"), c("c"), u("u"), v("v"), w("w"), s("s"), t("t");
+	ex d = pow(a, 3)*b*w - 2*c*pow(u, 2)*t + 5*s*pow(v, 2) + 7;
+	ex f = (d * (pow(a, 2)*pow(s, 3) + b*c*u*v*w - 3*pow(t, 4) + a)).expand();
+	ex g = (d * (pow(b, 3)*pow(w, 2) - a*pow(u, 2)*s*t + 2*pow(c, 2) - v)).expand();
+
+	ex r = gcd(f, g);
+	if (!(r - d).expand().is_zero() && !(r + d).expand().is_zero()) {
+		clog << "case 8, gcd(" << f << "," << g << ") = " << r << " (should be " << d << ")" << endl;
+		return 1;
+	}
+
+	// make sure the answer above did not come from another algorithm
+	exvector vars;
+	vars.push_back(b); vars.push_back(c); vars.push_back(u); vars.push_back(v);
+	vars.push_back(w); vars.push_back(s); vars.push_back(t); vars.push_back(a);
+	if (!sparse_gcd(r, f, g, vars) ||
+	    (!(r - d).expand().is_zero() && !(r + d).expand().is_zero())) {
+		clog << "case 8, sparse_gcd(" << f << "," << g << ") failed or returned " << r
+		     << " (should be " << d << ")" << endl;
+		return 1;
+	}
+
+	// the same algorithm on request, with cofactors and contents
+	ex e = (x - y[0]*z + 3) * (pow(z, 2) + 1);
+	f = (e * (pow(x, 2) + y[0]) * y[1]).expand();
+	g = (e * (x*z - 5) * (y[1] + 1)).expand();
+	ex cf, cg;
+	r = gcd(f, g, &cf, &cg, true, gcd_options::use_sparse_gcd);
+	if ((!(r - e).expand().is_zero() && !(r + e).expand().is_zero()) ||
+	    !(r*cf - f).expand().is_zero() || !(r*cg - g).expand().is_zero()) {
+		clog << "case 8, gcd(" << f << "," << g << ") = " << r << " (should be " << e
+		     << ") with cofactors " << cf << ", " << cg << endl;
+		return 1;
+	}
+	return 0;
+}
+
 unsigned exam_polygcd()
 {
 	unsigned result = 0;
@@ -245,6 +286,7 @@ unsigned exam_polygcd()
 	result += poly_gcd5p();  cout << '.' << flush;
 	result += poly_gcd6();  cout << '.' << flush;
 	result += poly_gcd7();  cout << '.' << flush;
+	result += poly_gcd8();  cout << '.' << flush;
 	
 	return result;
 }
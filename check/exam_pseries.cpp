@@ -386,6 +386,125 @@ static unsigned exam_series14()
 	return result;
 }
 
+// Test series arithmetic at high order.
+static unsigned exam_series15()
+{
+	unsigned result = 0;
+	ex e, d;
+
+	// 1/(1-x)^2 needs power_const() and mul_series()
+	e = pow(1-x, -2)*(1+x);
+	d = Order(pow(x, 60));
+	for (int i=0; i<60; ++i)
+		d += (2*i+1)*pow(x, i);
+	result += check_series(e, 0, d, 60);
+
+	// Product of series that cancel up to the order
+	e = exp(x)*exp(-x) + pow(x, -3)*sin(x);
+	d = 1 + Order(pow(x, 60));
+	for (int i=0; 2*i-2<60; ++i)
+		d += pow(-1, i)*pow(x, 2*i-2)/factorial(2*i+1);
+	result += check_series(e, 0, d, 60);
+
+	return result;
+}
+
+// Test lazy series against ordinary series expansion, at increasing order.
+static unsigned exam_series16()
+{
+	unsigned result = 0;
+	symbol a("a");
+	const ex e[] = { exp(sin(x)),
+	                 1/cos(x) + log(1+x)*pow(x, -2),
+	                 pow(1+a*x, numeric(1, 3))*exp(x),
+	                 pow(sin(x), -2) + tan(x),
+	                 pow(x + pow(x, 2), 3)*cos(a + x) };
+	const ex p[] = { 0, 0, 0, 0, 1 };
+
+	for (size_t i=0; i<sizeof(e)/sizeof(e[0]); ++i) {
+		lazy_series ls(e[i], x==p[i]);
+		for (int order=2; order<=12; order+=5) {
+			const ex lazy = series_to_poly(ls.series(order));
+			const ex full = series_to_poly(e[i].series(x==p[i], order));
+			if (!(lazy - full).expand().normal().is_zero()) {
+				clog << "lazy series expansion of " << e[i] << " at " << p[i]
+				     << " to order " << order << " erroneously returned "
+				     << lazy << " (instead of " << full << ")" << endl;
+				++result;
+			}
+		}
+	}
+
+	return result;
+}
+
+// Series of functions of series, computed by Newton iteration and
+// composition.
+static unsigned exam_series17()
+{
+	unsigned result = 0;
+	symbol a("a");
+	ex e, d;
+
+	e = exp(x + pow(x, 2));
+	d = 1 + x + numeric(3,2)*pow(x,2) + numeric(7,6)*pow(x,3)
+	  + numeric(25,24)*pow(x,4) + numeric(27,40)*pow(x,5)
+	  + numeric(331,720)*pow(x,6) + numeric(1303,5040)*pow(x,7)
+	  + numeric(1979,13440)*pow(x,8) + Order(pow(x,9));
+	result += check_series(e, 0, d, 9);
+
+	e = exp(a*x);
+	d = Order(pow(x, 6));
+	for (int i=0; i<6; ++i)
+		d += pow(a*x, i)/factorial(i);
+	result += check_series(e, 0, d, 6);
+
+	// log(1+x+x^2) = log(1-x^3) - log(1-x)
+	e = log(1 + x + pow(x, 2));
+	d = Order(pow(x, 12));
+	for (int i=1; i<12; ++i)
+		d += (i%3 ? 1 : -2)*pow(x, i)/i;
+	result += check_series(e, 0, d, 12);
+
+	e = sin(2*x);
+	d = Order(pow(x, 10));
+	for (int i=0; 2*i+1<10; ++i)
+		d += pow(-1, i)*pow(2*x, 2*i+1)/factorial(2*i+1);
+	result += check_series(e, 0, d, 10);
+
+	// The inverse function of log(1+x) is exp(x)-1
+	const pseries logser = ex_to<pseries>(log(1+x).series(x==0, 10));
+	e = logser.revert_series(10);
+	d = Order(pow(x, 10));
+	for (int i=1; i<10; ++i)
+		d += pow(x, i)/factorial(i);
+	if (!(ex_to<pseries>(e).convert_to_poly() - d).expand().is_zero()) {
+		clog << "reversion of " << logser << " erroneously returned "
+		     << e << " (instead of " << d << ")" << endl;
+		++result;
+	}
+
+	// Newton iteration against the recurrence of power_const()
+	const pseries sinser = ex_to<pseries>(sin(x).series(x==0, 12));
+	e = series_to_poly(sinser.inverse_series(10));
+	d = series_to_poly(pow(sin(x), -1).series(x==0, 10));
+	if (!(e - d).expand().is_zero()) {
+		clog << "reciprocal of " << sinser << " erroneously returned "
+		     << e << " (instead of " << d << ")" << endl;
+		++result;
+	}
+	const pseries cosser = ex_to<pseries>(cos(x).series(x==0, 12));
+	e = series_to_poly(cosser.sqrt_series(12));
+	d = series_to_poly(pow(cos(x), numeric(1,2)).series(x==0, 12));
+	if (!(e - d).expand().is_zero()) {
+		clog << "square root of " << cosser << " erroneously returned "
+		     << e << " (instead of " << d << ")" << endl;
+		++result;
+	}
+
+	return result;
+}
+
 unsigned exam_pseries()
 {
 	unsigned result = 0;
@@ -406,6 +525,9 @@ unsigned exam_pseries()
 	result += exam_series12();  cout << '.' << flush;
 	result += exam_series13();  cout << '.' << flush;
 	result += exam_series14();  cout << '.' << flush;
+	result += exam_series15();  cout << '.' << flush;
+	result += exam_series16();  cout << '.' << flush;
+	result += exam_series17();  cout << '.' << flush;
 	
 	return result;
 }
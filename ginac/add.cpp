@@ -404,6 +404,20 @@ ex add::eval(int level) const
 	return this->hold();
 }
 
+double add::evalf_double(const exmap & m) const
+{
+	double sum = overall_coeff.evalf_double(m);
+	epvector::const_iterator i = seq.begin(), end = seq.end();
+	while (i != end) {
+		if (i->coeff.is_equal(_ex1))
+			sum += i->rest.evalf_double(m);
+		else
+			sum += i->coeff.evalf_double(m) * i->rest.evalf_double(m);
+		++i;
+	}
+	return sum;
+}
+
 ex add::evalm() const
 {
 	// Evaluate children first and add up all matrices. Stop if there's one
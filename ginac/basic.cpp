@@ -441,6 +441,22 @@ ex basic::evalf(int level) const
 	}
 }
 
+/** Evaluate object numerically in double precision, after substituting
+ *  the values given in m for its symbols.  This default implementation
+ *  goes through subs() and evalf() at the current precision and converts
+ *  the result.  Classes override it with a native floating point version.
+ *
+ *  @param m map from symbols to their numerical values
+ *  @return real value of the expression, or NaN if it is not real
+ *  @exception runtime_error (expression does not evaluate to a number) */
+double basic::evalf_double(const exmap & m) const
+{
+	const ex num = subs(m).evalf();
+	if (!is_exactly_a<numeric>(num))
+		throw(std::runtime_error("evalf_double(): expression does not evaluate to a number"));
+	return ex_to<numeric>(num).evalf_double(m);
+}
+
 /** Function object to be applied by basic::evalm(). */
 struct evalm_map_function : public map_function {
 	ex operator()(const ex & e) { return evalm(e); }
@@ -133,6 +133,7 @@ public: // only const functions please (may break reference counting)
 	// evaluation
 	virtual ex eval(int level = 0) const;
 	virtual ex evalf(int level = 0) const;
+	virtual double evalf_double(const exmap & m) const;
 	virtual ex evalm() const;
 	virtual ex eval_integ() const;
 protected:
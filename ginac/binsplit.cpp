@@ -0,0 +1,225 @@
+/** @file binsplit.cpp
+ *
+ *  Evaluation of nested polylogarithmic sums by binary splitting. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ *  The nested sum
+ *
+ *    S = sum_{n_1 > ... > n_d > 0} x_1^n_1/n_1^s_1 * ... * x_d^n_d/n_d^s_d
+ *
+ *  is the first component of the vector (G_1(n), ..., G_{d+1}(n)) for
+ *  n -> infinity, where with Y_k = x_1*...*x_k (and Y_0 = 1)
+ *
+ *    G_k(n) = Y_{k-1}^n * sum_{n >= n_k > ... > n_d > 0} x_k^n_k/n_k^s_k * ...
+ *
+ *  and G_{d+1}(n) = Y_d^n.  These satisfy the linear recurrence
+ *
+ *    G_k(n) = Y_{k-1} G_k(n-1) + Y_k/n^s_k G_{k+1}(n-1),
+ *    G_{d+1}(n) = Y_d G_{d+1}(n-1),
+ *
+ *  with G_k(0) = 0 for k <= d and G_{d+1}(0) = 1.  Its upper triangular
+ *  matrices are scaled to Gaussian integers with a common denominator, and
+ *  the product of the matrices for a range of n is computed by recursively
+ *  splitting the range in halves, so that most of the work is spent in few
+ *  multiplications of large numbers of similar size.  The range is doubled
+ *  until the partial sum does not change any more at the requested
+ *  precision.
+ */
+
+#include "binsplit.h"
+#include "numeric.h"
+
+#include <algorithm>
+#include <cln/integer.h>
+#include <cln/rational.h>
+#include <cln/real.h>
+#include <vector>
+
+namespace GiNaC {
+
+namespace {
+
+/** Below this many decimal digits, summing floating point terms one by one
+ *  is faster than the exact arithmetic of binary splitting. */
+const long binary_split_min_digits = 100;
+
+/** Upper triangular matrix of Gaussian integers divided by a common
+ *  denominator.  The entries are stored by rows. */
+struct split_matrix
+{
+	split_matrix(int dim_) : dim(dim_), a(dim_*dim_), den(1) {}
+
+	int dim;
+	std::vector<cln::cl_N> a;
+	cln::cl_I den;
+};
+
+split_matrix operator*(const split_matrix & l, const split_matrix & r)
+{
+	const int dim = l.dim;
+	split_matrix p(dim);
+	for (int i=0; i<dim; ++i) {
+		for (int j=i; j<dim; ++j) {
+			cln::cl_N sum = 0;
+			for (int k=i; k<=j; ++k)
+				sum = sum + l.a[i*dim+k] * r.a[k*dim+j];
+			p.a[i*dim+j] = sum;
+		}
+	}
+	p.den = l.den * r.den;
+	return p;
+}
+
+/** Recurrence matrices of a nested sum. */
+class nested_sum_recurrence
+{
+public:
+	nested_sum_recurrence(const std::vector<int> & s_, const std::vector<cln::cl_N> & y_,
+	                      const cln::cl_I & scale_)
+	  : s(s_), y(y_), scale(scale_), smax(*std::max_element(s_.begin(), s_.end())) {}
+
+	/** Product of the matrices for n = lo, ..., hi-1, the one for hi-1 to
+	 *  the left. */
+	split_matrix product(long lo, long hi) const
+	{
+		if (hi - lo == 1)
+			return matrix(lo);
+		const long mid = lo + (hi - lo)/2;
+		return product(mid, hi) * product(lo, mid);
+	}
+
+private:
+	split_matrix matrix(long n) const
+	{
+		const int d = s.size();
+		split_matrix m(d+1);
+		const cln::cl_I nn = n;
+		const cln::cl_I nmax = cln::expt_pos(nn, uintL(smax));
+		for (int k=0; k<d; ++k) {
+			m.a[k*(d+1)+k] = y[k] * nmax;
+			m.a[k*(d+1)+k+1] = y[k+1] * cln::expt_pos(nn, uintL(smax - s[k]));
+		}
+		m.a[d*(d+1)+d] = y[d] * nmax;
+		m.den = scale * nmax;
+		return m;
+	}
+
+	const std::vector<int> & s;
+	const std::vector<cln::cl_N> & y;  ///< scale*Y_k, Gaussian integers
+	const cln::cl_I scale;
+	const int smax;
+};
+
+bool is_exact(const cln::cl_N & x)
+{
+	return cln::instanceof(cln::realpart(x), cln::cl_RA_ring)
+	    && cln::instanceof(cln::imagpart(x), cln::cl_RA_ring);
+}
+
+cln::cl_I common_denominator(const cln::cl_N & x)
+{
+	return cln::lcm(cln::denominator(cln::the<cln::cl_RA>(cln::realpart(x))),
+	                cln::denominator(cln::the<cln::cl_RA>(cln::imagpart(x))));
+}
+
+/** Round the quotient of a Gaussian integer and an integer to prec. */
+cln::cl_N rounded_quotient(const cln::cl_N & num, const cln::cl_I & den,
+                           const cln::float_format_t & prec)
+{
+	const cln::cl_F fden = cln::cl_float(den, prec);
+	const cln::cl_F re = cln::cl_float(cln::the<cln::cl_I>(cln::realpart(num)), prec) / fden;
+	if (cln::zerop(cln::imagpart(num)))
+		return re;
+	return cln::complex(re, cln::cl_float(cln::the<cln::cl_I>(cln::imagpart(num)), prec) / fden);
+}
+
+} // anonymous namespace
+
+
+bool binary_split_applies(const std::vector<cln::cl_N> & x)
+{
+	if (Digits < binary_split_min_digits)
+		return false;
+
+	// the partial products must stay clear of the unit circle, or the sum
+	// needs too many terms
+	const cln::cl_RA bound = cln::cl_RA(9)/10;
+	cln::cl_N y = 1;
+	for (std::vector<cln::cl_N>::const_iterator it = x.begin(); it != x.end(); ++it) {
+		if (!is_exact(*it) || cln::zerop(*it))
+			return false;
+		y = y * (*it);
+		const cln::cl_RA re = cln::the<cln::cl_RA>(cln::realpart(y));
+		const cln::cl_RA im = cln::the<cln::cl_RA>(cln::imagpart(y));
+		if (re*re + im*im > bound)
+			return false;
+	}
+	return true;
+}
+
+
+cln::cl_N binary_split_sum(const std::vector<int> & s,
+                           const std::vector<cln::cl_N> & x,
+                           const cln::float_format_t & prec)
+{
+	const int d = s.size();
+
+	// the products Y_k, scaled to Gaussian integers
+	std::vector<cln::cl_N> y(d+1);
+	y[0] = 1;
+	cln::cl_I scale = 1;
+	for (int k=0; k<d; ++k) {
+		y[k+1] = y[k] * x[k];
+		scale = cln::lcm(scale, common_denominator(y[k+1]));
+	}
+	for (int k=0; k<=d; ++k)
+		y[k] = y[k] * scale;
+
+	const nested_sum_recurrence rec(s, y, scale);
+
+	// the state (G_1(n), ..., G_{d+1}(n)) is w/den
+	std::vector<cln::cl_N> w(d+1);
+	w[d] = 1;
+	cln::cl_I den = 1;
+
+	cln::cl_N res;
+	cln::cl_N resbuf;
+	long n = 1;
+	long block = 32;
+	do {
+		resbuf = res;
+		const split_matrix m = rec.product(n, n + block);
+		std::vector<cln::cl_N> next(d+1);
+		for (int i=0; i<=d; ++i) {
+			for (int j=i; j<=d; ++j)
+				next[i] = next[i] + m.a[i*(d+1)+j] * w[j];
+		}
+		w.swap(next);
+		den = den * m.den;
+		n += block;
+		block *= 2;
+		res = rounded_quotient(w[0], den, prec);
+	} while (res != resbuf);
+
+	return res;
+}
+
+} // namespace GiNaC
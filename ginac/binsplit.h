@@ -0,0 +1,55 @@
+/** @file binsplit.h
+ *
+ *  Interface to the evaluation of nested polylogarithmic sums by binary
+ *  splitting. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef GINAC_BINSPLIT_H
+#define GINAC_BINSPLIT_H
+
+#include <cln/complex.h>
+#include <cln/float.h>
+#include <vector>
+
+namespace GiNaC {
+
+/** Check whether binary_split_sum() pays off for the arguments x at the
+ *  current precision: they must be exact (rational or complex rational), the
+ *  sum must converge geometrically, and Digits must be large enough for the
+ *  exact arithmetic to beat summing floating point terms one by one. */
+extern bool binary_split_applies(const std::vector<cln::cl_N>& x);
+
+/** Value of the nested sum
+ *
+ *    sum_{n_1 > n_2 > ... > n_d > 0} x_1^n_1/n_1^s_1 * ... * x_d^n_d/n_d^s_d
+ *
+ *  (which is Li_{s_1,...,s_d}(x_1,...,x_d)) for exact arguments x, rounded
+ *  to the float format prec.  The partial sums are computed exactly by
+ *  binary splitting, which costs O(M(N) log(N)^2) for N digits instead of
+ *  O(N M(N)) when the terms are added one by one.
+ *
+ *  @see binary_split_applies */
+extern cln::cl_N binary_split_sum(const std::vector<int>& s,
+                                  const std::vector<cln::cl_N>& x,
+                                  const cln::float_format_t& prec);
+
+} // namespace GiNaC
+
+#endif // ndef GINAC_BINSPLIT_H
@@ -0,0 +1,306 @@
+/** @file evalplan.cpp
+ *
+ *  Implementation of precompiled numerical evaluation of expressions. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "evalplan.h"
+#include "add.h"
+#include "constant.h"
+#include "function.h"
+#include "mul.h"
+#include "power.h"
+#include "symbol.h"
+#include "utils.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace GiNaC {
+
+/** Build the evaluation plan of an expression.
+ *
+ *  @param e expression to be evaluated
+ *  @param params list of symbols whose values are passed to evalf() and
+ *    evalf_double(), in this order
+ *  @exception invalid_argument (parameter is not a symbol, or expression
+ *    contains symbols not in params) */
+evalplan::evalplan(const ex & e, const lst & params_) : has_leaves(false)
+{
+	for (lst::const_iterator i = params_.begin(); i != params_.end(); ++i) {
+		if (!is_a<symbol>(*i))
+			throw(std::invalid_argument("evalplan::evalplan(): parameters must be symbols"));
+		instruction in(op_param, *i);
+		in.index = params.size();
+		slots[*i] = code.size();
+		code.push_back(in);
+		params.push_back(*i);
+	}
+	result = compile(e);
+
+	// Only needed while compiling
+	slots.clear();
+}
+
+/** Append the instructions computing e (and all of its subexpressions not
+ *  computed yet) to the plan.
+ *
+ *  @return slot holding the value of e */
+unsigned evalplan::compile(const ex & e)
+{
+	std::map<ex, unsigned, ex_is_less>::const_iterator found = slots.find(e);
+	if (found != slots.end())
+		return found->second;
+
+	instruction in(op_leaf, e);
+	if (is_exactly_a<numeric>(e)) {
+		in.op = op_number;
+		in.dvalue = e.evalf_double(exmap());
+	} else if (is_exactly_a<constant>(e)) {
+		in.op = op_constant;
+		in.dvalue = e.evalf_double(exmap());
+	} else if (is_a<symbol>(e)) {
+		throw(std::invalid_argument("evalplan::evalplan(): symbol " + ex_to<symbol>(e).get_name() + " is not a parameter"));
+	} else if (is_exactly_a<add>(e) || is_exactly_a<mul>(e)) {
+		in.op = is_exactly_a<add>(e) ? op_add : op_mul;
+		for (size_t i=0; i<e.nops(); ++i)
+			in.args.push_back(compile(e.op(i)));
+	} else if (is_exactly_a<power>(e)) {
+		in.op = op_power;
+		in.args.push_back(compile(e.op(0)));
+		if (e.op(1).is_equal(_ex1_2))
+			in.op = op_sqrt;
+		else
+			in.args.push_back(compile(e.op(1)));
+	} else if (is_exactly_a<function>(e)) {
+		in.op = op_function;
+		for (size_t i=0; i<e.nops(); ++i)
+			in.args.push_back(compile(e.op(i)));
+	} else {
+		has_leaves = true;
+	}
+
+	const unsigned slot = code.size();
+	code.push_back(in);
+	slots[e] = slot;
+	return slot;
+}
+
+/** Evaluate the plan at the current precision.
+ *
+ *  @param values numerical values of the parameters
+ *  @return value of the expression, equal to subs() followed by evalf()
+ *  @exception invalid_argument (wrong number of values)
+ *  @exception runtime_error (subexpression does not evaluate to a number) */
+numeric evalplan::evalf(const std::vector<numeric> & values) const
+{
+	if (values.size() != params.size())
+		throw(std::invalid_argument("evalplan::evalf(): wrong number of values"));
+
+	// Substitutions for the leaves evaluated the slow way
+	exmap m;
+	if (has_leaves) {
+		for (size_t i=0; i<params.size(); ++i)
+			m[params[i]] = values[i];
+	}
+	std::vector<numeric> reg(code.size());
+	for (size_t k=0; k<code.size(); ++k) {
+		const instruction & in = code[k];
+		switch (in.op) {
+			case op_param:
+				reg[k] = ex_to<numeric>(values[in.index].evalf());
+				break;
+			case op_number:
+				reg[k] = ex_to<numeric>(in.node);
+				break;
+			case op_add: {
+				numeric sum = reg[in.args[0]];
+				for (size_t i=1; i<in.args.size(); ++i)
+					sum = sum.add(reg[in.args[i]]);
+				reg[k] = sum;
+				break;
+			}
+			case op_mul: {
+				numeric prod = reg[in.args[0]];
+				for (size_t i=1; i<in.args.size(); ++i)
+					prod = prod.mul(reg[in.args[i]]);
+				reg[k] = prod;
+				break;
+			}
+			case op_power:
+				reg[k] = reg[in.args[0]].power(reg[in.args[1]]);
+				break;
+			case op_sqrt:
+				reg[k] = sqrt(reg[in.args[0]]);
+				break;
+			case op_function: {
+				exvector args;
+				args.reserve(in.args.size());
+				for (size_t i=0; i<in.args.size(); ++i)
+					args.push_back(reg[in.args[i]]);
+				const ex val = function(ex_to<function>(in.node).get_serial(), args).evalf();
+				if (!is_exactly_a<numeric>(val))
+					throw(std::runtime_error("evalplan::evalf(): " + ex_to<function>(in.node).get_name() + "() does not evaluate to a number"));
+				reg[k] = ex_to<numeric>(val);
+				break;
+			}
+			case op_constant:
+			case op_leaf: {
+				const ex val = in.node.subs(m).evalf();
+				if (!is_exactly_a<numeric>(val))
+					throw(std::runtime_error("evalplan::evalf(): subexpression does not evaluate to a number"));
+				reg[k] = ex_to<numeric>(val);
+				break;
+			}
+		}
+	}
+	return ex_to<numeric>(reg[result].evalf());
+}
+
+/** Evaluate the plan in double precision.  Functions without a double
+ *  precision implementation and objects of other classes are evaluated
+ *  through evalf().
+ *
+ *  @param values numerical values of the parameters
+ *  @return value of the expression, NaN if it is not real
+ *  @exception invalid_argument (wrong number of values)
+ *  @see ex::evalf_double */
+double evalplan::evalf_double(const std::vector<double> & values) const
+{
+	if (values.size() != params.size())
+		throw(std::invalid_argument("evalplan::evalf_double(): wrong number of values"));
+
+	// Substitutions for the leaves evaluated the slow way
+	exmap m;
+	if (has_leaves) {
+		for (size_t i=0; i<params.size(); ++i)
+			m[params[i]] = values[i];
+	}
+	std::vector<double> reg(code.size());
+	std::vector<double> x;
+	for (size_t k=0; k<code.size(); ++k) {
+		const instruction & in = code[k];
+		switch (in.op) {
+			case op_param:
+				reg[k] = values[in.index];
+				break;
+			case op_number:
+			case op_constant:
+				reg[k] = in.dvalue;
+				break;
+			case op_add: {
+				double sum = reg[in.args[0]];
+				for (size_t i=1; i<in.args.size(); ++i)
+					sum += reg[in.args[i]];
+				reg[k] = sum;
+				break;
+			}
+			case op_mul: {
+				double prod = reg[in.args[0]];
+				for (size_t i=1; i<in.args.size(); ++i)
+					prod *= reg[in.args[i]];
+				reg[k] = prod;
+				break;
+			}
+			case op_power:
+				reg[k] = std::pow(reg[in.args[0]], reg[in.args[1]]);
+				break;
+			case op_sqrt:
+				reg[k] = std::sqrt(reg[in.args[0]]);
+				break;
+			case op_function:
+				x.resize(in.args.size());
+				for (size_t i=0; i<in.args.size(); ++i)
+					x[i] = reg[in.args[i]];
+				reg[k] = ex_to<function>(in.node).evalf_double(x);
+				break;
+			case op_leaf:
+				reg[k] = in.node.evalf_double(m);
+				break;
+		}
+	}
+	return reg[result];
+}
+
+/** Enclose the range of the expression over a box of parameter values.
+ *  Functions without an interval extension and objects of other classes
+ *  are only known to lie somewhere on the real line, so the result is
+ *  unbounded if the expression contains any of them.
+ *
+ *  @param values intervals of values of the parameters
+ *  @return interval containing all values of the expression over the box
+ *  @exception invalid_argument (wrong number of values) */
+interval evalplan::evalf_interval(const std::vector<interval> & values) const
+{
+	if (values.size() != params.size())
+		throw(std::invalid_argument("evalplan::evalf_interval(): wrong number of values"));
+
+	// Slots not set below stay at the whole real line
+	std::vector<interval> reg(code.size());
+	std::vector<interval> x;
+	for (size_t k=0; k<code.size(); ++k) {
+		const instruction & in = code[k];
+		switch (in.op) {
+			case op_param:
+				reg[k] = values[in.index];
+				break;
+			case op_number:
+				if (ex_to<numeric>(in.node).is_real())
+					reg[k] = interval(ex_to<numeric>(in.node));
+				break;
+			case op_constant: {
+				const ex val = in.node.evalf();
+				if (is_exactly_a<numeric>(val) && ex_to<numeric>(val).is_real())
+					reg[k] = interval::rounded(ex_to<numeric>(val), ex_to<numeric>(val));
+				break;
+			}
+			case op_add: {
+				interval sum = reg[in.args[0]];
+				for (size_t i=1; i<in.args.size(); ++i)
+					sum = sum.add(reg[in.args[i]]);
+				reg[k] = sum;
+				break;
+			}
+			case op_mul: {
+				interval prod = reg[in.args[0]];
+				for (size_t i=1; i<in.args.size(); ++i)
+					prod = prod.mul(reg[in.args[i]]);
+				reg[k] = prod;
+				break;
+			}
+			case op_power:
+				reg[k] = reg[in.args[0]].power(reg[in.args[1]]);
+				break;
+			case op_sqrt:
+				reg[k] = sqrt(reg[in.args[0]]);
+				break;
+			case op_function:
+				x.resize(in.args.size());
+				for (size_t i=0; i<in.args.size(); ++i)
+					x[i] = reg[in.args[i]];
+				reg[k] = ex_to<function>(in.node).evalf_interval(x);
+				break;
+			case op_leaf:
+				break;
+		}
+	}
+	return reg[result];
+}
+
+} // namespace GiNaC
@@ -0,0 +1,93 @@
+/** @file evalplan.h
+ *
+ *  Interface to precompiled numerical evaluation of expressions. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef GINAC_EVALPLAN_H
+#define GINAC_EVALPLAN_H
+
+#include "ex.h"
+#include "interval.h"
+#include "lst.h"
+#include "numeric.h"
+
+#include <map>
+#include <vector>
+
+namespace GiNaC {
+
+/** Precompiled numerical evaluation of an expression.
+ *
+ *  The expression is flattened into a sequence of instructions in
+ *  topological order, with structurally equal subexpressions shared.  The
+ *  plan can then be evaluated repeatedly at different values of its
+ *  parameters, which is much faster than subs() followed by evalf() since
+ *  no expression trees are rebuilt or re-evaluated. */
+class evalplan
+{
+public:
+	/** Operation codes of the instructions. */
+	enum opcode {
+		op_param,     ///< value of a parameter
+		op_number,    ///< numeric literal
+		op_constant,  ///< constant like Pi, evaluated at the current precision
+		op_add,       ///< sum of the arguments
+		op_mul,       ///< product of the arguments
+		op_power,     ///< first argument raised to the second
+		op_sqrt,      ///< square root of the argument
+		op_function,  ///< registered function applied to the arguments
+		op_leaf       ///< any other object, evaluated with subs() and evalf()
+	};
+
+	/** One step of the evaluation.  Its result goes into the slot with the
+	 *  same index as the instruction. */
+	struct instruction {
+		instruction(opcode o, const ex & n) : op(o), node(n), index(0), dvalue(0) {}
+		opcode op;
+		ex node;                    ///< subexpression computed by this step
+		std::vector<unsigned> args; ///< slots holding the arguments
+		unsigned index;             ///< parameter number for op_param
+		double dvalue;              ///< cached double value of a literal
+	};
+
+	evalplan(const ex & e, const lst & params);
+
+	numeric evalf(const std::vector<numeric> & values) const;
+	double evalf_double(const std::vector<double> & values) const;
+	interval evalf_interval(const std::vector<interval> & values) const;
+
+	/** Number of parameters the plan expects. */
+	size_t nparams() const { return params.size(); }
+	/** Number of instructions, i.e. distinct subexpressions. */
+	size_t size() const { return code.size(); }
+
+private:
+	unsigned compile(const ex & e);
+
+	exvector params;
+	std::vector<instruction> code;
+	unsigned result;                ///< slot holding the value of the expression
+	std::map<ex, unsigned, ex_is_less> slots; ///< slots of compiled subexpressions
+	bool has_leaves;
+};
+
+} // namespace GiNaC
+
+#endif // ndef GINAC_EVALPLAN_H
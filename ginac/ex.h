@@ -116,6 +116,7 @@ public:
 	// evaluation
 	ex eval(int level = 0) const { return bp->eval(level); }
 	ex evalf(int level = 0) const { return bp->evalf(level); }
+	double evalf_double(const exmap & m) const { return bp->evalf_double(m); }
 	ex evalm() const { return bp->evalm(); }
 	ex eval_ncmul(const exvector & v) const { return bp->eval_ncmul(v); }
 	ex eval_integ() const { return bp->eval_integ(); }
@@ -182,7 +183,7 @@ public:
 	ex series(const ex & r, int order, unsigned options = 0) const;
 
 	// rational functions
-	ex normal(int level = 0) const;
+	ex normal(int level = 0, unsigned processes = 1) const;
 	ex to_rational(exmap & repl) const;
 	ex to_rational(lst & repl_lst) const;
 	ex to_polynomial(exmap & repl) const;
@@ -736,8 +737,8 @@ inline ex denom(const ex & thisex)
 inline ex numer_denom(const ex & thisex)
 { return thisex.numer_denom(); }
 
-inline ex normal(const ex & thisex, int level=0)
-{ return thisex.normal(level); }
+inline ex normal(const ex & thisex, int level=0, unsigned processes=1)
+{ return thisex.normal(level, processes); }
 
 inline ex to_rational(const ex & thisex, lst & repl_lst)
 { return thisex.to_rational(repl_lst); }
@@ -760,6 +761,9 @@ inline ex eval(const ex & thisex, int level = 0)
 inline ex evalf(const ex & thisex, int level = 0)
 { return thisex.evalf(level); }
 
+inline double evalf_double(const ex & thisex, const exmap & m)
+{ return thisex.evalf_double(m); }
+
 inline ex evalm(const ex & thisex)
 { return thisex.evalm(); }
 
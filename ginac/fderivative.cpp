@@ -164,6 +164,14 @@ ex fderivative::evalf(int level) const
 	return basic::evalf(level);
 }
 
+/** Derivatives have no double precision implementation, they are evaluated
+ *  through evalf().
+ *  @see basic::evalf_double */
+double fderivative::evalf_double(const exmap & m) const
+{
+	return basic::evalf_double(m);
+}
+
 /** The series expansion of derivatives falls back to Taylor expansion.
  *  @see basic::series */
 ex fderivative::series(const relational & r, int order, unsigned options) const
@@ -133,7 +133,30 @@ public:
 		 *  division.  The determinant can then be read of from the lower
 		 *  right entry.  This algorithm is rarely fast for computing
 		 *  determinants. */
-		bareiss
+		bareiss,
+		/** Modular methods.  Integer matrices are reduced modulo word sized
+		 *  primes, whose determinants are combined by Chinese remaindering
+		 *  as soon as the product of the primes exceeds twice Hadamard's
+		 *  bound.  Matrices of polynomials with rational coefficients in a
+		 *  single variable are evaluated at sufficiently many integer points
+		 *  and the determinant is interpolated.  Other matrices are handled
+		 *  by Bareiss elimination. */
+		modular,
+		/** Bareiss fraction-free elimination with the rows below each
+		 *  pivot updated concurrently, one worker process per processor.
+		 *  Reference counting of expressions is not thread safe, so the
+		 *  workers are forked processes which get a copy of the matrix and
+		 *  send the updated rows back; the result is the same as with
+		 *  bareiss.  This only pays off for large symbolic matrices whose
+		 *  entries are expensive to update.  Numeric matrices are rather
+		 *  handled as with gauss, large rational ones by the modular method
+		 *  with the images modulo the primes computed by the workers.
+		 *  Symbolic matrices that decouple are split into their blocks,
+		 *  whose determinants are computed by the workers.  It must not be
+		 *  used while other threads of the program work with GiNaC, and
+		 *  evaluates sequentially on systems without fork() or if two
+		 *  different symbols of the matrix have the same name. */
+		parallel
 	};
 };
 
@@ -182,7 +205,29 @@ public:
 		 *  linear systems.  In contrast to division-free elimination it only
 		 *  has a linear expression swell.  For two-dimensional systems, the
 		 *  two algorithms are equivalent, however. */
-		bareiss
+		bareiss,
+		/** Modular methods.  Regular square systems of polynomials with
+		 *  rational coefficients in a single variable are solved at
+		 *  sufficiently many integer points and the solution is
+		 *  interpolated; large regular rational systems are solved modulo
+		 *  word sized primes by Cramer's rule.  Other systems are handled
+		 *  by Bareiss elimination. */
+		modular,
+		/** Sparse fraction-free elimination.  The system is stored as a
+		 *  sparse_matrix and only the rows with a nonzero entry in the pivot
+		 *  column are reduced, multiplied with the cofactors of the gcd of
+		 *  the two entries in the pivot column and freed of their content.
+		 *  The pivots are chosen by Markowitz' rule to keep the fill-in
+		 *  small.  This is meant for large systems with few unknowns in
+		 *  each equation. */
+		sparse,
+		/** Bareiss fraction-free elimination with the rows below each
+		 *  pivot updated concurrently in worker processes, as described
+		 *  for determinant_algo::parallel.  Square systems passed to
+		 *  lsolve() are split into the blocks they decouple into, and the
+		 *  blocks that do not depend on each other are solved by the
+		 *  workers. */
+		parallel
 	};
 };
 
@@ -37,12 +37,15 @@
 #include "integral.h"
 #include "lst.h"
 #include "matrix.h"
+#include "sparse_matrix.h"
+#include "updatable_matrix.h"
 #include "numeric.h"
 #include "power.h"
 #include "relational.h"
 #include "structure.h"
 #include "symbol.h"
 #include "pseries.h"
+#include "lazyseries.h"
 #include "wildcard.h"
 #include "symmetry.h"
 
@@ -69,6 +72,8 @@
 #include "factor.h"
 
 #include "excompiler.h"
+#include "interval.h"
+#include "evalplan.h"
 
 #ifndef IN_GINAC
 #include "parser.h"
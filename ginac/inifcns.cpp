@@ -25,15 +25,23 @@
 #include "constant.h"
 #include "lst.h"
 #include "matrix.h"
+#include "sparse_matrix.h"
 #include "mul.h"
 #include "power.h"
 #include "operators.h"
 #include "relational.h"
 #include "pseries.h"
+#include "interval.h"
+#include "evalplan.h"
 #include "symbol.h"
 #include "symmetry.h"
 #include "utils.h"
+#include "worker_processes.h"
 
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <set>
 #include <stdexcept>
 #include <vector>
 
@@ -224,6 +232,16 @@ static ex abs_evalf(const ex & arg)
 	return abs(arg).hold();
 }
 
+static double abs_evalf_double(double arg)
+{
+	return std::fabs(arg);
+}
+
+static interval abs_evalf_interval(const interval & arg)
+{
+	return abs(arg);
+}
+
 static ex abs_eval(const ex & arg)
 {
 	if (is_exactly_a<numeric>(arg))
@@ -338,6 +356,8 @@ bool abs_info(const ex & arg, unsigned inf)
 
 REGISTER_FUNCTION(abs, eval_func(abs_eval).
                        evalf_func(abs_evalf).
+                       evalf_double_func(abs_evalf_double).
+                       evalf_interval_func(abs_evalf_interval).
                        expand_func(abs_expand).
                        info_func(abs_info).
                        print_func<print_latex>(abs_print_latex).
@@ -988,6 +1008,20 @@ REGISTER_FUNCTION(Order, eval_func(Order_eval).
 // Solve linear system
 //////////
 
+typedef std::map<ex, unsigned, ex_is_less> unknown_map;
+
+/** Insert the indices of the unknowns occurring in e into found. */
+static void collect_unknowns(const ex & e, const unknown_map & unknowns, std::set<unsigned> & found)
+{
+	for (const_preorder_iterator i=e.preorder_begin(); i!=e.preorder_end(); ++i) {
+		if (!is_a<symbol>(*i))
+			continue;
+		const unknown_map::const_iterator u = unknowns.find(*i);
+		if (u != unknowns.end())
+			found.insert(u->second);
+	}
+}
+
 ex lsolve(const ex &eqns, const ex &symbols, unsigned options)
 {
 	// solve a system of linear equations
@@ -1020,35 +1054,61 @@ ex lsolve(const ex &eqns, const ex &symbols, unsigned options)
 		}
 	}
 	
-	// build matrix from equation system
-	matrix sys(eqns.nops(),symbols.nops());
+	// build matrix from equation system, with only the coefficients of the
+	// unknowns occurring in each equation, so large sparse systems do not
+	// cost time and memory for all the zeros
+	sparse_matrix sys(eqns.nops(),symbols.nops());
 	matrix rhs(eqns.nops(),1);
 	matrix vars(symbols.nops(),1);
+	unknown_map unknowns;
+	for (size_t i=0; i<symbols.nops(); i++) {
+		vars(i,0) = symbols.op(i);
+		unknowns.insert(std::make_pair(symbols.op(i), i));
+	}
 	
 	for (size_t r=0; r<eqns.nops(); r++) {
 		const ex eq = eqns.op(r).op(0)-eqns.op(r).op(1); // lhs-rhs==0
 		ex linpart = eq;
-		for (size_t c=0; c<symbols.nops(); c++) {
-			const ex co = eq.coeff(ex_to<symbol>(symbols.op(c)),1);
-			linpart -= co*symbols.op(c);
-			sys(r,c) = co;
+		std::set<unsigned> occurring;
+		collect_unknowns(eq, unknowns, occurring);
+		for (std::set<unsigned>::const_iterator c=occurring.begin(); c!=occurring.end(); ++c) {
+			const ex co = eq.coeff(ex_to<symbol>(symbols.op(*c)),1);
+			linpart -= co*symbols.op(*c);
+			sys.set(r,*c,co);
 		}
 		linpart = linpart.expand();
 		rhs(r,0) = -linpart;
 	}
 	
-	// test if system is linear and fill vars matrix
-	for (size_t i=0; i<symbols.nops(); i++) {
-		vars(i,0) = symbols.op(i);
-		if (sys.has(symbols.op(i)))
-			throw(std::logic_error("lsolve: system is not linear"));
-		if (rhs.has(symbols.op(i)))
+	// test if system is linear
+	std::set<unsigned> nonlinear;
+	for (size_t r=0; r<eqns.nops(); r++) {
+		const sparse_matrix::row_type & entries = sys.row_entries(r);
+		for (sparse_matrix::row_type::const_iterator i=entries.begin(); i!=entries.end(); ++i)
+			collect_unknowns(i->second, unknowns, nonlinear);
+		collect_unknowns(rhs(r,0), unknowns, nonlinear);
+		if (!nonlinear.empty())
 			throw(std::logic_error("lsolve: system is not linear"));
 	}
 	
+	// Square systems are split into the blocks they decouple into, which
+	// decide about sparse elimination themselves.  Other large systems with
+	// less than about one fifth of nonzero coefficients are better
+	// eliminated sparsely.
+	const bool blocks = eqns.nops() == symbols.nops() &&
+	                    (options == solve_algo::automatic || options == solve_algo::sparse ||
+	                     options == solve_algo::parallel);
+	if (!blocks && options == solve_algo::automatic && sys.is_sparse())
+		options = solve_algo::sparse;
+	
 	matrix solution;
 	try {
-		solution = sys.solve(vars,rhs,options);
+		if (blocks)
+			solution = sys.block_solve(vars,rhs,options);
+		else if (options == solve_algo::sparse)
+			solution = sys.solve(vars,rhs);
+		else
+			solution = sys.to_matrix().solve(vars,rhs,options);
 	} catch (const std::runtime_error & e) {
 		// Probably singular matrix or otherwise overdetermined system:
 		// It is consistent to return an empty list
@@ -1069,6 +1129,65 @@ ex lsolve(const ex &eqns, const ex &symbols, unsigned options)
 // Find real root of f(x) numerically
 //////////
 
+/** Shrink the bracket xx of a root of f with interval Newton steps: for any
+ *  m in X=[xx[0], xx[1]] the root lies in m-f(m)/f'(X), provided f' does
+ *  not vanish on X.  Stops as soon as a step fails to halve the bracket,
+ *  which leaves the rest to the point Newton iteration.  The values fx of
+ *  f at the ends are kept up to date.
+ *
+ *  @return true if a root was hit exactly, in which case it is in xx[0] */
+static bool interval_newton(const ex & f, const symbol & x, numeric xx[2], numeric fx[2])
+{
+	std::auto_ptr<evalplan> dplan;
+	try {
+		dplan.reset(new evalplan(f.diff(x), lst(x)));
+	} catch (std::invalid_argument &) {
+		return false;
+	}
+
+	for (;;) {
+		const interval X(xx[0], xx[1]);
+		const interval dF = dplan->evalf_interval(std::vector<interval>(1, X));
+		if (!dF.is_positive() && !dF.is_negative())
+			return false;
+
+		const numeric m = X.midpoint();
+		const ex fm_ = f.subs(x == m).evalf();
+		if (!is_exactly_a<numeric>(fm_) || !ex_to<numeric>(fm_).is_real())
+			return false;
+		const numeric & fm = ex_to<numeric>(fm_);
+		if (fm.is_zero()) {
+			xx[0] = m;
+			return true;
+		}
+		const interval N = interval(m) - interval::rounded(fm, fm)/dF;
+		if (N.upper() < X.lower() || N.lower() > X.upper())
+			return false;  // only rounding errors can get us here
+		const interval Xn = X.intersect(N);
+		if (Xn.width() > X.width()/2)
+			return false;
+
+		numeric nx[2] = { Xn.lower(), Xn.upper() };
+		numeric nf[2] = { fx[0], fx[1] };
+		for (int s=0; s<2; ++s) {
+			if (nx[s] == xx[s])
+				continue;
+			const ex f_x = f.subs(x == nx[s]).evalf();
+			if (!is_exactly_a<numeric>(f_x) || !ex_to<numeric>(f_x).is_real())
+				return false;
+			nf[s] = ex_to<numeric>(f_x);
+			if (nf[s].is_zero()) {
+				xx[0] = nx[s];
+				return true;
+			}
+		}
+		if (nf[0]*nf[1] >= 0)
+			return false;
+		xx[0] = nx[0]; xx[1] = nx[1];
+		fx[0] = nf[0]; fx[1] = nf[1];
+	}
+}
+
 const numeric
 fsolve(const ex& f_in, const symbol& x, const numeric& x1, const numeric& x2)
 {
@@ -1102,6 +1221,8 @@ fsolve(const ex& f_in, const symbol& x, const numeric& x1, const numeric& x2)
 	if (fx[0]*fx[1]>=0) {
 		throw std::runtime_error("fsolve(): function does not change sign at interval boundaries");
 	}
+	if (interval_newton(f, x, xx, fx))
+		return xx[0];
 
 	// The Newton-Raphson method has quadratic convergence!  Simply put, it
 	// replaces x with x-f(x)/f'(x) at each step.  -f/f' is the delta:
@@ -1191,6 +1312,193 @@ fsolve(const ex& f_in, const symbol& x, const numeric& x1, const numeric& x2)
 }
 
 
+/** Narrow down the bracket [lo, hi] of a sign change of f in double
+ *  precision by Newton-Raphson steps, falling back to bisection whenever a
+ *  step leaves the bracket.  flo is the value of f at lo. */
+static void fsolve_double(const evalplan & f, const evalplan & df, double & lo, double & hi, double flo)
+{
+	std::vector<double> t(1, 0.5*(lo + hi));
+	for (int iter=0; iter<100 && hi-lo > 1e-12*(std::fabs(lo) + std::fabs(hi)); ++iter) {
+		const double ft = f.evalf_double(t);
+		if (ft == 0 || ft != ft)
+			return;
+		if ((ft < 0) == (flo < 0))
+			lo = t[0];
+		else
+			hi = t[0];
+		const double step = ft/df.evalf_double(t);
+		t[0] -= step;
+		if (!(t[0] > lo && t[0] < hi))
+			t[0] = 0.5*(lo + hi);
+	}
+}
+
+/** The scan of fsolve_all(), split into chunks of the sample points, each
+ *  job scanning one chunk and refining the roots found there. */
+class fsolve_all_jobs : public worker_jobs {
+public:
+	fsolve_all_jobs(const ex & f_, const symbol & x_, const evalplan & fplan_, const evalplan & dfplan_,
+	                double da_, double db_, unsigned samples_, unsigned chunks_)
+	  : f(f_), x(x_), fplan(fplan_), dfplan(dfplan_), da(da_), db(db_),
+	    samples(samples_), chunks(chunks_) {}
+	exvector compute(size_t c);
+private:
+	double sample(unsigned i) const { return i==samples ? db : da + (db - da)*i/samples; }
+
+	const ex & f;
+	const symbol & x;
+	const evalplan & fplan;
+	const evalplan & dfplan;
+	double da, db;
+	unsigned samples, chunks;
+};
+
+/** Roots in chunk c, i.e. at the sample points of the chunk and between
+ *  them and the next one, in ascending order. */
+exvector fsolve_all_jobs::compute(size_t c)
+{
+	const unsigned first = samples*c/chunks;
+	const unsigned last = c+1==chunks ? samples+1 : samples*(c+1)/chunks;
+
+	// Sample f in double precision.  Points where it vanishes are checked at
+	// full precision, and are roots if it vanishes there, too.
+	const unsigned n = std::min(last+1, samples+1) - first;
+	std::vector<double> xs(n), fs(n);
+	std::vector<bool> is_root(n, false);
+	std::vector<double> t(1);
+	for (unsigned i=0; i<n; ++i) {
+		xs[i] = sample(first+i);
+		t[0] = xs[i];
+		fs[i] = fplan.evalf_double(t);
+		if (fs[i] == 0) {
+			const numeric fx = fplan.evalf(std::vector<numeric>(1, numeric(xs[i])));
+			if (fx.is_zero())
+				is_root[i] = true;
+			else if (fx.is_real())
+				fs[i] = fx.to_double();
+		}
+	}
+
+	// Narrow down each sign change, then polish at the current precision
+	exvector roots;
+	for (unsigned i=0; first+i<last; ++i) {
+		if (is_root[i])
+			roots.push_back(numeric(xs[i]));
+		if (i+1==n || (!(fs[i] < 0 && fs[i+1] > 0) && !(fs[i] > 0 && fs[i+1] < 0)))
+			continue;
+		double lo = xs[i], hi = xs[i+1];
+		fsolve_double(fplan, dfplan, lo, hi, fs[i]);
+		try {
+			roots.push_back(fsolve(f, x, numeric(lo), numeric(hi)));
+		} catch (std::runtime_error &) {
+			// No sign change at full precision, retry with the whole
+			// subinterval and give up if it has none either
+			try {
+				roots.push_back(fsolve(f, x, numeric(xs[i]), numeric(xs[i+1])));
+			} catch (std::runtime_error &) {
+			}
+		}
+	}
+	return roots;
+}
+
+lst fsolve_all(const ex& f_in, const symbol& x, const numeric& x1, const numeric& x2, unsigned samples,
+               unsigned processes)
+{
+	if (!x1.is_real() || !x2.is_real()) {
+		throw std::runtime_error("fsolve_all(): interval not bounded by real numbers");
+	}
+	if (x1==x2) {
+		throw std::runtime_error("fsolve_all(): vanishing interval");
+	}
+	if (samples==0) {
+		throw std::runtime_error("fsolve_all(): number of samples must be positive");
+	}
+	const ex f = is_a<relational>(f_in) ? f_in.lhs()-f_in.rhs() : f_in;
+	const numeric a = x1<x2 ? x1 : x2;
+	const numeric b = x1<x2 ? x2 : x1;
+
+	std::auto_ptr<evalplan> fplan, dfplan;
+	try {
+		fplan.reset(new evalplan(f, lst(x)));
+		dfplan.reset(new evalplan(f.diff(x), lst(x)));
+	} catch (std::invalid_argument &) {
+		throw std::runtime_error("fsolve_all(): function does not evaluate numerically");
+	}
+
+	// Several chunks per worker even out the differing numbers of roots
+	if (processes == 0)
+		processes = processor_count();
+	if (!have_worker_processes())
+		processes = 1;
+	const unsigned chunks = processes==1 ? 1 : std::min(samples, 4*processes);
+	fsolve_all_jobs jobs(f, x, *fplan, *dfplan, a.to_double(), b.to_double(), samples, chunks);
+	std::vector<exvector> found;
+	std::vector<bool> done(chunks, false);
+	if (chunks > 1)
+		compute_in_processes(jobs, chunks, processes, lst(), found, done);
+	else
+		found.resize(chunks);
+
+	lst roots;
+	for (unsigned c=0; c<chunks; ++c) {
+		bool ok = done[c];
+		for (exvector::const_iterator r=found[c].begin(); ok && r!=found[c].end(); ++r)
+			ok = is_exactly_a<numeric>(*r);
+		if (!ok)
+			found[c] = jobs.compute(c);
+		for (exvector::const_iterator r=found[c].begin(); r!=found[c].end(); ++r)
+			roots.append(*r);
+	}
+
+	return roots;
+}
+
+
+/** Restores Digits when it goes out of scope. */
+class digits_guard {
+public:
+	digits_guard() : saved(Digits) {}
+	~digits_guard() { Digits = saved; }
+private:
+	long saved;
+};
+
+ex evalf_to_accuracy(const ex& e, const numeric& accuracy, numeric& error, long max_digits)
+{
+	if (!accuracy.is_real() || !accuracy.is_positive())
+		throw std::invalid_argument("evalf_to_accuracy(): accuracy must be positive");
+	if (max_digits <= Digits)
+		throw std::invalid_argument("evalf_to_accuracy(): max_digits must exceed Digits");
+
+	const digits_guard guard;
+	// Start with the digits needed to resolve the accuracy for results of
+	// order one, escalation takes care of larger results and cancellations
+	const double needed = (-log(accuracy)/log(*_num10_p)).to_double();
+	long digits = std::max(long(Digits), long(std::ceil(std::min(needed, double(max_digits)))) + 2);
+	// Leave room below max_digits for at least one comparison value
+	digits = std::min(digits, std::max(long(Digits), max_digits - std::max(max_digits/3, 1L)));
+	Digits = digits;
+	ex prev = e.evalf();
+	if (!is_a<numeric>(prev))
+		throw std::runtime_error("evalf_to_accuracy(): expression does not evaluate numerically");
+
+	while (digits < max_digits) {
+		digits = std::min(digits + std::max(digits/2, 10L), max_digits);
+		Digits = digits;
+		const ex cur = e.evalf();
+		if (!is_a<numeric>(cur))
+			throw std::runtime_error("evalf_to_accuracy(): expression does not evaluate numerically");
+		// The difference estimates the error of the previous value, the
+		// current one is at least as good
+		error = abs(ex_to<numeric>(cur) - ex_to<numeric>(prev));
+		if (error <= accuracy)
+			return cur;
+		prev = cur;
+	}
+	throw std::runtime_error("evalf_to_accuracy(): accuracy not reached within max_digits");
+}
+
 /* Force inclusion of functions from inifcns_gamma and inifcns_zeta
  * for static lib (so ginsh will see them). */
 unsigned force_include_tgamma = tgamma_SERIAL::serial;
@@ -199,12 +199,70 @@ ex lsolve(const ex &eqns, const ex &symbols, unsigned options = solve_algo::auto
  *  @exception runtime_error (if interval is invalid). */
 const numeric fsolve(const ex& f, const symbol& x, const numeric& x1, const numeric& x2);
 
+/** Find all real roots of real-valued function f(x) numerically within a
+ *  given interval.  The interval is scanned for sign changes of f at
+ *  equidistant points in double precision, each sign change is narrowed
+ *  down in double precision and then refined to the current precision by
+ *  fsolve().  Roots where f does not change sign and roots closer to each
+ *  other than the spacing of the points may be missed.
+ *
+ *  @param f  Function f(x)
+ *  @param x  Symbol f(x)
+ *  @param x1  lower interval limit
+ *  @param x2  upper interval limit
+ *  @param samples  number of subintervals scanned for sign changes
+ *  @param processes  number of worker processes scanning parts of the
+ *    interval and refining their roots, 0 means one per processor
+ *  @return list of the roots found, in ascending order
+ *  @exception runtime_error (if interval is invalid or f does not
+ *    evaluate numerically). */
+lst fsolve_all(const ex& f, const symbol& x, const numeric& x1, const numeric& x2, unsigned samples = 1000,
+               unsigned processes = 1);
+
+/** Evaluate an expression numerically with an absolute error below a given
+ *  accuracy.  The expression is evaluated at increasing precision until two
+ *  successive values agree to the accuracy, so cancellations in sums of
+ *  polylogarithms or multiple zeta values are detected and compensated by
+ *  raising the precision of this evaluation only.  Digits is left unchanged.
+ *
+ *  @param e  expression to evaluate
+ *  @param accuracy  target absolute error (positive)
+ *  @param error  set to the estimated absolute error of the result
+ *  @param max_digits  highest precision to try, must exceed Digits
+ *  @return numerical value of e
+ *  @exception invalid_argument (accuracy is not positive or max_digits is
+ *    not larger than Digits)
+ *  @exception runtime_error (e does not evaluate to a number or the accuracy
+ *    is not reached with max_digits digits) */
+ex evalf_to_accuracy(const ex& e, const numeric& accuracy, numeric& error, long max_digits = 10000);
+
 /** Check whether a function is the Order (O(n)) function. */
 inline bool is_order_function(const ex & e)
 {
 	return is_ex_the_function(e, Order);
 }
 
+/** Numerical evaluation of G(a;y) and H(m;x) at many points. */
+exvector evalf_G(const ex& a, const exvector& y, unsigned processes = 1);
+exvector evalf_H(const ex& m, const exvector& x, unsigned processes = 1);
+
+/** Numerical evaluation of lgamma(x), tgamma(x) and psi(x) at many points. */
+exvector evalf_lgamma(const exvector & x);
+exvector evalf_tgamma(const exvector & x);
+exvector evalf_psi(const exvector & x);
+
+/** Build, write and read the tables used by the numerical evaluation of
+ *  polylogarithms. */
+void build_polylog_tables(int maxn, int length, unsigned processes = 1);
+void write_polylog_tables(std::ostream & os);
+void read_polylog_tables(std::istream & is);
+
+/** Relations between multiple zeta values used by their numerical
+ *  evaluation. */
+void read_zeta_relations(std::istream & is);
+void reset_zeta_relations();
+ex reduce_zeta(const ex & e);
+
 /** Converts a given list containing parameters for H in Remiddi/Vermaseren notation into
  *  the corresponding GiNaC functions.
  */
@@ -586,4 +586,61 @@ unsigned psi2_SERIAL::serial =
 	                       overloaded(2));
 
 
+//////////
+// Evaluation at many points
+//////////
+
+/** Numerical values of the function with the given serial number at many
+ *  points x.  Numeric points that are not integers go directly to the
+ *  numerical implementation f; other points are evaluated by evalf(), which
+ *  also takes care of the exact values at integers.  A pole_error of f is
+ *  passed on, just as evalf() does. */
+static exvector evalf_at_points(const numeric (*f)(const numeric &), unsigned serial,
+                                const exvector & x)
+{
+	exvector result;
+	result.reserve(x.size());
+	for (exvector::const_iterator it = x.begin(); it != x.end(); ++it) {
+		if (is_exactly_a<numeric>(*it) && !it->info(info_flags::integer))
+			result.push_back(f(ex_to<numeric>(*it)));
+		else
+			result.push_back(function(serial, *it).evalf());
+	}
+	return result;
+}
+
+/** Numerical values of lgamma(x) at many points x.  Numeric points go
+ *  directly to the numerical implementation, which computes the
+ *  coefficients of the Stirling series once per precision and shares them
+ *  by all points; other points are evaluated by evalf().
+ *
+ *  @param x  points
+ *  @return numerical values of lgamma(x) */
+exvector evalf_lgamma(const exvector & x)
+{
+	return evalf_at_points(lgamma, lgamma_SERIAL::serial, x);
+}
+
+/** Numerical values of tgamma(x) at many points x.
+ *
+ *  @param x  points
+ *  @return numerical values of tgamma(x)
+ *  @see evalf_lgamma */
+exvector evalf_tgamma(const exvector & x)
+{
+	return evalf_at_points(tgamma, tgamma_SERIAL::serial, x);
+}
+
+/** Numerical values of psi(x) at many points x.
+ *
+ *  @param x  points
+ *  @return numerical values of psi(x)
+ *  @exception pole_error if a point is one of 0, -1, -2, ...
+ *  @see evalf_lgamma */
+exvector evalf_psi(const exvector & x)
+{
+	return evalf_at_points(psi, psi1_SERIAL::serial, x);
+}
+
+
 } // namespace GiNaC
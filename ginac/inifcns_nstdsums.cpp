@@ -67,6 +67,7 @@
 #include "inifcns.h"
 
 #include "add.h"
+#include "binsplit.h"
 #include "constant.h"
 #include "lst.h"
 #include "mul.h"
@@ -78,10 +79,19 @@
 #include "symbol.h"
 #include "utils.h"
 #include "wildcard.h"
+#include "worker_processes.h"
+#include "parser/parser.h"
 
 #include <cln/cln.h>
+#include <algorithm>
+#include <cmath>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <set>
 #include <sstream>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 namespace GiNaC {
@@ -109,6 +119,63 @@ int xninitsize = xninitsizestep;
 int xnsize = 0;
 
 
+// X_1(i) for i >= 3.  The binomial coefficients are carried along instead
+// of being computed from scratch for every term.
+cln::cl_N X1_entry(int i)
+{
+	if (i & 1) {
+		// (binomial(i,1)/2 + binomial(i,i-1)/i) * (-B_{i-1}/2)
+		return -(cln::cl_I(i)/2 + 1) * Xn[0][(i-3)/2] / 2;
+	}
+	cln::cl_N result = Xn[0][i/2-1] + Xn[0][i/2-1]/(i+1);
+	cln::cl_I c = 1; // binomial(i,2*k)
+	for (int k=1; k<i/2; k++) {
+		c = cln::exquo(c * (i-2*k+2) * (i-2*k+1), cln::cl_I(2*k-1) * (2*k));
+		result = result + c * Xn[0][k-1] * Xn[0][i/2-k-1] / (k*2+1);
+	}
+	return result;
+}
+
+
+// X_n(i) for n >= 2 and i >= 2, computed from X_0 and X_{n-1}.
+cln::cl_N Xn_entry(int n, int i)
+{
+	cln::cl_N result;
+	if (!(i & 1)) {
+		result = Xn[0][i/2-1]; // k == 0
+	}
+	// The terms with odd i-k > 1 vanish with the Bernoulli number B_{i-k},
+	// so k runs over the numbers of the same parity as i.
+	int k = 2 - (i & 1);
+	cln::cl_I c = (i & 1) ? cln::cl_I(i) : cln::exquo(cln::cl_I(i) * (i-1), 2); // binomial(i,k)
+	for (; k<i-1; k+=2) {
+		result = result + c * Xn[0][(i-k)/2-1] * Xn[n-1][k-1] / (k+1);
+		c = cln::exquo(c * (i-k) * (i-k-1), cln::cl_I(k+1) * (k+2));
+	}
+	result = result - Xn[n-1][i-2] / 2; // k == i-1
+	result = result + Xn[n-1][i-1] / (i+1); // k == i
+	return result;
+}
+
+
+// X_n(i) for n >= 1 and i >= 1, including the first entries that are
+// known in closed form.
+cln::cl_N Xn_row_entry(int n, int i)
+{
+	if (n == 1) {
+		// special case to handle the X_0 correct
+		if (i == 1)
+			return cln::cl_I(-3)/cln::cl_I(4);
+		if (i == 2)
+			return cln::cl_I(17)/cln::cl_I(36);
+		return X1_entry(i);
+	}
+	if (i == 1)
+		return -(cln::expt(cln::cl_I(2),n+1) - 1) / cln::expt(cln::cl_I(2),n+1);
+	return Xn_entry(n, i);
+}
+
+
 // This function calculates the X_n. The X_n are needed for speed up of classical polylogarithms.
 // With these numbers the polylogs can be calculated as follows:
 //   Li_p (x)  =  \sum_{n=0}^\infty X_{p-2}(n) u^{n+1}/(n+1)! with  u = -log(1-x)
@@ -119,55 +186,16 @@ int xnsize = 0;
 // This results in a slightly more complicated algorithm for the X_n.
 // The first index in Xn corresponds to the index of the polylog minus 2.
 // The second index in Xn corresponds to the index from the actual sum.
+// The tables can be saved and restored by write_polylog_tables() and
+// read_polylog_tables().
 void fill_Xn(int n)
 {
-	if (n>1) {
-		// calculate X_2 and higher (corresponding to Li_4 and higher)
-		std::vector<cln::cl_N> buf(xninitsize);
-		std::vector<cln::cl_N>::iterator it = buf.begin();
-		cln::cl_N result;
-		*it = -(cln::expt(cln::cl_I(2),n+1) - 1) / cln::expt(cln::cl_I(2),n+1); // i == 1
-		it++;
-		for (int i=2; i<=xninitsize; i++) {
-			if (i&1) {
-				result = 0; // k == 0
-			} else {
-				result = Xn[0][i/2-1]; // k == 0
-			}
-			for (int k=1; k<i-1; k++) {
-				if ( !(((i-k) & 1) && ((i-k) > 1)) ) {
-					result = result + cln::binomial(i,k) * Xn[0][(i-k)/2-1] * Xn[n-1][k-1] / (k+1);
-				}
-			}
-			result = result - cln::binomial(i,i-1) * Xn[n-1][i-2] / 2 / i; // k == i-1
-			result = result + Xn[n-1][i-1] / (i+1); // k == i
-			
-			*it = result;
-			it++;
-		}
-		Xn.push_back(buf);
-	} else if (n==1) {
-		// special case to handle the X_0 correct
-		std::vector<cln::cl_N> buf(xninitsize);
-		std::vector<cln::cl_N>::iterator it = buf.begin();
-		cln::cl_N result;
-		*it = cln::cl_I(-3)/cln::cl_I(4); // i == 1
-		it++;
-		*it = cln::cl_I(17)/cln::cl_I(36); // i == 2
-		it++;
-		for (int i=3; i<=xninitsize; i++) {
-			if (i & 1) {
-				result = -Xn[0][(i-3)/2]/2;
-				*it = (cln::binomial(i,1)/cln::cl_I(2) + cln::binomial(i,i-1)/cln::cl_I(i))*result;
-				it++;
-			} else {
-				result = Xn[0][i/2-1] + Xn[0][i/2-1]/(i+1);
-				for (int k=1; k<i/2; k++) {
-					result = result + cln::binomial(i,k*2) * Xn[0][k-1] * Xn[0][i/2-k-1] / (k*2+1);
-				}
-				*it = result;
-				it++;
-			}
+	if (n>0) {
+		// calculate X_1 and higher (corresponding to Li_3 and higher)
+		std::vector<cln::cl_N> buf;
+		buf.reserve(xninitsize);
+		for (int i=1; i<=xninitsize; i++) {
+			buf.push_back(Xn_row_entry(n, i));
 		}
 		Xn.push_back(buf);
 	} else {
@@ -194,36 +222,14 @@ void double_Xn()
 	}
 	if (Xn.size() > 1) {
 		int xend = xninitsize + xninitsizestep;
-		cln::cl_N result;
 		// X_1
 		for (int i=xninitsize+1; i<=xend; ++i) {
-			if (i & 1) {
-				result = -Xn[0][(i-3)/2]/2;
-				Xn[1].push_back((cln::binomial(i,1)/cln::cl_I(2) + cln::binomial(i,i-1)/cln::cl_I(i))*result);
-			} else {
-				result = Xn[0][i/2-1] + Xn[0][i/2-1]/(i+1);
-				for (int k=1; k<i/2; k++) {
-					result = result + cln::binomial(i,k*2) * Xn[0][k-1] * Xn[0][i/2-k-1] / (k*2+1);
-				}
-				Xn[1].push_back(result);
-			}
+			Xn[1].push_back(X1_entry(i));
 		}
 		// X_n
 		for (size_t n=2; n<Xn.size(); ++n) {
 			for (int i=xninitsize+1; i<=xend; ++i) {
-				if (i & 1) {
-					result = 0; // k == 0
-				} else {
-					result = Xn[0][i/2-1]; // k == 0
-				}
-				for (int k=1; k<i-1; ++k) {
-					if ( !(((i-k) & 1) && ((i-k) > 1)) ) {
-						result = result + cln::binomial(i,k) * Xn[0][(i-k)/2-1] * Xn[n-1][k-1] / (k+1);
-					}
-				}
-				result = result - cln::binomial(i,i-1) * Xn[n-1][i-2] / 2 / i; // k == i-1
-				result = result + Xn[n-1][i-1] / (i+1); // k == i
-				Xn[n].push_back(result);
+				Xn[n].push_back(Xn_entry(n, i));
 			}
 		}
 	}
@@ -231,9 +237,70 @@ void double_Xn()
 }
 
 
+// Jobs of extend_Xn_row(): job j computes the entries of block j of the
+// new entries first, ..., last of X_n.
+class Xn_entry_jobs : public worker_jobs
+{
+public:
+	Xn_entry_jobs(int n_, int first_, int last_, size_t blocks_)
+	  : n(n_), first(first_), last(last_), blocks(blocks_) {}
+
+	int begin(size_t j) const { return first + int(j * (last - first + 1) / blocks); }
+
+	exvector compute(size_t j)
+	{
+		exvector res;
+		for (int i=begin(j); i<begin(j+1); ++i)
+			res.push_back(numeric(Xn_row_entry(n, i)));
+		return res;
+	}
+
+private:
+	int n, first, last;
+	size_t blocks;
+};
+
+
+// Extends X_n (n >= 1) to length entries.  The entries only depend on X_0
+// and X_{n-1}, so blocks of them are computed in up to the given number of
+// worker processes, 0 meaning one per processor.
+void extend_Xn_row(int n, int length, unsigned processes)
+{
+	std::vector<cln::cl_N> & row = Xn[n];
+	const int first = int(row.size()) + 1;
+	if (first > length)
+		return;
+	row.reserve(length);
+	if (processes == 0)
+		processes = processor_count();
+	const size_t blocks = std::min(size_t(processes) * 4, size_t(length - first + 1));
+	if (processes == 1 || !have_worker_processes()) {
+		for (int i=first; i<=length; ++i)
+			row.push_back(Xn_row_entry(n, i));
+		return;
+	}
+
+	Xn_entry_jobs jobs(n, first, length, blocks);
+	std::vector<exvector> results;
+	std::vector<bool> done;
+	compute_in_processes(jobs, blocks, processes, lst(), results, done);
+	for (size_t j=0; j<blocks; ++j) {
+		if (!done[j])
+			results[j] = jobs.compute(j);
+		for (size_t k=0; k<results[j].size(); ++k)
+			row.push_back(ex_to<numeric>(results[j][k]).to_cl_N());
+	}
+}
+
+
 // calculates Li(2,x) without Xn
 cln::cl_N Li2_do_sum(const cln::cl_N& x)
 {
+	const std::vector<cln::cl_N> xv(1, x);
+	if (binary_split_applies(xv)) {
+		return binary_split_sum(std::vector<int>(1, 2), xv, cln::float_format(Digits));
+	}
+
 	cln::cl_N res = x;
 	cln::cl_N resbuf;
 	cln::cl_N num = x * cln::cl_float(1, cln::float_format(Digits));
@@ -279,6 +346,11 @@ cln::cl_N Li2_do_sum_Xn(const cln::cl_N& x)
 // calculates Li(n,x), n>2 without Xn
 cln::cl_N Lin_do_sum(int n, const cln::cl_N& x)
 {
+	const std::vector<cln::cl_N> xv(1, x);
+	if (binary_split_applies(xv)) {
+		return binary_split_sum(std::vector<int>(1, n), xv, cln::float_format(Digits));
+	}
+
 	cln::cl_N factor = x * cln::cl_float(1, cln::float_format(Digits));
 	cln::cl_N res = x;
 	cln::cl_N resbuf;
@@ -473,6 +545,10 @@ cln::cl_N multipleLi_do_sum(const std::vector<int>& s, const std::vector<cln::cl
 		if ( *it == 0 ) return cln::cl_float(0, cln::float_format(Digits));
 	}
 
+	if (binary_split_applies(x)) {
+		return binary_split_sum(s, x, cln::float_format(Digits));
+	}
+
 	const int j = s.size();
 	bool flag_accidental_zero = false;
 
@@ -1058,63 +1134,77 @@ G_do_trafo(const std::vector<cln::cl_N>& x, const std::vector<int>& s,
 	// include upper limit (scale)
 	sortmap.insert(std::make_pair(abs(y), x.size()));
 
-	// generate missing dummy-symbols
-	int i = 1;
-	// holding dummy-symbols for the G/Li transformations
-	exvector gsyms;
-	gsyms.push_back(symbol("GSYMS_ERROR"));
-	cln::cl_N lastentry(0);
-	for (sortmap_t::const_iterator it = sortmap.begin(); it != sortmap.end(); ++it) {
-		if (it != sortmap.begin()) {
-			if (it->second < x.size()) {
-				if (x[it->second] == lastentry) {
-					gsyms.push_back(gsyms.back());
-					continue;
-				}
-			} else {
-				if (y == lastentry) {
-					gsyms.push_back(gsyms.back());
-					continue;
-				}
-			}
-		}
-		std::ostringstream os;
-		os << "a" << i;
-		gsyms.push_back(symbol(os.str()));
-		++i;
-		if (it->second < x.size()) {
-			lastentry = x[it->second];
-		} else {
-			lastentry = y;
-		}
-	}
-
-	// fill position data according to sorted indices and prepare substitution list
+	// Number the distinct values, in ascending order of their absolute
+	// values, and fill position data according to sorted indices.  The
+	// transformed expression depends on this pattern only, not on the
+	// values, so it is cached.
+	std::vector<int> key;
+	key.reserve(2*x.size() + 3);
+	key.push_back(x.size());
+	std::vector<int> ids;
+	ids.reserve(sortmap.size());
 	Gparameter a(x.size());
-	exmap subslst;
 	std::size_t pos = 1;
 	int scale = pos;
-	for (sortmap_t::const_iterator it = sortmap.begin(); it != sortmap.end(); ++it) {
+	cln::cl_N lastentry(0);
+	for (sortmap_t::const_iterator it = sortmap.begin(); it != sortmap.end(); ++it, ++pos) {
+		const cln::cl_N & value = it->second < x.size() ? x[it->second] : y;
+		if (it == sortmap.begin() || value != lastentry)
+			ids.push_back(ids.empty() ? 1 : ids.back() + 1);
+		else
+			ids.push_back(ids.back());
+		lastentry = value;
 		if (it->second < x.size()) {
 			if (s[it->second] > 0) {
 				a[it->second] = pos;
 			} else {
 				a[it->second] = -int(pos);
 			}
-			subslst[gsyms[pos]] = numeric(x[it->second]);
 		} else {
 			scale = pos;
-			subslst[gsyms[pos]] = numeric(y);
 		}
-		++pos;
+	}
+	key.insert(key.end(), a.begin(), a.end());
+	key.push_back(scale);
+	key.insert(key.end(), ids.begin(), ids.end());
+
+	typedef std::map<std::vector<int>, std::pair<exvector, ex> > trafo_cache_t;
+	static trafo_cache_t trafo_cache;
+	trafo_cache_t::iterator cached = trafo_cache.find(key);
+	if (cached == trafo_cache.end()) {
+		// generate dummy-symbols for the G/Li transformations
+		exvector gsyms;
+		gsyms.push_back(symbol("GSYMS_ERROR"));
+		for (std::size_t i = 0; i < ids.size(); ++i) {
+			if (i > 0 && ids[i] == ids[i-1]) {
+				gsyms.push_back(gsyms.back());
+				continue;
+			}
+			std::ostringstream os;
+			os << "a" << ids[i];
+			gsyms.push_back(symbol(os.str()));
+		}
+		// do transformation
+		Gparameter pendint;
+		ex result = G_transform(pendint, a, scale, gsyms);
+		result = result.eval().expand();
+		if (trafo_cache.size() >= 1000)
+			trafo_cache.clear();
+		cached = trafo_cache.insert(std::make_pair(key, std::make_pair(gsyms, result))).first;
 	}
 
-	// do transformation
-	Gparameter pendint;
-	ex result = G_transform(pendint, a, scale, gsyms);
 	// replace dummy symbols with their values
-	result = result.eval().expand();
-	result = result.subs(subslst).evalf();
+	const exvector & gsyms = cached->second.first;
+	exmap subslst;
+	pos = 1;
+	for (sortmap_t::const_iterator it = sortmap.begin(); it != sortmap.end(); ++it, ++pos) {
+		if (it->second < x.size()) {
+			subslst[gsyms[pos]] = numeric(x[it->second]);
+		} else {
+			subslst[gsyms[pos]] = numeric(y);
+		}
+	}
+	const ex result = cached->second.second.subs(subslst).evalf();
 	if (!is_a<numeric>(result))
 		throw std::logic_error("G_do_trafo: G_transform returned non-numeric result");
 	
@@ -1715,6 +1805,86 @@ REGISTER_FUNCTION(Li,
                   do_not_evalf_params());
 
 
+/** Write the tables of exact coefficients which speed up the numerical
+ *  evaluation of polylogarithms to a stream.  They grow with the precision
+ *  and the weight of the polylogarithms evaluated so far and take long to
+ *  build at high precision, so a later session may start from them by
+ *  calling read_polylog_tables().
+ *
+ *  @param os  stream to write the tables to
+ *  @see read_polylog_tables */
+void write_polylog_tables(std::ostream & os)
+{
+	os << "ginac-polylog-tables 1\n" << xnsize << ' ' << xninitsize << '\n';
+	for (int n=0; n<xnsize; ++n) {
+		for (size_t i=0; i<Xn[n].size(); ++i)
+			os << (i ? " " : "") << Xn[n][i];
+		os << '\n';
+	}
+}
+
+/** Build the tables for the numerical evaluation of Li(m,x) with m up to
+ *  maxn and with at least length terms of the series, so that they can be
+ *  written by write_polylog_tables().  The Bernoulli numbers are computed
+ *  here, the entries of the further tables in blocks by up to the given
+ *  number of worker processes, 0 meaning one per processor.
+ *
+ *  @param maxn  highest weight of the polylogarithms
+ *  @param length  number of terms
+ *  @param processes  number of worker processes
+ *  @see write_polylog_tables */
+void build_polylog_tables(int maxn, int length, unsigned processes)
+{
+	if (xnsize == 0)
+		fill_Xn(0);
+	// the length of the tables is even
+	length += length & 1;
+	if (length > xninitsize) {
+		for (int i=xninitsize/2+1; i<=length/2; ++i)
+			Xn[0].push_back(bernoulli(i*2).to_cl_N());
+		for (int n=1; n<xnsize; ++n)
+			extend_Xn_row(n, length, processes);
+		xninitsize = length;
+	}
+	for (int n=xnsize; n<maxn-1; ++n) {
+		Xn.push_back(std::vector<cln::cl_N>());
+		extend_Xn_row(n, xninitsize, processes);
+		xnsize++;
+	}
+}
+
+/** Read the tables written by write_polylog_tables().  They replace the
+ *  current tables if they are at least as large.
+ *
+ *  @param is  stream to read the tables from
+ *  @exception runtime_error (malformed tables)
+ *  @see write_polylog_tables */
+void read_polylog_tables(std::istream & is)
+{
+	std::string magic;
+	int version = 0, rows = -1, length = -1;
+	is >> magic >> version >> rows >> length;
+	if (!is || magic != "ginac-polylog-tables" || version != 1
+	 || rows < 0 || length < 2 || (length & 1))
+		throw std::runtime_error("read_polylog_tables(): malformed tables");
+
+	std::vector<std::vector<cln::cl_N> > buf(rows);
+	for (int n=0; n<rows; ++n) {
+		buf[n].resize(n ? length : length/2);
+		for (size_t i=0; i<buf[n].size(); ++i)
+			is >> buf[n][i];
+	}
+	if (!is)
+		throw std::runtime_error("read_polylog_tables(): malformed tables");
+
+	if (rows >= xnsize && length >= xninitsize) {
+		Xn.swap(buf);
+		xnsize = rows;
+		xninitsize = length;
+	}
+}
+
+
 //////////////////////////////////////////////////////////////////////
 //
 // Nielsen's generalized polylogarithm  S(n,p,x)
@@ -1916,6 +2086,15 @@ cln::cl_N S_do_sum(int n, int p, const cln::cl_N& x, const cln::float_format_t&
 		return Li_projection(n+1, x, prec);
 	}
 
+	// S_{n,p}(x) = Li_{n+1,1,...,1}(x,1,...,1)
+	std::vector<cln::cl_N> xv(p, 1);
+	xv[0] = x;
+	if (binary_split_applies(xv)) {
+		std::vector<int> sv(p, 1);
+		sv[0] = n+1;
+		return binary_split_sum(sv, xv, cln::float_format(Digits));
+	}
+
 	// precision has changed, we need to clear lookup table Yn
 	if ( oldprec != prec ) {
 		Yn.clear();
@@ -3082,6 +3261,12 @@ cln::cl_N H_do_sum(const std::vector<int>& m, const cln::cl_N& x)
 {
 	const int j = m.size();
 
+	std::vector<cln::cl_N> xv(j, 1);
+	xv[0] = x;
+	if (binary_split_applies(xv)) {
+		return binary_split_sum(m, xv, cln::float_format(Digits));
+	}
+
 	std::vector<cln::cl_N> t(j);
 
 	cln::cl_F one = cln::cl_float(1, cln::float_format(Digits));
@@ -3115,6 +3300,164 @@ cln::cl_N H_do_sum(const std::vector<int>& m, const cln::cl_N& x)
 //////////////////////////////////////////////////////////////////////
 
 
+// kinds of argument transformations used by H_evalf()
+enum H_trafo_kind { H_trafo_1overx, H_trafo_1mxt1px, H_trafo_1mx };
+
+// Applies an argument transformation to H(m, xtemp).  The result depends on
+// m only, so it is cached per parameter list.
+static ex H_transformed(const lst& m, const symbol& xtemp, H_trafo_kind kind)
+{
+	typedef std::map<ex, ex, ex_is_less> trafo_cache_t;
+	static trafo_cache_t trafo_cache[3];
+	trafo_cache_t & cache = trafo_cache[kind];
+	trafo_cache_t::const_iterator it = cache.find(m);
+	if (it != cache.end())
+		return it->second;
+
+	ex res;
+	switch (kind) {
+		case H_trafo_1overx: {
+			map_trafo_H_1overx trafo;
+			res = trafo(H(m, xtemp));
+			break;
+		}
+		case H_trafo_1mxt1px: {
+			map_trafo_H_1mxt1px trafo;
+			res = trafo(H(m, xtemp));
+			break;
+		}
+		case H_trafo_1mx: {
+			map_trafo_H_1mx trafo;
+			res = trafo(H(m, xtemp));
+			break;
+		}
+	}
+	if (cache.size() >= 1000)
+		cache.clear();
+	cache[m] = res;
+	return res;
+}
+
+
+// Parameters of H(m;x) prepared for the numerical evaluation at any point x.
+struct H_evalf_data {
+	lst m;               // expanded parameter notation
+	lst m_neg;           // the same for x with negative real part, i.e. -x
+	int sign_neg;        // sign of H(m;x) in terms of H(m_neg;-x)
+	bool has_minus_one;  // whether m has an entry -1
+	bool negative;       // whether m converts to Li with signs in s
+	lst m_lst;           // Li parameters
+	ex pf;               // prefactor of the Li for negative m
+	std::vector<int> m_int;
+	std::vector<cln::cl_N> s_cln;
+};
+
+// Expands the parameter notation of m and converts it for the summation.
+// The entries of m must be integers, the last one nonzero.
+static void H_prepare_evalf(const lst& morg, H_evalf_data& d)
+{
+	d.has_minus_one = false;
+	for (lst::const_iterator it = morg.begin(); it != morg.end(); it++) {
+		if (*it > 1) {
+			for (ex count=*it-1; count > 0; count--) {
+				d.m.append(0);
+			}
+			d.m.append(1);
+		} else if (*it <= -1) {
+			for (ex count=*it+1; count < 0; count++) {
+				d.m.append(0);
+			}
+			d.m.append(-1);
+			d.has_minus_one = true;
+		} else {
+			d.m.append(*it);
+		}
+	}
+
+	d.sign_neg = 1;
+	for (lst::const_iterator it = d.m.begin(); it != d.m.end(); it++) {
+		if (*it != 0) {
+			d.m_neg.append(-*it);
+			d.sign_neg = -d.sign_neg;
+		} else {
+			d.m_neg.append(*it);
+		}
+	}
+
+	lst s_lst;
+	d.negative = convert_parameter_H_to_Li(d.m, d.m_lst, s_lst, d.pf);
+	for (lst::const_iterator it = d.m_lst.begin(); it != d.m_lst.end(); it++) {
+		d.m_int.push_back(ex_to<numeric>(*it).to_int());
+	}
+	if (d.negative) {
+		// negative parameters -> s_lst is filled
+		for (lst::const_iterator it = s_lst.begin(); it != s_lst.end(); it++) {
+			d.s_cln.push_back(ex_to<numeric>(*it).to_cl_N());
+		}
+	}
+}
+
+// Numerical value of H(m;x) with m prepared by H_prepare_evalf(); x2 is
+// the argument x as given.
+static ex H_evalf_prepared(const H_evalf_data& d, cln::cl_N x, const ex& x2)
+{
+	// do summation
+	if (cln::abs(x) < 0.95) {
+		if (d.negative) {
+			std::vector<cln::cl_N> x_cln(d.s_cln);
+			x_cln.front() = x_cln.front() * x;
+			return d.pf * numeric(multipleLi_do_sum(d.m_int, x_cln));
+		} else {
+			// only positive parameters
+			//TODO
+			if (d.m_lst.nops() == 1) {
+				return Li(d.m_lst.op(0), x2).evalf();
+			}
+			return numeric(H_do_sum(d.m_int, x));
+		}
+	}
+
+	static const symbol xtemp("xtemp");
+	ex res = 1;
+
+	// ensure that the realpart of the argument is positive
+	const bool flip = cln::realpart(x) < 0;
+	if (flip) {
+		x = -x;
+		res = d.sign_neg;
+	}
+	const lst& m = flip ? d.m_neg : d.m;
+
+	// x -> 1/x
+	if (cln::abs(x) >= 2.0) {
+		res *= H_transformed(m, xtemp, H_trafo_1overx);
+		if (cln::imagpart(x) <= 0) {
+			res = res.subs(H_polesign == -I*Pi);
+		} else {
+			res = res.subs(H_polesign == I*Pi);
+		}
+		return res.subs(xtemp == numeric(x)).evalf();
+	}
+
+	// check transformations for 0.95 <= |x| < 2.0
+
+	// |(1-x)/(1+x)| < 0.9 -> circular area with center=9.53+0i and radius=9.47
+	if (cln::abs(x-9.53) <= 9.47) {
+		// x -> (1-x)/(1+x)
+		res *= H_transformed(m, xtemp, H_trafo_1mxt1px);
+	} else {
+		// x -> 1-x
+		if (d.has_minus_one) {
+			map_trafo_H_convert_to_Li filter;
+			return filter(H(m, numeric(x)).hold()).evalf();
+		}
+		res *= H_transformed(m, xtemp, H_trafo_1mx);
+	}
+
+	return res.subs(xtemp == numeric(x)).evalf();
+}
+
+
 static ex H_evalf(const ex& x1, const ex& x2)
 {
 	if (is_a<lst>(x1)) {
@@ -3138,107 +3481,15 @@ static ex H_evalf(const ex& x1, const ex& x2)
 			return H(x1, x2).hold();
 		}
 
-		const lst& morg = ex_to<lst>(x1);
 		// remove trailing zeros ...
-		if (*(--morg.end()) == 0) {
+		if (*(--ex_to<lst>(x1).end()) == 0) {
 			symbol xtemp("xtemp");
 			map_trafo_H_reduce_trailing_zeros filter;
 			return filter(H(x1, xtemp).hold()).subs(xtemp==x2).evalf();
 		}
-		// ... and expand parameter notation
-		bool has_minus_one = false;
-		lst m;
-		for (lst::const_iterator it = morg.begin(); it != morg.end(); it++) {
-			if (*it > 1) {
-				for (ex count=*it-1; count > 0; count--) {
-					m.append(0);
-				}
-				m.append(1);
-			} else if (*it <= -1) {
-				for (ex count=*it+1; count < 0; count++) {
-					m.append(0);
-				}
-				m.append(-1);
-				has_minus_one = true;
-			} else {
-				m.append(*it);
-			}
-		}
-
-		// do summation
-		if (cln::abs(x) < 0.95) {
-			lst m_lst;
-			lst s_lst;
-			ex pf;
-			if (convert_parameter_H_to_Li(m, m_lst, s_lst, pf)) {
-				// negative parameters -> s_lst is filled
-				std::vector<int> m_int;
-				std::vector<cln::cl_N> x_cln;
-				for (lst::const_iterator it_int = m_lst.begin(), it_cln = s_lst.begin(); 
-				     it_int != m_lst.end(); it_int++, it_cln++) {
-					m_int.push_back(ex_to<numeric>(*it_int).to_int());
-					x_cln.push_back(ex_to<numeric>(*it_cln).to_cl_N());
-				}
-				x_cln.front() = x_cln.front() * x;
-				return pf * numeric(multipleLi_do_sum(m_int, x_cln));
-			} else {
-				// only positive parameters
-				//TODO
-				if (m_lst.nops() == 1) {
-					return Li(m_lst.op(0), x2).evalf();
-				}
-				std::vector<int> m_int;
-				for (lst::const_iterator it = m_lst.begin(); it != m_lst.end(); it++) {
-					m_int.push_back(ex_to<numeric>(*it).to_int());
-				}
-				return numeric(H_do_sum(m_int, x));
-			}
-		}
-
-		symbol xtemp("xtemp");
-		ex res = 1;	
-		
-		// ensure that the realpart of the argument is positive
-		if (cln::realpart(x) < 0) {
-			x = -x;
-			for (std::size_t i = 0; i < m.nops(); i++) {
-				if (m.op(i) != 0) {
-					m.let_op(i) = -m.op(i);
-					res *= -1;
-				}
-			}
-		}
-
-		// x -> 1/x
-		if (cln::abs(x) >= 2.0) {
-			map_trafo_H_1overx trafo;
-			res *= trafo(H(m, xtemp));
-			if (cln::imagpart(x) <= 0) {
-				res = res.subs(H_polesign == -I*Pi);
-			} else {
-				res = res.subs(H_polesign == I*Pi);
-			}
-			return res.subs(xtemp == numeric(x)).evalf();
-		}
-		
-		// check transformations for 0.95 <= |x| < 2.0
-		
-		// |(1-x)/(1+x)| < 0.9 -> circular area with center=9.53+0i and radius=9.47
-		if (cln::abs(x-9.53) <= 9.47) {
-			// x -> (1-x)/(1+x)
-			map_trafo_H_1mxt1px trafo;
-			res *= trafo(H(m, xtemp));
-		} else {
-			// x -> 1-x
-			if (has_minus_one) {
-				map_trafo_H_convert_to_Li filter;
-				return filter(H(m, numeric(x)).hold()).evalf();
-			}
-			map_trafo_H_1mx trafo;
-			res *= trafo(H(m, xtemp));
-		}
-
-		return res.subs(xtemp == numeric(x)).evalf();
+		H_evalf_data d;
+		H_prepare_evalf(ex_to<lst>(x1), d);
+		return H_evalf_prepared(d, x, x2);
 	}
 
 	return H(x1,x2).hold();
@@ -3431,6 +3682,143 @@ REGISTER_FUNCTION(H,
                   do_not_evalf_params());
 
 
+// Evaluation of the points of evalf_G() and evalf_H(), job i being point i.
+// The jobs are computed in worker processes if more than one is asked for;
+// values that are not delivered, or are not numbers, are computed here.
+static exvector evalf_points(worker_jobs & jobs, std::size_t n, unsigned processes)
+{
+	std::vector<exvector> values;
+	std::vector<bool> done(n, false);
+	if (processes != 1 && n > 1 && have_worker_processes()) {
+		compute_in_processes(jobs, n, processes, lst(), values, done);
+	}
+	exvector result;
+	result.reserve(n);
+	for (std::size_t i = 0; i < n; ++i) {
+		if (done[i] && values[i].size() == 1 && is_a<numeric>(values[i][0])) {
+			result.push_back(values[i][0]);
+		} else {
+			result.push_back(jobs.compute(i)[0]);
+		}
+	}
+	return result;
+}
+
+// Points of G(a;y) with the parameters converted once.
+class G_points_jobs : public worker_jobs
+{
+public:
+	G_points_jobs(const ex& a_, const exvector& y_) : a(a_), y(y_)
+	{
+		const lst x = is_a<lst>(a) ? ex_to<lst>(a) : lst(a);
+		first = x.nops() > 0 ? x.op(0) : _ex0;
+		convertible = x.nops() > 0;
+		bool all_zero = true;
+		xv.reserve(x.nops());
+		s.reserve(x.nops());
+		for (lst::const_iterator it = x.begin(); convertible && it != x.end(); ++it) {
+			if (!is_a<numeric>(*it)) {
+				convertible = false;
+				break;
+			}
+			const numeric & xi = ex_to<numeric>(*it);
+			if (!xi.is_zero()) {
+				all_zero = false;
+			}
+			s.push_back(!xi.is_real() && xi.imag() < 0 ? -1 : 1);
+			xv.push_back(xi.to_cl_N());
+		}
+		convertible = convertible && !all_zero;
+	}
+	exvector compute(size_t i)
+	{
+		if (convertible && is_a<numeric>(y[i])
+		 && y[i].info(info_flags::positive) && first != y[i]) {
+			return exvector(1, numeric(G_numeric(xv, s, ex_to<numeric>(y[i]).to_cl_N())));
+		}
+		return exvector(1, G(a, y[i]).evalf());
+	}
+private:
+	const ex& a;
+	const exvector& y;
+	ex first;
+	bool convertible;
+	std::vector<cln::cl_N> xv;
+	std::vector<int> s;
+};
+
+/** Numerical values of the multiple polylogarithm G(a;y) at many points y.
+ *  The parameters are checked and converted only once.  The symbolic
+ *  transformations needed for the evaluation depend only on the ordering of
+ *  the absolute values of the parameters and the point, so they are shared
+ *  by all points with the same ordering.  With more than one process, the
+ *  points are distributed over worker processes as by evalf_parallel();
+ *  each worker then computes the transformations for its own points.
+ *
+ *  @param a  parameter (list)
+ *  @param y  points
+ *  @param processes  number of worker processes, 0 means one per processor
+ *  @return numerical values of G(a;y), or unevaluated G(a;y) where G cannot
+ *    be evaluated numerically */
+exvector evalf_G(const ex& a, const exvector& y, unsigned processes)
+{
+	G_points_jobs jobs(a, y);
+	return evalf_points(jobs, y.size(), processes);
+}
+
+
+// Points of H(m;x) with the parameters expanded and converted once.
+class H_points_jobs : public worker_jobs
+{
+public:
+	H_points_jobs(const ex& m_, const exvector& x_) : m(m_), x(x_), prepared(false)
+	{
+		// H_eval() handles some parameters and the points 0 and 1 itself
+		static const symbol xtemp("xtemp");
+		if (!is_a<lst>(m) || m.nops() == 0 || *(--ex_to<lst>(m).end()) == 0
+		 || !is_ex_the_function(H(m, xtemp), H)) {
+			return;
+		}
+		for (std::size_t i = 0; i < m.nops(); i++) {
+			if (!m.op(i).info(info_flags::integer)) {
+				return;
+			}
+		}
+		H_prepare_evalf(ex_to<lst>(m), d);
+		prepared = true;
+	}
+	exvector compute(size_t i)
+	{
+		if (prepared && is_a<numeric>(x[i]) && !x[i].is_zero() && x[i] != _ex1) {
+			return exvector(1, H_evalf_prepared(d, ex_to<numeric>(x[i]).to_cl_N(), x[i]));
+		}
+		return exvector(1, H(m, x[i]).evalf());
+	}
+private:
+	const ex& m;
+	const exvector& x;
+	bool prepared;
+	H_evalf_data d;
+};
+
+/** Numerical values of the harmonic polylogarithm H(m;x) at many points x.
+ *  The parameter notation is expanded and converted for the summation once,
+ *  and the transformations of the argument used for |x| >= 0.95 are
+ *  computed once per parameter list and shared by all points.  With more
+ *  than one process, the points are distributed over worker processes as
+ *  by evalf_parallel().
+ *
+ *  @param m  parameter (list)
+ *  @param x  points
+ *  @param processes  number of worker processes, 0 means one per processor
+ *  @return numerical values of H(m;x) */
+exvector evalf_H(const ex& m, const exvector& x, unsigned processes)
+{
+	H_points_jobs jobs(m, x);
+	return evalf_points(jobs, x.size(), processes);
+}
+
+
 // takes a parameter list for H and returns an expression with corresponding multiple polylogarithms
 ex convert_H_to_Li(const ex& m, const ex& x)
 {
@@ -3783,6 +4171,221 @@ cln::cl_N zeta_do_Hoelder_convolution(const std::vector<int>& m_, const std::vec
 }
 
 
+// Values of zeta already computed, keyed by the precision and by their
+// parameters.  Repeated evaluations, e.g. of the few basis values that
+// reduced multiple zeta values are expressed by, become table lookups.
+// Relations are evaluated with guard digits, so there are usually two
+// precisions in use at a time.
+typedef std::map<std::vector<int>, cln::cl_N> zeta_values_t;
+std::map<long, zeta_values_t> zeta_values;
+
+// Relations expressing multiple zeta values of a weight by a basis of that
+// weight, keyed by the parameters of the multiple zeta value.  The built-in
+// relations are read on first use, further ones by read_zeta_relations().
+std::map<std::vector<int>, ex> zeta_relations;
+bool zeta_relations_loaded = false;
+
+// Multiple zeta values whose relation is being evaluated, to stop cyclic
+// relations from recursing endlessly.
+std::set<std::vector<int> > zeta_relations_pending;
+
+// Relations for all multiple zeta values up to weight 5.  Even single zeta
+// values are powers of Pi, so the basis is zeta(3), zeta(5) and Pi.
+const char * const zeta_builtin_relations =
+	"zeta({2,1}) = zeta(3)\n"
+	"zeta({3,1}) = zeta(4)/4\n"
+	"zeta({2,2}) = 3/4*zeta(4)\n"
+	"zeta({2,1,1}) = zeta(4)\n"
+	"zeta({4,1}) = 2*zeta(5)-zeta(2)*zeta(3)\n"
+	"zeta({3,2}) = 3*zeta(2)*zeta(3)-11/2*zeta(5)\n"
+	"zeta({2,3}) = 9/2*zeta(5)-2*zeta(2)*zeta(3)\n"
+	"zeta({3,1,1}) = 2*zeta(5)-zeta(2)*zeta(3)\n"
+	"zeta({2,2,1}) = 3*zeta(2)*zeta(3)-11/2*zeta(5)\n"
+	"zeta({2,1,2}) = 9/2*zeta(5)-2*zeta(2)*zeta(3)\n"
+	"zeta({2,1,1,1}) = zeta(5)\n";
+
+void parse_zeta_relations(std::istream& is, const char* caller)
+{
+	parser reader(symtab(), true);
+	std::map<std::vector<int>, ex> buf;
+	std::string line;
+	while (std::getline(is, line)) {
+		const std::string::size_type first = line.find_first_not_of(" \t\r");
+		if (first == std::string::npos || line[first] == '#') {
+			continue;
+		}
+		const std::string::size_type eq = line.find('=');
+		if (eq == std::string::npos) {
+			throw std::runtime_error(std::string(caller) + ": malformed relation");
+		}
+		ex lhs, rhs;
+		try {
+			lhs = reader(line.substr(0, eq));
+			rhs = reader(line.substr(eq+1));
+		} catch (const parse_error& e) {
+			throw std::runtime_error(std::string(caller) + ": malformed relation");
+		}
+		if (!is_ex_the_function(lhs, zeta) || !is_exactly_a<lst>(lhs.op(0)) || lhs.op(0).nops() < 2) {
+			throw std::runtime_error(std::string(caller) + ": left-hand side is not a multiple zeta value");
+		}
+		const ex& m = lhs.op(0);
+		std::vector<int> r;
+		for (lst::const_iterator it = ex_to<lst>(m).begin(); it != ex_to<lst>(m).end(); ++it) {
+			if (!it->info(info_flags::posint)) {
+				throw std::runtime_error(std::string(caller) + ": left-hand side is not a multiple zeta value");
+			}
+			r.push_back(ex_to<numeric>(*it).to_int());
+		}
+		if (r[0] == 1) {
+			throw std::runtime_error(std::string(caller) + ": left-hand side is divergent");
+		}
+		buf[r] = rhs;
+	}
+	if (is.bad()) {
+		throw std::runtime_error(std::string(caller) + ": read error");
+	}
+
+	// only touch the table when the whole stream was good
+	for (std::map<std::vector<int>, ex>::const_iterator it = buf.begin(); it != buf.end(); ++it) {
+		zeta_relations[it->first] = it->second;
+	}
+	zeta_values.clear();
+}
+
+
+void load_builtin_zeta_relations()
+{
+	if (!zeta_relations_loaded) {
+		zeta_relations_loaded = true;
+		std::istringstream is(zeta_builtin_relations);
+		parse_zeta_relations(is, "load_builtin_zeta_relations()");
+	}
+}
+
+
+const ex* zeta_relations_lookup(const std::vector<int>& r)
+{
+	load_builtin_zeta_relations();
+	std::map<std::vector<int>, ex>::const_iterator it = zeta_relations.find(r);
+	if (it == zeta_relations.end()) {
+		return 0;
+	}
+	return &it->second;
+}
+
+
+// Digits to add while evaluating a relation, for the cancellations its
+// coefficients may cause: the length of the largest numerator or
+// denominator and of the number of terms.
+long zeta_relation_guard_digits(const ex& rel)
+{
+	int bits = 0;
+	for (const_preorder_iterator it = rel.preorder_begin(); it != rel.preorder_end(); ++it) {
+		if (is_exactly_a<numeric>(*it) && it->info(info_flags::rational)) {
+			const numeric& c = ex_to<numeric>(*it);
+			bits = std::max(bits, std::max(c.numer().int_length(), c.denom().int_length()));
+		}
+	}
+	const size_t terms = is_exactly_a<add>(rel) ? rel.nops() : 1;
+	return 3 + long(bits*0.30103) + long(std::log10(double(terms)));
+}
+
+
+// Evaluate a relation with the given guard digits.  If its terms cancel to
+// more digits than that, it is evaluated once more with enough of them.
+// Digits is left unchanged, the result is rounded to it.
+cln::cl_N zeta_relation_value(const ex& rel, long guard)
+{
+	const long digits = Digits;
+	ex val;
+	try {
+		for (int attempt = 0; attempt < 2; ++attempt) {
+			Digits = digits + guard;
+			val = 0;
+			numeric largest;
+			if (is_exactly_a<add>(rel)) {
+				for (size_t i = 0; i < rel.nops(); ++i) {
+					const ex term = rel.op(i).evalf();
+					if (is_a<numeric>(term) && abs(ex_to<numeric>(term)) > largest) {
+						largest = abs(ex_to<numeric>(term));
+					}
+					val += term;
+				}
+			} else {
+				val = rel.evalf();
+			}
+			if (!is_a<numeric>(val)) {
+				throw std::runtime_error("zeta_value(): relation does not evaluate to a number");
+			}
+			const numeric size = abs(ex_to<numeric>(val));
+			if (largest.is_zero() || size.is_zero()) {
+				break;
+			}
+			const long lost = long(std::ceil(log(largest/size).to_double()/std::log(10.0)));
+			if (lost + 3 <= guard) {
+				break;
+			}
+			guard = lost + 3;
+		}
+	} catch (...) {
+		Digits = digits;
+		throw;
+	}
+	Digits = digits;
+
+	const cln::cl_N res = ex_to<numeric>(val).to_cl_N();
+	const cln::float_format_t prec = cln::float_format(digits);
+	const cln::cl_R re = cln::realpart(res);
+	const cln::cl_R im = cln::imagpart(res);
+	return cln::complex(cln::cl_float(re, prec), cln::zerop(im) ? im : cln::cl_R(cln::cl_float(im, prec)));
+}
+
+
+// Numerical value of the (multiple) zeta value with parameters r, looked up
+// in zeta_values or computed and stored there.  r[0] must be greater than 1.
+cln::cl_N zeta_value(const std::vector<int>& r)
+{
+	std::map<long, zeta_values_t>::const_iterator values = zeta_values.find(Digits);
+	if (values != zeta_values.end()) {
+		zeta_values_t::const_iterator cached = values->second.find(r);
+		if (cached != values->second.end()) {
+			return cached->second;
+		}
+	}
+
+	cln::cl_N res;
+	const ex* rel = (r.size() > 1) ? zeta_relations_lookup(r) : 0;
+	if (rel && zeta_relations_pending.insert(r).second) {
+		try {
+			res = zeta_relation_value(*rel, zeta_relation_guard_digits(*rel));
+		} catch (...) {
+			zeta_relations_pending.erase(r);
+			throw;
+		}
+		zeta_relations_pending.erase(r);
+	} else if (r.size() == 1) {
+		res = cln::zeta(r[0]);
+	} else {
+		// decide on summation algorithm
+		// this is still a bit clumsy
+		const int count = r.size();
+		int limit = (Digits>17) ? 10 : 6;
+		if ((r[0] < limit) || ((count > 3) && (r[1] < limit/2))) {
+			res = zeta_do_sum_Crandall(r);
+		} else {
+			res = zeta_do_sum_simple(r);
+		}
+	}
+
+	// keep the values of a few precisions only
+	if (zeta_values.size() > 8 && zeta_values.find(Digits) == zeta_values.end()) {
+		zeta_values.clear();
+	}
+	zeta_values[Digits][r] = res;
+	return res;
+}
+
+
 } // end of anonymous namespace
 
 
@@ -3821,17 +4424,13 @@ static ex zeta1_evalf(const ex& x)
 			return zeta(x).hold();
 		}
 
-		// decide on summation algorithm
-		// this is still a bit clumsy
-		int limit = (Digits>17) ? 10 : 6;
-		if ((r[0] < limit) || ((count > 3) && (r[1] < limit/2))) {
-			return numeric(zeta_do_sum_Crandall(r));
-		} else {
-			return numeric(zeta_do_sum_simple(r));
-		}
+		return numeric(zeta_value(r));
 	}
 
 	// single zeta value
+	if (x.info(info_flags::posint) && (x != 1)) {
+		return numeric(zeta_value(std::vector<int>(1, ex_to<numeric>(x).to_int())));
+	}
 	if (is_exactly_a<numeric>(x) && (x != 1)) {
 		try {
 			return zeta(ex_to<numeric>(x));
@@ -3924,6 +4523,61 @@ unsigned zeta1_SERIAL::serial = function::register_new(function_options("zeta",
                                 overloaded(2));
 
 
+/** Read relations expressing multiple zeta values by a basis, one per line
+ *  in the form "zeta({3,2}) = 3*zeta(2)*zeta(3)-11/2*zeta(5)" (empty lines
+ *  and lines starting with '#' are ignored).  They are used by the
+ *  numerical evaluation of the multiple zeta values, which then only needs
+ *  the basis values, and by reduce_zeta().  Relations for all multiple zeta
+ *  values up to weight 5 are built in, those read replace built-in or
+ *  previously read ones for the same multiple zeta value.
+ *
+ *  @param is  stream to read the relations from
+ *  @exception runtime_error (malformed relations, none of them is used) */
+void read_zeta_relations(std::istream & is)
+{
+	load_builtin_zeta_relations();
+	parse_zeta_relations(is, "read_zeta_relations()");
+}
+
+
+/** Forget the relations read by read_zeta_relations(), so that only the
+ *  built-in ones are used again. */
+void reset_zeta_relations()
+{
+	zeta_relations.clear();
+	zeta_relations_loaded = false;
+	zeta_values.clear();
+}
+
+
+struct reduce_zeta_map_function : public map_function {
+	ex operator()(const ex & e)
+	{
+		if (is_ex_the_function(e, zeta) && is_exactly_a<lst>(e.op(0))) {
+			std::vector<int> r;
+			const lst& m = ex_to<lst>(e.op(0));
+			for (lst::const_iterator it = m.begin(); it != m.end(); ++it) {
+				if (!it->info(info_flags::posint)) {
+					return e;
+				}
+				r.push_back(ex_to<numeric>(*it).to_int());
+			}
+			const ex* rel = zeta_relations_lookup(r);
+			return rel ? *rel : e;
+		}
+		return e.map(*this);
+	}
+};
+
+/** Replace the multiple zeta values in an expression for which a relation
+ *  is known (see read_zeta_relations()) by their expression in the basis. */
+ex reduce_zeta(const ex & e)
+{
+	reduce_zeta_map_function map_reduce_zeta;
+	return map_reduce_zeta(e);
+}
+
+
 //////////////////////////////////////////////////////////////////////
 //
 // Alternating Euler sum  zeta(x,s)
@@ -32,8 +32,10 @@
 #include "relational.h"
 #include "symbol.h"
 #include "pseries.h"
+#include "interval.h"
 #include "utils.h"
 
+#include <cmath>
 #include <stdexcept>
 #include <vector>
 
@@ -51,6 +53,16 @@ static ex exp_evalf(const ex & x)
 	return exp(x).hold();
 }
 
+static double exp_evalf_double(double x)
+{
+	return std::exp(x);
+}
+
+static interval exp_evalf_interval(const interval & x)
+{
+	return exp(x);
+}
+
 static ex exp_eval(const ex & x)
 {
 	// exp(0) -> 1
@@ -128,10 +140,37 @@ static ex exp_conjugate(const ex & x)
 	return exp(x.conjugate());
 }
 
+static ex exp_series(const ex & arg,
+                     const relational & rel,
+                     int order,
+                     unsigned options)
+{
+	GINAC_ASSERT(is_a<symbol>(rel.lhs()));
+	if (!arg.has(rel.lhs()))
+		throw do_taylor();  // caught by function::series()
+	// method:
+	// Exponentiate the series of the argument by Newton iteration, this
+	// avoids the repeated differentiation of exp(arg) by Taylor expansion.
+	ex argser;
+	try {
+		argser = arg.series(rel, order, options);
+	} catch (const pole_error &) {
+		throw do_taylor();
+	} catch (const std::runtime_error &) {
+		throw do_taylor();
+	}
+	if (ex_to<pseries>(argser).ldegree(rel.lhs()) < 0)
+		throw do_taylor();
+	return ex_to<pseries>(argser).exp_series(order);
+}
+
 REGISTER_FUNCTION(exp, eval_func(exp_eval).
                        evalf_func(exp_evalf).
+                       evalf_double_func(exp_evalf_double).
+                       evalf_interval_func(exp_evalf_interval).
                        expand_func(exp_expand).
                        derivative_func(exp_deriv).
+                       series_func(exp_series).
                        real_part_func(exp_real_part).
                        imag_part_func(exp_imag_part).
                        conjugate_func(exp_conjugate).
@@ -149,6 +188,16 @@ static ex log_evalf(const ex & x)
 	return log(x).hold();
 }
 
+static double log_evalf_double(double x)
+{
+	return std::log(x);
+}
+
+static interval log_evalf_interval(const interval & x)
+{
+	return log(x);
+}
+
 static ex log_eval(const ex & x)
 {
 	if (x.info(info_flags::numeric)) {
@@ -272,6 +321,24 @@ static ex log_series(const ex &arg,
 		seq.push_back(expair(Order(_ex1), order));
 		return series(replarg - I*Pi + pseries(rel, seq), rel, order);
 	}
+	if (arg.has(rel.lhs())) {
+		// method:
+		// This is a regular point: take the logarithm of the series of the
+		// argument by Newton iteration instead of differentiating log(arg)
+		// over and over again.
+		ex argser;
+		try {
+			argser = arg.series(rel, order, options);
+		} catch (const pole_error &) {
+			throw do_taylor();
+		} catch (const std::runtime_error &) {
+			throw do_taylor();
+		}
+		const pseries & ser = ex_to<pseries>(argser);
+		if (ser.ldegree(rel.lhs()) == 0 && !ser.is_zero()
+		 && !is_order_function(ser.coeffop(0)))
+			return ser.log_series(order);
+	}
 	throw do_taylor();  // caught by function::series()
 }
 
@@ -352,6 +419,8 @@ static ex log_conjugate(const ex & x)
 
 REGISTER_FUNCTION(log, eval_func(log_eval).
                        evalf_func(log_evalf).
+                       evalf_double_func(log_evalf_double).
+                       evalf_interval_func(log_evalf_interval).
                        expand_func(log_expand).
                        derivative_func(log_deriv).
                        series_func(log_series).
@@ -372,6 +441,16 @@ static ex sin_evalf(const ex & x)
 	return sin(x).hold();
 }
 
+static double sin_evalf_double(double x)
+{
+	return std::sin(x);
+}
+
+static interval sin_evalf_interval(const interval & x)
+{
+	return sin(x);
+}
+
 static ex sin_eval(const ex & x)
 {
 	// sin(n/d*Pi) -> { all known non-nested radicals }
@@ -461,6 +540,8 @@ static ex sin_conjugate(const ex & x)
 
 REGISTER_FUNCTION(sin, eval_func(sin_eval).
                        evalf_func(sin_evalf).
+                       evalf_double_func(sin_evalf_double).
+                       evalf_interval_func(sin_evalf_interval).
                        derivative_func(sin_deriv).
                        real_part_func(sin_real_part).
                        imag_part_func(sin_imag_part).
@@ -479,6 +560,16 @@ static ex cos_evalf(const ex & x)
 	return cos(x).hold();
 }
 
+static double cos_evalf_double(double x)
+{
+	return std::cos(x);
+}
+
+static interval cos_evalf_interval(const interval & x)
+{
+	return cos(x);
+}
+
 static ex cos_eval(const ex & x)
 {
 	// cos(n/d*Pi) -> { all known non-nested radicals }
@@ -568,6 +659,8 @@ static ex cos_conjugate(const ex & x)
 
 REGISTER_FUNCTION(cos, eval_func(cos_eval).
                        evalf_func(cos_evalf).
+                       evalf_double_func(cos_evalf_double).
+                       evalf_interval_func(cos_evalf_interval).
                        derivative_func(cos_deriv).
                        real_part_func(cos_real_part).
                        imag_part_func(cos_imag_part).
@@ -586,6 +679,16 @@ static ex tan_evalf(const ex & x)
 	return tan(x).hold();
 }
 
+static double tan_evalf_double(double x)
+{
+	return std::tan(x);
+}
+
+static interval tan_evalf_interval(const interval & x)
+{
+	return tan(x);
+}
+
 static ex tan_eval(const ex & x)
 {
 	// tan(n/d*Pi) -> { all known non-nested radicals }
@@ -692,6 +795,8 @@ static ex tan_conjugate(const ex & x)
 
 REGISTER_FUNCTION(tan, eval_func(tan_eval).
                        evalf_func(tan_evalf).
+                       evalf_double_func(tan_evalf_double).
+                       evalf_interval_func(tan_evalf_interval).
                        derivative_func(tan_deriv).
                        series_func(tan_series).
                        real_part_func(tan_real_part).
@@ -711,6 +816,16 @@ static ex asin_evalf(const ex & x)
 	return asin(x).hold();
 }
 
+static double asin_evalf_double(double x)
+{
+	return std::asin(x);
+}
+
+static interval asin_evalf_interval(const interval & x)
+{
+	return asin(x);
+}
+
 static ex asin_eval(const ex & x)
 {
 	if (x.info(info_flags::numeric)) {
@@ -768,6 +883,8 @@ static ex asin_conjugate(const ex & x)
 
 REGISTER_FUNCTION(asin, eval_func(asin_eval).
                         evalf_func(asin_evalf).
+                        evalf_double_func(asin_evalf_double).
+                        evalf_interval_func(asin_evalf_interval).
                         derivative_func(asin_deriv).
                         conjugate_func(asin_conjugate).
                         latex_name("\\arcsin"));
@@ -784,6 +901,16 @@ static ex acos_evalf(const ex & x)
 	return acos(x).hold();
 }
 
+static double acos_evalf_double(double x)
+{
+	return std::acos(x);
+}
+
+static interval acos_evalf_interval(const interval & x)
+{
+	return acos(x);
+}
+
 static ex acos_eval(const ex & x)
 {
 	if (x.info(info_flags::numeric)) {
@@ -841,6 +968,8 @@ static ex acos_conjugate(const ex & x)
 
 REGISTER_FUNCTION(acos, eval_func(acos_eval).
                         evalf_func(acos_evalf).
+                        evalf_double_func(acos_evalf_double).
+                        evalf_interval_func(acos_evalf_interval).
                         derivative_func(acos_deriv).
                         conjugate_func(acos_conjugate).
                         latex_name("\\arccos"));
@@ -857,6 +986,16 @@ static ex atan_evalf(const ex & x)
 	return atan(x).hold();
 }
 
+static double atan_evalf_double(double x)
+{
+	return std::atan(x);
+}
+
+static interval atan_evalf_interval(const interval & x)
+{
+	return atan(x);
+}
+
 static ex atan_eval(const ex & x)
 {
 	if (x.info(info_flags::numeric)) {
@@ -957,6 +1096,8 @@ static ex atan_conjugate(const ex & x)
 
 REGISTER_FUNCTION(atan, eval_func(atan_eval).
                         evalf_func(atan_evalf).
+                        evalf_double_func(atan_evalf_double).
+                        evalf_interval_func(atan_evalf_interval).
                         derivative_func(atan_deriv).
                         series_func(atan_series).
                         conjugate_func(atan_conjugate).
@@ -974,6 +1115,11 @@ static ex atan2_evalf(const ex &y, const ex &x)
 	return atan2(y, x).hold();
 }
 
+static double atan2_evalf_double(double y, double x)
+{
+	return std::atan2(y, x);
+}
+
 static ex atan2_eval(const ex & y, const ex & x)
 {
 	if (y.is_zero()) {
@@ -1059,6 +1205,7 @@ static ex atan2_deriv(const ex & y, const ex & x, unsigned deriv_param)
 
 REGISTER_FUNCTION(atan2, eval_func(atan2_eval).
                          evalf_func(atan2_evalf).
+                         evalf_double_func(atan2_evalf_double).
                          derivative_func(atan2_deriv));
 
 //////////
@@ -1073,6 +1220,16 @@ static ex sinh_evalf(const ex & x)
 	return sinh(x).hold();
 }
 
+static double sinh_evalf_double(double x)
+{
+	return std::sinh(x);
+}
+
+static interval sinh_evalf_interval(const interval & x)
+{
+	return sinh(x);
+}
+
 static ex sinh_eval(const ex & x)
 {
 	if (x.info(info_flags::numeric)) {
@@ -1139,6 +1296,8 @@ static ex sinh_conjugate(const ex & x)
 
 REGISTER_FUNCTION(sinh, eval_func(sinh_eval).
                         evalf_func(sinh_evalf).
+                        evalf_double_func(sinh_evalf_double).
+                        evalf_interval_func(sinh_evalf_interval).
                         derivative_func(sinh_deriv).
                         real_part_func(sinh_real_part).
                         imag_part_func(sinh_imag_part).
@@ -1157,6 +1316,16 @@ static ex cosh_evalf(const ex & x)
 	return cosh(x).hold();
 }
 
+static double cosh_evalf_double(double x)
+{
+	return std::cosh(x);
+}
+
+static interval cosh_evalf_interval(const interval & x)
+{
+	return cosh(x);
+}
+
 static ex cosh_eval(const ex & x)
 {
 	if (x.info(info_flags::numeric)) {
@@ -1223,6 +1392,8 @@ static ex cosh_conjugate(const ex & x)
 
 REGISTER_FUNCTION(cosh, eval_func(cosh_eval).
                         evalf_func(cosh_evalf).
+                        evalf_double_func(cosh_evalf_double).
+                        evalf_interval_func(cosh_evalf_interval).
                         derivative_func(cosh_deriv).
                         real_part_func(cosh_real_part).
                         imag_part_func(cosh_imag_part).
@@ -1241,6 +1412,16 @@ static ex tanh_evalf(const ex & x)
 	return tanh(x).hold();
 }
 
+static double tanh_evalf_double(double x)
+{
+	return std::tanh(x);
+}
+
+static interval tanh_evalf_interval(const interval & x)
+{
+	return tanh(x);
+}
+
 static ex tanh_eval(const ex & x)
 {
 	if (x.info(info_flags::numeric)) {
@@ -1327,6 +1508,8 @@ static ex tanh_conjugate(const ex & x)
 
 REGISTER_FUNCTION(tanh, eval_func(tanh_eval).
                         evalf_func(tanh_evalf).
+                        evalf_double_func(tanh_evalf_double).
+                        evalf_interval_func(tanh_evalf_interval).
                         derivative_func(tanh_deriv).
                         series_func(tanh_series).
                         real_part_func(tanh_real_part).
@@ -1346,6 +1529,22 @@ static ex asinh_evalf(const ex & x)
 	return asinh(x).hold();
 }
 
+static double asinh_evalf_double(double x)
+{
+	// asinh(x) == -asinh(-x), avoid the cancellation for negative x
+	if (x < 0)
+		return -asinh_evalf_double(-x);
+	// x*x overflows beyond about 1.3e154, so take x out of the root
+	if (x > 1e8)
+		return std::log(x) + std::log(1 + std::sqrt(1 + 1/(x*x)));
+	return std::log(x + std::sqrt(x*x + 1));
+}
+
+static interval asinh_evalf_interval(const interval & x)
+{
+	return asinh(x);
+}
+
 static ex asinh_eval(const ex & x)
 {
 	if (x.info(info_flags::numeric)) {
@@ -1392,6 +1591,8 @@ static ex asinh_conjugate(const ex & x)
 
 REGISTER_FUNCTION(asinh, eval_func(asinh_eval).
                          evalf_func(asinh_evalf).
+                         evalf_double_func(asinh_evalf_double).
+                         evalf_interval_func(asinh_evalf_interval).
                          derivative_func(asinh_deriv).
                          conjugate_func(asinh_conjugate));
 
@@ -1407,6 +1608,19 @@ static ex acosh_evalf(const ex & x)
 	return acosh(x).hold();
 }
 
+static double acosh_evalf_double(double x)
+{
+	// x*x overflows beyond about 1.3e154, so take x out of the root
+	if (x > 1e8)
+		return std::log(x) + std::log(1 + std::sqrt(1 - 1/(x*x)));
+	return std::log(x + std::sqrt(x*x - 1));
+}
+
+static interval acosh_evalf_interval(const interval & x)
+{
+	return acosh(x);
+}
+
 static ex acosh_eval(const ex & x)
 {
 	if (x.info(info_flags::numeric)) {
@@ -1456,6 +1670,8 @@ static ex acosh_conjugate(const ex & x)
 
 REGISTER_FUNCTION(acosh, eval_func(acosh_eval).
                          evalf_func(acosh_evalf).
+                         evalf_double_func(acosh_evalf_double).
+                         evalf_interval_func(acosh_evalf_interval).
                          derivative_func(acosh_deriv).
                          conjugate_func(acosh_conjugate));
 
@@ -1471,6 +1687,16 @@ static ex atanh_evalf(const ex & x)
 	return atanh(x).hold();
 }
 
+static double atanh_evalf_double(double x)
+{
+	return 0.5*std::log((1 + x)/(1 - x));
+}
+
+static interval atanh_evalf_interval(const interval & x)
+{
+	return atanh(x);
+}
+
 static ex atanh_eval(const ex & x)
 {
 	if (x.info(info_flags::numeric)) {
@@ -1559,6 +1785,8 @@ static ex atanh_conjugate(const ex & x)
 
 REGISTER_FUNCTION(atanh, eval_func(atanh_eval).
                          evalf_func(atanh_evalf).
+                         evalf_double_func(atanh_evalf_double).
+                         evalf_interval_func(atanh_evalf_interval).
                          derivative_func(atanh_deriv).
                          series_func(atanh_series).
                          conjugate_func(atanh_conjugate));
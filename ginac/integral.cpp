@@ -33,6 +33,13 @@
 #include "utils.h"
 #include "operators.h"
 #include "relational.h"
+#include "evalplan.h"
+#include "constant.h"
+
+#include <memory>
+#include <queue>
+#include <utility>
+#include <vector>
 
 using namespace std;
 
@@ -188,7 +195,7 @@ ex integral::evalf(int level) const
 	// results after subsituting a number for the integration variable.
 	if (is_exactly_a<numeric>(ea) && is_exactly_a<numeric>(eb) 
 			&& is_exactly_a<numeric>(ef.subs(x==12.34).evalf())) {
-			return adaptivesimpson(x, ea, eb, ef);
+			return adaptivegauss(x, ea, eb, ef);
 	}
 
 	if (are_ex_trivially_equal(a, ea) && are_ex_trivially_equal(b, eb)
@@ -323,6 +330,184 @@ ex adaptivesimpson(const ex & x, const ex & a_in, const ex & b_in, const ex & f,
 	return app;
 }
 
+/** Compute the Legendre polynomial P_n and its derivative at t. */
+static void legendre(int n, const numeric & t, numeric & p, numeric & dp)
+{
+	numeric p0 = *_num1_p, p1 = t;
+	for (int k=2; k<=n; ++k) {
+		const numeric p2 = ((2*k-1)*t*p1 - (k-1)*p0)/k;
+		p0 = p1;
+		p1 = p2;
+	}
+	p = p1;
+	dp = n*(t*p1 - p0)/(t*t - 1);
+}
+
+/** Nodes and weights of the Gauss-Legendre rule on [-1, 1] used by
+  * adaptivegauss(), computed to the current precision by Newton iteration
+  * on the Legendre polynomial.  The number of nodes grows with Digits, so
+  * that smooth integrands converge without much subdivision at any
+  * precision.  The rule is symmetric, only the positive nodes are stored. */
+static const vector<pair<numeric, numeric> > & gauss_legendre_rule()
+{
+	static long digits = 0;
+	static vector<pair<numeric, numeric> > rule;
+	if (digits == long(Digits))
+		return rule;
+	digits = Digits;
+	rule.clear();
+
+	const int n = 2*(3 + digits/6);
+	const numeric pi = ex_to<numeric>(Pi.evalf());
+	const numeric eps = pow(numeric(10), numeric(2 - digits));
+	for (int i=1; i<=n/2; ++i) {
+		numeric t = cos(pi*numeric(4*i-1, 4*n+2));
+		numeric p, dp;
+		for (int iter=0; iter<100; ++iter) {
+			legendre(n, t, p, dp);
+			const numeric dt = p/dp;
+			t -= dt;
+			if (abs(dt) <= eps)
+				break;
+		}
+		legendre(n, t, p, dp);
+		rule.push_back(make_pair(t, 2/((1 - t*t)*dp*dp)));
+	}
+	return rule;
+}
+
+/** Integrand evaluated at numerical points, through an evaluation plan if
+  * possible and otherwise through subs() and evalf(). */
+class quadrature_integrand
+{
+public:
+	quadrature_integrand(const ex & x_, const ex & f_) : x(x_), f(f_)
+	{
+		if (is_a<symbol>(x)) {
+			try {
+				plan.reset(new evalplan(f, lst(x)));
+			} catch (invalid_argument &) {
+				// f contains other symbols, subsvalue() will complain
+			}
+		}
+	}
+
+	numeric operator()(const numeric & t) const
+	{
+		if (plan.get())
+			return plan->evalf(vector<numeric>(1, t));
+		return ex_to<numeric>(subsvalue(x, t, f));
+	}
+
+private:
+	ex x;
+	ex f;
+	auto_ptr<evalplan> plan;
+};
+
+/** Apply the Gauss-Legendre rule to the integral of f over [a, b].
+  *
+  * @param absval set to the approximation of the integral of abs(f) */
+static numeric gauss_legendre(const quadrature_integrand & f, const numeric & a, const numeric & b, numeric & absval)
+{
+	const vector<pair<numeric, numeric> > & rule = gauss_legendre_rule();
+	const numeric c = (a+b)/2;
+	const numeric h = (b-a)/2;
+	numeric sum, abssum;
+	for (size_t i=0; i<rule.size(); ++i) {
+		const numeric f1 = f(c - h*rule[i].first);
+		const numeric f2 = f(c + h*rule[i].first);
+		sum += rule[i].second*(f1 + f2);
+		abssum += rule[i].second*(abs(f1) + abs(f2));
+	}
+	absval = abs(h)*abssum;
+	return h*sum;
+}
+
+/** Subinterval in the error heap of adaptivegauss(). */
+struct quadrature_segment
+{
+	quadrature_segment(const numeric & a_, const numeric & b_, const numeric & integ, const numeric & err, int l)
+		: a(a_), b(b_), integral(integ), error(err), level(l) {}
+	numeric a;
+	numeric b;
+	numeric integral;
+	numeric error;  ///< estimated error of integral
+	int level;      ///< number of bisections leading to this segment
+};
+
+struct quadrature_segment_is_less
+{
+	bool operator()(const quadrature_segment & s1, const quadrature_segment & s2) const
+	{
+		return s1.error < s2.error;
+	}
+};
+
+/** Numeric integration by globally adaptive Gauss-Legendre quadrature.
+  * The integral over each subinterval is estimated by the rule applied to
+  * its two halves, the error by the difference to the rule applied to the
+  * whole subinterval.  The subinterval with the largest error is bisected
+  * until the sum of the errors drops below the requested relative error or
+  * below the rounding errors at the current precision.  Parameters are the
+  * same as for adaptivesimpson(), except that no lookup table is used.
+  *
+  * @exception runtime_error (integrand does not converge within
+  *   integral::max_integration_level bisections) */
+ex adaptivegauss(const ex & x, const ex & a_in, const ex & b_in, const ex & f, const ex & error_in)
+{
+	// Check whether boundaries and error are numbers.
+	ex a_ = is_exactly_a<numeric>(a_in) ? a_in : a_in.evalf();
+	ex b_ = is_exactly_a<numeric>(b_in) ? b_in : b_in.evalf();
+	ex error_ = error_in.evalf();
+	if (!is_exactly_a<numeric>(a_) || !is_exactly_a<numeric>(b_))
+		throw std::runtime_error("For numerical integration the boundaries of the integral should evalf into numbers.");
+	if (!is_exactly_a<numeric>(error_))
+		throw std::runtime_error("For numerical integration the error should be a number.");
+	const numeric & a = ex_to<numeric>(a_);
+	const numeric & b = ex_to<numeric>(b_);
+	const numeric error = abs(ex_to<numeric>(error_));
+
+	const quadrature_integrand integrand(x, f);
+	numeric absval, absval1, absval2;
+	const numeric whole = gauss_legendre(integrand, a, b, absval);
+	const numeric m = (a+b)/2;
+	const numeric i1 = gauss_legendre(integrand, a, m, absval1);
+	const numeric i2 = gauss_legendre(integrand, m, b, absval2);
+
+	// Below this error the estimates are dominated by rounding errors
+	const numeric noise = pow(numeric(10), numeric(2 - long(Digits)))*(absval1 + absval2);
+
+	priority_queue<quadrature_segment, vector<quadrature_segment>, quadrature_segment_is_less> heap;
+	numeric total = i1 + i2;
+	numeric total_error = abs(whole - total);
+	heap.push(quadrature_segment(a, m, i1, total_error/2, 1));
+	heap.push(quadrature_segment(m, b, i2, total_error/2, 1));
+
+	while (total_error > error*abs(total) && total_error > noise) {
+		const quadrature_segment worst = heap.top();
+		if (worst.level >= integral::max_integration_level)
+			throw runtime_error("max integration level reached");
+		heap.pop();
+		const numeric mid = (worst.a + worst.b)/2;
+		const numeric s1 = gauss_legendre(integrand, worst.a, mid, absval1);
+		const numeric s2 = gauss_legendre(integrand, mid, worst.b, absval2);
+		const numeric err = abs(worst.integral - s1 - s2);
+		total += s1 + s2 - worst.integral;
+		total_error += err - worst.error;
+		heap.push(quadrature_segment(worst.a, mid, s1, err/2, worst.level + 1));
+		heap.push(quadrature_segment(mid, worst.b, s2, err/2, worst.level + 1));
+	}
+
+	// Sum up again, the running total has accumulated rounding errors
+	total = 0;
+	while (!heap.empty()) {
+		total += heap.top().integral;
+		heap.pop();
+	}
+	return total;
+}
+
 int integral::degree(const ex & s) const
 {
 	return ((b-a)*f).degree(s);
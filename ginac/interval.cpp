@@ -0,0 +1,414 @@
+/** @file interval.cpp
+ *
+ *  Implementation of real interval arithmetic. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "interval.h"
+#include "constant.h"
+#include "operators.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#include <cln/real.h>
+
+namespace GiNaC {
+
+//////////
+// helpers
+//////////
+
+/** Relative amount by which floating point bounds are moved outwards.  CLN
+ *  computes with at least Digits decimal digits, the two spare digits
+ *  cover the rounding errors of the transcendental functions. */
+static const numeric & rounding_epsilon()
+{
+	static long digits = 0;
+	static numeric eps;
+	if (digits != long(Digits)) {
+		digits = Digits;
+		eps = pow(*_num10_p, numeric(2 - digits));
+	}
+	return eps;
+}
+
+static numeric round_down(const numeric & x)
+{
+	if (x.is_rational())
+		return x;
+	return x - abs(x)*rounding_epsilon();
+}
+
+static numeric round_up(const numeric & x)
+{
+	if (x.is_rational())
+		return x;
+	return x + abs(x)*rounding_epsilon();
+}
+
+static numeric floor(const numeric & x)
+{
+	return numeric(cln::floor1(cln::the<cln::cl_R>(x.to_cl_N())));
+}
+
+/** Check whether x contains a point phase+2*k*Pi for some integer k.  The
+ *  test errs on the side of finding such a point. */
+static bool contains_phase(const interval & x, const numeric & phase)
+{
+	const numeric twopi = ex_to<numeric>(2*Pi.evalf());
+	const numeric t0 = round_down((round_down(x.lower()) - phase)/twopi);
+	const numeric t1 = round_up((round_up(x.upper()) - phase)/twopi);
+	const numeric k = floor(t1);
+	return k >= t0 - rounding_epsilon();
+}
+
+//////////
+// constructors
+//////////
+
+/** Construct the whole real line. */
+interval::interval() : lo(0), hi(0), bounded(false)
+{
+}
+
+/** Construct the degenerate interval [x, x]. */
+interval::interval(const numeric & x) : lo(x), hi(x), bounded(true)
+{
+	if (!x.is_real())
+		throw std::invalid_argument("interval::interval(): bound is not real");
+}
+
+/** Construct the interval [lo, hi]. */
+interval::interval(const numeric & lo_, const numeric & hi_) : lo(lo_), hi(hi_), bounded(true)
+{
+	if (!lo.is_real() || !hi.is_real())
+		throw std::invalid_argument("interval::interval(): bounds are not real");
+	if (lo > hi)
+		throw std::invalid_argument("interval::interval(): lower bound exceeds upper bound");
+}
+
+interval interval::rounded(const numeric & lo, const numeric & hi)
+{
+	return interval(round_down(lo), round_up(hi));
+}
+
+//////////
+// non-virtual functions in this class
+//////////
+
+const numeric & interval::lower() const
+{
+	if (!bounded)
+		throw std::domain_error("interval::lower(): interval is unbounded");
+	return lo;
+}
+
+const numeric & interval::upper() const
+{
+	if (!bounded)
+		throw std::domain_error("interval::upper(): interval is unbounded");
+	return hi;
+}
+
+numeric interval::midpoint() const
+{
+	return (lower() + upper())/2;
+}
+
+numeric interval::width() const
+{
+	return upper() - lower();
+}
+
+bool interval::contains(const numeric & x) const
+{
+	return !bounded || (lo <= x && x <= hi);
+}
+
+bool interval::contains(const interval & other) const
+{
+	if (!bounded)
+		return true;
+	return other.bounded && lo <= other.lo && other.hi <= hi;
+}
+
+/** Check whether all numbers in the interval are positive. */
+bool interval::is_positive() const
+{
+	return bounded && lo.is_positive();
+}
+
+/** Check whether all numbers in the interval are negative. */
+bool interval::is_negative() const
+{
+	return bounded && hi.is_negative();
+}
+
+/** Intersection of two intervals.
+ *
+ *  @exception domain_error (intervals are disjoint) */
+interval interval::intersect(const interval & other) const
+{
+	if (!bounded)
+		return other;
+	if (!other.bounded)
+		return *this;
+	const numeric & l = std::max(lo, other.lo);
+	const numeric & h = std::min(hi, other.hi);
+	if (l > h)
+		throw std::domain_error("interval::intersect(): intervals are disjoint");
+	return interval(l, h);
+}
+
+/** Smallest interval containing both intervals. */
+interval interval::hull(const interval & other) const
+{
+	if (!bounded || !other.bounded)
+		return interval();
+	return interval(std::min(lo, other.lo), std::max(hi, other.hi));
+}
+
+const interval interval::operator-() const
+{
+	if (!bounded)
+		return *this;
+	return interval(-hi, -lo);
+}
+
+const interval interval::add(const interval & other) const
+{
+	if (!bounded || !other.bounded)
+		return interval();
+	return rounded(lo + other.lo, hi + other.hi);
+}
+
+const interval interval::sub(const interval & other) const
+{
+	if (!bounded || !other.bounded)
+		return interval();
+	return rounded(lo - other.hi, hi - other.lo);
+}
+
+const interval interval::mul(const interval & other) const
+{
+	if (!bounded || !other.bounded)
+		return interval();
+	const numeric p1 = lo*other.lo, p2 = lo*other.hi,
+	              p3 = hi*other.lo, p4 = hi*other.hi;
+	return rounded(std::min(std::min(p1, p2), std::min(p3, p4)),
+	               std::max(std::max(p1, p2), std::max(p3, p4)));
+}
+
+const interval interval::div(const interval & other) const
+{
+	if (!other.is_positive() && !other.is_negative())
+		return interval();
+	return mul(rounded(other.hi.inverse(), other.lo.inverse()));
+}
+
+const interval interval::power(const numeric & exponent) const
+{
+	if (!bounded || !exponent.is_real())
+		return interval();
+	if (exponent.is_zero())
+		return interval(*_num1_p);
+
+	if (exponent.is_integer()) {
+		if (exponent.is_negative())
+			return interval(*_num1_p).div(power(-exponent));
+		const numeric l = lo.power(exponent), h = hi.power(exponent);
+		if (exponent.is_odd() || !lo.is_negative())
+			return rounded(l, h);
+		if (!hi.is_positive())
+			return rounded(h, l);
+		return rounded(*_num0_p, std::max(l, h));
+	}
+
+	// Non-integer powers are only real for non-negative bases
+	if (lo.is_negative())
+		return interval();
+	if (exponent.is_positive())
+		return rounded(lo.power(exponent), hi.power(exponent));
+	if (lo.is_zero())
+		return interval();
+	return rounded(hi.power(exponent), lo.power(exponent));
+}
+
+const interval interval::power(const interval & exponent) const
+{
+	if (!exponent.is_bounded())
+		return interval();
+	if (exponent.lo == exponent.hi)
+		return power(exponent.lo);
+	if (!is_positive())
+		return interval();
+	return exp(exponent.mul(log(*this)));
+}
+
+void interval::print(std::ostream & os) const
+{
+	if (bounded)
+		os << '[' << lo << ", " << hi << ']';
+	else
+		os << "[-infinity, infinity]";
+}
+
+//////////
+// interval extensions of elementary functions
+//////////
+
+const interval exp(const interval & x)
+{
+	if (!x.is_bounded())
+		return interval();
+	return interval::rounded(exp(x.lower()), exp(x.upper()));
+}
+
+const interval log(const interval & x)
+{
+	if (!x.is_positive())
+		return interval();
+	return interval::rounded(log(x.lower()), log(x.upper()));
+}
+
+const interval sqrt(const interval & x)
+{
+	if (!x.is_bounded() || x.lower().is_negative())
+		return interval();
+	return interval::rounded(sqrt(x.lower()), sqrt(x.upper()));
+}
+
+const interval sin(const interval & x)
+{
+	if (!x.is_bounded())
+		return interval(*_num_1_p, *_num1_p);
+	const numeric halfpi = ex_to<numeric>(Pi.evalf())/2;
+	const numeric l = sin(x.lower()), h = sin(x.upper());
+	const numeric rl = contains_phase(x, -halfpi) ? *_num_1_p : round_down(std::min(l, h));
+	const numeric rh = contains_phase(x, halfpi) ? *_num1_p : round_up(std::max(l, h));
+	return interval(rl, rh);
+}
+
+const interval cos(const interval & x)
+{
+	if (!x.is_bounded())
+		return interval(*_num_1_p, *_num1_p);
+	const numeric pi = ex_to<numeric>(Pi.evalf());
+	const numeric l = cos(x.lower()), h = cos(x.upper());
+	const numeric rl = contains_phase(x, pi) ? *_num_1_p : round_down(std::min(l, h));
+	const numeric rh = contains_phase(x, *_num0_p) ? *_num1_p : round_up(std::max(l, h));
+	return interval(rl, rh);
+}
+
+const interval tan(const interval & x)
+{
+	if (!x.is_bounded())
+		return interval();
+	// Poles at Pi/2+k*Pi, i.e. at Pi/2+2*k*Pi and -Pi/2+2*k*Pi
+	const numeric halfpi = ex_to<numeric>(Pi.evalf())/2;
+	if (contains_phase(x, halfpi) || contains_phase(x, -halfpi))
+		return interval();
+	return interval::rounded(tan(x.lower()), tan(x.upper()));
+}
+
+const interval asin(const interval & x)
+{
+	if (interval(*_num_1_p, *_num1_p).contains(x))
+		return interval::rounded(asin(x.lower()), asin(x.upper()));
+	return interval();
+}
+
+const interval acos(const interval & x)
+{
+	if (interval(*_num_1_p, *_num1_p).contains(x))
+		return interval::rounded(acos(x.upper()), acos(x.lower()));
+	return interval();
+}
+
+const interval atan(const interval & x)
+{
+	if (!x.is_bounded()) {
+		const numeric halfpi = ex_to<numeric>(Pi.evalf())/2;
+		return interval::rounded(-halfpi, halfpi);
+	}
+	return interval::rounded(atan(x.lower()), atan(x.upper()));
+}
+
+const interval sinh(const interval & x)
+{
+	if (!x.is_bounded())
+		return interval();
+	return interval::rounded(sinh(x.lower()), sinh(x.upper()));
+}
+
+const interval cosh(const interval & x)
+{
+	if (!x.is_bounded())
+		return interval();
+	const numeric l = cosh(x.lower()), h = cosh(x.upper());
+	if (!x.lower().is_negative())
+		return interval::rounded(l, h);
+	if (!x.upper().is_positive())
+		return interval::rounded(h, l);
+	return interval::rounded(*_num1_p, std::max(l, h));
+}
+
+const interval tanh(const interval & x)
+{
+	if (!x.is_bounded())
+		return interval(*_num_1_p, *_num1_p);
+	return interval::rounded(tanh(x.lower()), tanh(x.upper()));
+}
+
+const interval asinh(const interval & x)
+{
+	if (!x.is_bounded())
+		return interval();
+	return interval::rounded(asinh(x.lower()), asinh(x.upper()));
+}
+
+const interval acosh(const interval & x)
+{
+	if (!x.is_bounded() || x.lower() < *_num1_p)
+		return interval();
+	return interval::rounded(acosh(x.lower()), acosh(x.upper()));
+}
+
+const interval atanh(const interval & x)
+{
+	if (!x.is_bounded() || x.lower() <= *_num_1_p || x.upper() >= *_num1_p)
+		return interval();
+	return interval::rounded(atanh(x.lower()), atanh(x.upper()));
+}
+
+const interval abs(const interval & x)
+{
+	if (!x.is_bounded())
+		return interval();
+	if (!x.lower().is_negative())
+		return x;
+	if (!x.upper().is_positive())
+		return -x;
+	return interval(*_num0_p, std::max(-x.lower(), x.upper()));
+}
+
+} // namespace GiNaC
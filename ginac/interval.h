@@ -0,0 +1,115 @@
+/** @file interval.h
+ *
+ *  Interface to real interval arithmetic. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef GINAC_INTERVAL_H
+#define GINAC_INTERVAL_H
+
+#include "numeric.h"
+
+#include <iosfwd>
+
+namespace GiNaC {
+
+/** Closed interval of real numbers, used for computing rigorous bounds of
+ *  numerical values.  The bounds are exact rationals or floating point
+ *  numbers at the current precision.  Floating point results are rounded
+ *  outwards, so the true range of an operation is always enclosed.  An
+ *  interval constructed without bounds stands for the whole real line; it
+ *  is the result of any operation whose range cannot be bounded, e.g. a
+ *  division by an interval containing zero. */
+class interval
+{
+public:
+	interval();
+	explicit interval(const numeric & x);
+	interval(const numeric & lo, const numeric & hi);
+
+	/** Interval enclosing [lo, hi], with floating point bounds rounded
+	 *  outwards to account for rounding errors in their computation. */
+	static interval rounded(const numeric & lo, const numeric & hi);
+
+	bool is_bounded() const { return bounded; }
+	const numeric & lower() const;
+	const numeric & upper() const;
+	numeric midpoint() const;
+	numeric width() const;
+	bool contains(const numeric & x) const;
+	bool contains(const interval & other) const;
+	bool is_positive() const;
+	bool is_negative() const;
+
+	interval intersect(const interval & other) const;
+	interval hull(const interval & other) const;
+
+	const interval operator-() const;
+	const interval add(const interval & other) const;
+	const interval sub(const interval & other) const;
+	const interval mul(const interval & other) const;
+	const interval div(const interval & other) const;
+	const interval power(const numeric & exponent) const;
+	const interval power(const interval & exponent) const;
+
+	void print(std::ostream & os) const;
+
+private:
+	numeric lo;
+	numeric hi;
+	bool bounded;
+};
+
+inline const interval operator+(const interval & lh, const interval & rh)
+{ return lh.add(rh); }
+
+inline const interval operator-(const interval & lh, const interval & rh)
+{ return lh.sub(rh); }
+
+inline const interval operator*(const interval & lh, const interval & rh)
+{ return lh.mul(rh); }
+
+inline const interval operator/(const interval & lh, const interval & rh)
+{ return lh.div(rh); }
+
+inline std::ostream & operator<<(std::ostream & os, const interval & i)
+{ i.print(os); return os; }
+
+// Interval extensions of elementary functions
+
+const interval exp(const interval & x);
+const interval log(const interval & x);
+const interval sqrt(const interval & x);
+const interval sin(const interval & x);
+const interval cos(const interval & x);
+const interval tan(const interval & x);
+const interval asin(const interval & x);
+const interval acos(const interval & x);
+const interval atan(const interval & x);
+const interval sinh(const interval & x);
+const interval cosh(const interval & x);
+const interval tanh(const interval & x);
+const interval asinh(const interval & x);
+const interval acosh(const interval & x);
+const interval atanh(const interval & x);
+const interval abs(const interval & x);
+
+} // namespace GiNaC
+
+#endif // ndef GINAC_INTERVAL_H
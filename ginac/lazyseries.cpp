@@ -0,0 +1,429 @@
+/** @file lazyseries.cpp
+ *
+ *  Implementation of power series whose coefficients are computed on
+ *  demand. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "lazyseries.h"
+#include "add.h"
+#include "inifcns.h"
+#include "mul.h"
+#include "numeric.h"
+#include "operators.h"
+#include "power.h"
+#include "pseries.h"
+#include "relational.h"
+#include "symbol.h"
+#include "utils.h"
+
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace GiNaC {
+
+/** Number of coefficients searched for the leading one before a series is
+ *  considered to vanish. */
+static const int max_valuation_search = 100;
+
+/** Coefficient of the n-th power. */
+ex lazy_series_node::coeff(int n)
+{
+	if (n < lo)
+		return _ex0;
+	while (int(cache.size()) <= n - lo)
+		cache.push_back(compute(lo + int(cache.size())));
+	return cache[n - lo];
+}
+
+/** Power of the leading term, i.e. of the first non-vanishing coefficient.
+ *
+ *  @exception runtime_error (no such coefficient found) */
+int lazy_series_node::valuation()
+{
+	for (int n=lo; n<lo+max_valuation_search; ++n) {
+		if (!coeff(n).expand().is_zero())
+			return n;
+	}
+	throw(std::runtime_error("lazy_series: cannot find the leading term of a series"));
+}
+
+/** Sum of the terms, built in one go instead of term by term. */
+static ex sum_of_terms(const exvector & terms)
+{
+	if (terms.empty())
+		return _ex0;
+	if (terms.size() == 1)
+		return terms[0];
+	return (new add(terms))->setflag(status_flags::dynallocated);
+}
+
+//////////
+// node types
+//////////
+
+/** Expression not depending on the expansion variable. */
+class lazy_constant_node : public lazy_series_node
+{
+public:
+	lazy_constant_node(const ex & c_) : c(c_) {}
+protected:
+	ex compute(int n) { return n == 0 ? c : _ex0; }
+private:
+	ex c;
+};
+
+/** The expansion variable x, i.e. point+(x-point). */
+class lazy_var_node : public lazy_series_node
+{
+public:
+	lazy_var_node(const ex & point_) : point(point_) {}
+protected:
+	ex compute(int n) { return n == 0 ? point : (n == 1 ? _ex1 : _ex0); }
+private:
+	ex point;
+};
+
+class lazy_add_node : public lazy_series_node
+{
+public:
+	lazy_add_node(const std::vector<ptr<lazy_series_node> > & ops_) : ops(ops_)
+	{
+		lo = ops[0]->lower_bound();
+		for (size_t i=1; i<ops.size(); ++i)
+			lo = std::min(lo, ops[i]->lower_bound());
+	}
+protected:
+	ex compute(int n)
+	{
+		exvector terms;
+		for (size_t i=0; i<ops.size(); ++i) {
+			const ex c = ops[i]->coeff(n);
+			if (!c.is_zero())
+				terms.push_back(c);
+		}
+		return sum_of_terms(terms);
+	}
+private:
+	std::vector<ptr<lazy_series_node> > ops;
+};
+
+/** Product of two series, by the Cauchy product formula. */
+class lazy_mul_node : public lazy_series_node
+{
+public:
+	lazy_mul_node(const ptr<lazy_series_node> & a_, const ptr<lazy_series_node> & b_) : a(a_), b(b_)
+	{
+		lo = a->lower_bound() + b->lower_bound();
+	}
+protected:
+	ex compute(int n)
+	{
+		exvector terms;
+		for (int i=a->lower_bound(); i<=n-b->lower_bound(); ++i) {
+			const ex ca = a->coeff(i);
+			if (ca.is_zero())
+				continue;
+			const ex cb = b->coeff(n - i);
+			if (!cb.is_zero())
+				terms.push_back(ca * cb);
+		}
+		return sum_of_terms(terms);
+	}
+private:
+	ptr<lazy_series_node> a;
+	ptr<lazy_series_node> b;
+};
+
+/** Numeric power of a series, by the recurrence of pseries::power_const(). */
+class lazy_power_node : public lazy_series_node
+{
+public:
+	lazy_power_node(const ptr<lazy_series_node> & base_, const numeric & p_) : base(base_), p(p_)
+	{
+		v = base->valuation();
+		if (!(p*v).is_integer())
+			throw(std::runtime_error("lazy_series: trying to assemble a Puiseux series"));
+		lo = (p*v).to_int();
+		lead = base->coeff(v);
+	}
+protected:
+	ex compute(int n)
+	{
+		const int k = n - lo;
+		if (k == 0)
+			return power(lead, p);
+		exvector terms;
+		for (int j=1; j<=k; ++j) {
+			const ex c = base->coeff(v + j);
+			if (!c.is_zero())
+				terms.push_back((p*j - (k-j)) * c * coeff(n - j));
+		}
+		return sum_of_terms(terms) / (k * lead);
+	}
+private:
+	ptr<lazy_series_node> base;
+	numeric p;
+	int v;    ///< valuation of base
+	ex lead;  ///< leading coefficient of base
+};
+
+/** exp(f) for a series f without poles, from g' = f'*g. */
+class lazy_exp_node : public lazy_series_node
+{
+public:
+	lazy_exp_node(const ptr<lazy_series_node> & f_) : f(f_) {}
+protected:
+	ex compute(int n)
+	{
+		if (n == 0)
+			return exp(f->coeff(0));
+		exvector terms;
+		for (int k=1; k<=n; ++k) {
+			const ex c = f->coeff(k);
+			if (!c.is_zero())
+				terms.push_back(k * c * coeff(n - k));
+		}
+		return sum_of_terms(terms) / n;
+	}
+private:
+	ptr<lazy_series_node> f;
+};
+
+/** log(f) for a series f starting with a constant, from f*g' = f'. */
+class lazy_log_node : public lazy_series_node
+{
+public:
+	lazy_log_node(const ptr<lazy_series_node> & f_) : f(f_) {}
+protected:
+	ex compute(int n)
+	{
+		if (n == 0)
+			return log(f->coeff(0));
+		exvector terms;
+		for (int k=1; k<n; ++k) {
+			const ex c = f->coeff(n - k);
+			if (!c.is_zero())
+				terms.push_back(k * coeff(k) * c);
+		}
+		return (f->coeff(n) - sum_of_terms(terms) / n) / f->coeff(0);
+	}
+private:
+	ptr<lazy_series_node> f;
+};
+
+/** sin(f) or cos(f) for a series f without poles.  Both are computed
+ *  together, from sin(f)' = f'*cos(f) and cos(f)' = -f'*sin(f). */
+class lazy_sincos_node : public lazy_series_node
+{
+public:
+	lazy_sincos_node(const ptr<lazy_series_node> & f_, bool cosine_) : f(f_), cosine(cosine_) {}
+protected:
+	ex compute(int n)
+	{
+		if (n == 0) {
+			s.push_back(sin(f->coeff(0)));
+			c.push_back(cos(f->coeff(0)));
+		} else {
+			exvector sterms, cterms;
+			for (int k=1; k<=n; ++k) {
+				const ex fk = f->coeff(k);
+				if (fk.is_zero())
+					continue;
+				sterms.push_back(k * fk * c[n - k]);
+				cterms.push_back(k * fk * s[n - k]);
+			}
+			s.push_back(sum_of_terms(sterms) / n);
+			c.push_back(-sum_of_terms(cterms) / n);
+		}
+		return cosine ? c[n] : s[n];
+	}
+private:
+	ptr<lazy_series_node> f;
+	bool cosine;
+	exvector s;
+	exvector c;
+};
+
+/** Any other expression, expanded by ex::series().  When a coefficient
+ *  beyond the current order is needed, the expansion is redone with the
+ *  order at least doubled. */
+class lazy_generic_node : public lazy_series_node
+{
+public:
+	lazy_generic_node(const ex & e_, const ex & r_) : e(e_), r(r_), order(0), known(0)
+	{
+		expand_to(4);
+		lo = ex_to<pseries>(s).ldegree(r.lhs());
+	}
+protected:
+	ex compute(int n)
+	{
+		if (n >= known)
+			expand_to(n + 1 + std::max(known - lo, 4));
+		return ex_to<pseries>(s).coeff(r.lhs(), n);
+	}
+private:
+	void expand_to(int min_order)
+	{
+		order = min_order;
+		for (int tries=0; tries<8; ++tries) {
+			s = e.series(r, order);
+			const pseries & ps = ex_to<pseries>(s);
+			known = ps.is_terminating() ? std::numeric_limits<int>::max() : ps.degree(r.lhs());
+			if (known >= min_order)
+				return;
+			order += order - known;
+		}
+		throw(std::runtime_error("lazy_series: series expansion does not reach the requested order"));
+	}
+
+	ex e;
+	ex r;
+	ex s;       ///< current expansion
+	int order;  ///< order requested for s
+	int known;  ///< power of the Order term of s
+};
+
+//////////
+// construction
+//////////
+
+typedef std::map<ex, ptr<lazy_series_node>, ex_is_less> lazy_node_map;
+
+static ptr<lazy_series_node> make_node(const ex & e, const ex & r, lazy_node_map & nodes);
+
+/** Create the node for e, with the nodes of its subexpressions shared
+ *  through nodes. */
+static ptr<lazy_series_node> new_node(const ex & e, const ex & r, lazy_node_map & nodes)
+{
+	const ex & x = r.lhs();
+	if (!e.has(x))
+		return ptr<lazy_series_node>(new lazy_constant_node(e));
+	if (e.is_equal(x))
+		return ptr<lazy_series_node>(new lazy_var_node(r.rhs()));
+
+	if (is_exactly_a<add>(e)) {
+		std::vector<ptr<lazy_series_node> > ops;
+		for (size_t i=0; i<e.nops(); ++i)
+			ops.push_back(make_node(e.op(i), r, nodes));
+		return ptr<lazy_series_node>(new lazy_add_node(ops));
+	}
+
+	if (is_exactly_a<mul>(e)) {
+		ptr<lazy_series_node> n = make_node(e.op(0), r, nodes);
+		for (size_t i=1; i<e.nops(); ++i)
+			n = ptr<lazy_series_node>(new lazy_mul_node(n, make_node(e.op(i), r, nodes)));
+		return n;
+	}
+
+	if (is_exactly_a<power>(e) && is_exactly_a<numeric>(e.op(1))) {
+		const numeric & p = ex_to<numeric>(e.op(1));
+		const ptr<lazy_series_node> base = make_node(e.op(0), r, nodes);
+		if (!p.is_pos_integer() || p > 16)
+			return ptr<lazy_series_node>(new lazy_power_node(base, p));
+
+		// Small positive integer powers by repeated squaring, which needs
+		// no leading term
+		int k = p.to_int();
+		ptr<lazy_series_node> n = base, sq = base;
+		bool first = true;
+		for (;;) {
+			if (k & 1) {
+				n = first ? sq : ptr<lazy_series_node>(new lazy_mul_node(n, sq));
+				first = false;
+			}
+			k >>= 1;
+			if (k == 0)
+				return n;
+			sq = ptr<lazy_series_node>(new lazy_mul_node(sq, sq));
+		}
+	}
+
+	if (is_ex_the_function(e, exp) || is_ex_the_function(e, sin) || is_ex_the_function(e, cos)) {
+		const ptr<lazy_series_node> f = make_node(e.op(0), r, nodes);
+		if (f->lower_bound() >= 0) {
+			if (is_ex_the_function(e, exp))
+				return ptr<lazy_series_node>(new lazy_exp_node(f));
+			return ptr<lazy_series_node>(new lazy_sincos_node(f, is_ex_the_function(e, cos)));
+		}
+	}
+
+	if (is_ex_the_function(e, log)) {
+		const ptr<lazy_series_node> f = make_node(e.op(0), r, nodes);
+		if (f->valuation() == 0)
+			return ptr<lazy_series_node>(new lazy_log_node(f));
+	}
+
+	return ptr<lazy_series_node>(new lazy_generic_node(e, r));
+}
+
+static ptr<lazy_series_node> make_node(const ex & e, const ex & r, lazy_node_map & nodes)
+{
+	lazy_node_map::const_iterator found = nodes.find(e);
+	if (found != nodes.end())
+		return found->second;
+	const ptr<lazy_series_node> n = new_node(e, r, nodes);
+	nodes.insert(std::make_pair(e, n));
+	return n;
+}
+
+/** Prepare the series expansion of an expression.  No coefficients are
+ *  computed yet, except for finding leading terms.
+ *
+ *  @param e expression to be expanded
+ *  @param r expansion relation, lhs holds variable and rhs holds point
+ *  @exception logic_error (r is not a relation with a symbol on its lhs) */
+lazy_series::lazy_series(const ex & e, const ex & r)
+  : root(new lazy_constant_node(_ex0))
+{
+	if (!is_a<relational>(r) || !is_a<symbol>(r.lhs()))
+		throw(std::logic_error("lazy_series::lazy_series(): expansion point has unknown type"));
+	var = r.lhs();
+	point = r.rhs();
+	lazy_node_map nodes;
+	root = make_node(e, r, nodes);
+}
+
+/** Coefficient of (var-point)^n, computed if not cached yet. */
+ex lazy_series::coeff(int n) const
+{
+	return root->coeff(n);
+}
+
+/** Truncated series up to (but excluding) (var-point)^order.  Unlike
+ *  ex::series(), the result always has an Order term, even if the series
+ *  terminates.
+ *
+ *  @return pseries object */
+ex lazy_series::series(int order) const
+{
+	epvector seq;
+	for (int n=root->lower_bound(); n<order; ++n) {
+		const ex c = root->coeff(n);
+		if (!c.is_zero())
+			seq.push_back(expair(c, numeric(n)));
+	}
+	seq.push_back(expair(Order(_ex1), numeric(order)));
+	return (new pseries(var == point, seq))->setflag(status_flags::dynallocated);
+}
+
+} // namespace GiNaC
@@ -0,0 +1,87 @@
+/** @file lazyseries.h
+ *
+ *  Interface to power series whose coefficients are computed on demand. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef GINAC_LAZYSERIES_H
+#define GINAC_LAZYSERIES_H
+
+#include "ex.h"
+#include "ptr.h"
+
+namespace GiNaC {
+
+/** Node in the expression tree of a lazy_series.  Each node stands for the
+ *  series of one subexpression, computes its coefficients on demand and
+ *  caches them. */
+class lazy_series_node : public refcounted
+{
+public:
+	lazy_series_node() : lo(0) {}
+	virtual ~lazy_series_node() {}
+
+	ex coeff(int n);
+	int valuation();
+
+	/** All coefficients of powers below this one vanish. */
+	int lower_bound() const { return lo; }
+
+protected:
+	/** Compute the coefficient of the n-th power.  It is called for
+	 *  n = lo, lo+1, ... in turn, so all coefficients of lower powers are
+	 *  cached already. */
+	virtual ex compute(int n) = 0;
+
+	int lo;
+
+private:
+	exvector cache; ///< coefficients of the powers lo, lo+1, ...
+};
+
+
+/** Power series of an expression whose coefficients are computed only when
+ *  they are needed, and cached.  Sums, products, powers and the functions
+ *  exp, log, sin and cos are expanded by recurrences on the coefficients,
+ *  so that increasing the order of the series costs only the computation
+ *  of the new coefficients.  Other subexpressions are expanded by
+ *  ex::series(), with the order doubled whenever more coefficients are
+ *  needed. */
+class lazy_series
+{
+public:
+	lazy_series(const ex & e, const ex & r);
+
+	ex coeff(int n) const;
+	ex series(int order) const;
+
+	/** Get the expansion variable. */
+	ex get_var() const { return var; }
+	/** Get the expansion point. */
+	ex get_point() const { return point; }
+
+private:
+	ex var;
+	ex point;
+	ptr<lazy_series_node> root;
+};
+
+} // namespace GiNaC
+
+#endif // ndef GINAC_LAZYSERIES_H
@@ -22,20 +22,25 @@
 
 #include "matrix.h"
 #include "numeric.h"
+#include "numeric_matrix.h"
+#include "sparse_matrix.h"
 #include "lst.h"
 #include "idx.h"
 #include "indexed.h"
 #include "add.h"
+#include "mul.h"
 #include "power.h"
 #include "symbol.h"
 #include "operators.h"
 #include "normal.h"
 #include "archive.h"
 #include "utils.h"
+#include "worker_processes.h"
 
 #include <algorithm>
 #include <iostream>
 #include <map>
+#include <set>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -587,25 +592,127 @@ matrix matrix::sub(const matrix & other) const
 }
 
 
+/** Rows of a matrix computed by worker processes, e.g. the row updates of
+ *  an elimination step.  compute() computes a row or a block of rows in
+ *  place and returns its new entries, store() enters the entries a worker
+ *  has computed. */
+class row_update_jobs : public worker_jobs
+{
+public:
+	virtual void store(size_t i, const exvector & entries) = 0;
+};
+
+/** Compute rows, e.g. the row updates of an elimination step, as many of
+ *  them as possible in worker processes.  The results of the workers are
+ *  matched with the symbols of the matrix by name, so if two different
+ *  symbols share a name all rows are computed here.
+ *
+ *  @param jobs  the rows
+ *  @param count  number of jobs
+ *  @param processes  number of worker processes, 0 means one per processor
+ *  @param entries  all entries the jobs read */
+static void update_rows(row_update_jobs & jobs, size_t count, unsigned processes, const exvector & entries)
+{
+	std::vector<bool> done(count, false);
+	if (count > 1) {
+		lst sym_lst;
+		if (collect_worker_symbols(entries, sym_lst)) {
+			std::vector<exvector> results;
+			compute_in_processes(jobs, count, processes, sym_lst, results, done);
+			for (size_t i=0; i<count; ++i)
+				if (done[i])
+					jobs.store(i, results[i]);
+		}
+	}
+	for (size_t i=0; i<count; ++i)
+		if (!done[i])
+			jobs.compute(i);
+}
+
+/** Rows r_begin to r_end-1 of the product of a and b, stored in prod.  Each
+ *  entry is built as one add of all its terms, since adding them one by one
+ *  would re-canonicalize the growing sum each time. */
+static void multiply_rows(const exvector & a, const exvector & b, unsigned ac, unsigned bc,
+                          unsigned r_begin, unsigned r_end, exvector & prod)
+{
+	std::vector<unsigned> nonzero;
+	exvector terms;
+	for (unsigned r1=r_begin; r1<r_end; ++r1) {
+		// Quick test: can we shortcut?
+		nonzero.clear();
+		for (unsigned c=0; c<ac; ++c)
+			if (!a[r1*ac+c].is_zero())
+				nonzero.push_back(c);
+		for (unsigned r2=0; r2<bc; ++r2) {
+			terms.clear();
+			for (std::vector<unsigned>::const_iterator c=nonzero.begin(); c!=nonzero.end(); ++c)
+				if (!b[*c*bc+r2].is_zero())
+					terms.push_back(a[r1*ac+*c] * b[*c*bc+r2]);
+			if (terms.size() == 1)
+				prod[r1*bc+r2] = terms[0];
+			else if (!terms.empty())
+				prod[r1*bc+r2] = (new GiNaC::add(terms))->setflag(status_flags::dynallocated);
+		}
+	}
+}
+
+/** Blocks of rows of a matrix product. */
+class product_row_jobs : public row_update_jobs
+{
+public:
+	product_row_jobs(const exvector & a_, const exvector & b_, unsigned ar_, unsigned ac_, unsigned bc_,
+	                 unsigned blocks_, exvector & prod_)
+	 : a(a_), b(b_), ar(ar_), ac(ac_), bc(bc_), blocks(blocks_), prod(prod_) {}
+	exvector compute(size_t i)
+	{
+		multiply_rows(a, b, ac, bc, first(i), first(i+1), prod);
+		return exvector(prod.begin()+first(i)*bc, prod.begin()+first(i+1)*bc);
+	}
+	void store(size_t i, const exvector & entries)
+	{
+		GINAC_ASSERT(entries.size()==(first(i+1)-first(i))*bc);
+		std::copy(entries.begin(), entries.end(), prod.begin()+first(i)*bc);
+	}
+private:
+	unsigned first(size_t i) const { return ar*i/blocks; }
+
+	const exvector & a, & b;
+	unsigned ar, ac, bc, blocks;
+	exvector & prod;
+};
+
 /** Product of matrices.
  *
+ *  @param processes number of worker processes that compute blocks of rows
+ *  of the product of symbolic matrices concurrently, 0 means one per
+ *  processor (see solve_algo::parallel for the limitations).  The result
+ *  does not depend on it.
  *  @exception logic_error (incompatible matrices) */
-matrix matrix::mul(const matrix & other) const
+matrix matrix::mul(const matrix & other, unsigned processes) const
 {
 	if (this->cols() != other.rows())
 		throw std::logic_error("matrix::mul(): incompatible matrices");
 	
-	exvector prod(this->rows()*other.cols());
+	// Purely numeric matrices are multiplied without any ex temporaries.
+	if (numeric_matrix::is_numeric(m) && numeric_matrix::is_numeric(other.m)) {
+		const numeric_matrix prod = numeric_matrix(row, col, m).mul(numeric_matrix(other.row, other.col, other.m));
+		return matrix(row, other.col, prod.to_exvector());
+	}
 	
-	for (unsigned r1=0; r1<this->rows(); ++r1) {
-		for (unsigned c=0; c<this->cols(); ++c) {
-			// Quick test: can we shortcut?
-			if (m[r1*col+c].is_zero())
-				continue;
-			for (unsigned r2=0; r2<other.cols(); ++r2)
-				prod[r1*other.col+r2] += (m[r1*col+c] * other.m[c*other.col+r2]);
-		}
+	exvector prod(this->rows()*other.cols());
+	if (processes == 1 || row < 2) {
+		multiply_rows(m, other.m, col, other.col, 0, row, prod);
+		return matrix(row, other.col, prod);
 	}
+
+	// Several blocks per worker even out the differing costs of the rows
+	if (processes == 0)
+		processes = processor_count();
+	const unsigned blocks = std::min(row, 4*processes);
+	product_row_jobs jobs(m, other.m, row, col, other.col, blocks, prod);
+	exvector entries(m);
+	entries.insert(entries.end(), other.m.begin(), other.m.end());
+	update_rows(jobs, blocks, processes, entries);
 	return matrix(row, other.col, prod);
 }
 
@@ -657,6 +764,24 @@ matrix matrix::pow(const ex & expn) const
 			} else {
 				A = *this;
 			}
+			if (numeric_matrix::is_numeric(A.m) && !b.is_zero()) {
+				// square and multiply without converting the intermediate
+				// powers back to expressions
+				numeric_matrix P(row, col, A.m);
+				numeric_matrix R(row, col);
+				bool first = true;
+				for (;;) {
+					if (b.is_odd()) {
+						R = first ? P : R.mul(P);
+						first = false;
+					}
+					b = iquo(b, *_num2_p);
+					if (b.is_zero())
+						break;
+					P = P.mul(P);
+				}
+				return matrix(row, col, R.to_exvector());
+			}
 			matrix C(row,col);
 			for (unsigned r=0; r<row; ++r)
 				C(r,r) = _ex1;
@@ -724,6 +849,220 @@ matrix matrix::transpose() const
 	return matrix(this->cols(),this->rows(),trans);
 }
 
+/** Check whether all the entries are polynomials with rational coefficients
+ *  in one and the same symbol, and set x to that symbol. */
+static bool is_univariate_polynomial(const exvector & m, ex & x)
+{
+	bool found = false;
+	for (exvector::const_iterator e=m.begin(); e!=m.end(); ++e) {
+		if (!e->info(info_flags::rational_polynomial))
+			return false;
+		for (const_preorder_iterator i=e->preorder_begin(); i!=e->preorder_end(); ++i) {
+			if (!is_a<symbol>(*i))
+				continue;
+			if (!found) {
+				x = *i;
+				found = true;
+			} else if (!i->is_equal(x))
+				return false;
+		}
+	}
+	return found;
+}
+
+typedef std::vector<cln::cl_RA> rational_poly;
+
+/** Coefficients of the univariate polynomials m in x, lowest degree first. */
+static std::vector<rational_poly> coefficient_lists(const exvector & m, const ex & x)
+{
+	std::vector<rational_poly> coeffs(m.size());
+	for (unsigned i=0; i<m.size(); ++i) {
+		const ex e = m[i].expand();
+		const int deg = e.degree(x);
+		for (int k=0; k<=deg; ++k)
+			coeffs[i].push_back(cln::the<cln::cl_RA>(ex_to<numeric>(e.coeff(x,k)).to_cl_N()));
+	}
+	return coeffs;
+}
+
+static cln::cl_RA evaluate(const rational_poly & p, const cln::cl_I & t)
+{
+	cln::cl_RA v = 0;
+	for (rational_poly::const_reverse_iterator c=p.rbegin(); c!=p.rend(); ++c)
+		v = v*t + *c;
+	return v;
+}
+
+static unsigned degree(const rational_poly & p)
+{
+	return p.empty() ? 0 : p.size()-1;
+}
+
+/** The points 0, 1, -1, 2, -2, ... for evaluation and interpolation. */
+static cln::cl_I interpolation_point(unsigned k)
+{
+	return (k & 1) ? cln::cl_I((k+1)/2) : -cln::cl_I(k/2);
+}
+
+/** Polynomial of degree below the number of points, taking the values vals
+ *  at the points pts (Newton interpolation). */
+static rational_poly interpolate(const std::vector<cln::cl_I> & pts, rational_poly vals)
+{
+	const unsigned n = pts.size();
+	for (unsigned j=1; j<n; ++j)
+		for (unsigned i=n-1; i>=j; --i)
+			vals[i] = (vals[i] - vals[i-1]) / (pts[i] - pts[i-j]);
+
+	// multiply out the Newton form by Horner's scheme
+	rational_poly p(1, vals[n-1]);
+	for (int i=n-2; i>=0; --i) {
+		p.push_back(0);
+		for (unsigned k=p.size()-1; k>0; --k)
+			p[k] = p[k-1] - pts[i]*p[k];
+		p[0] = vals[i] - pts[i]*p[0];
+	}
+	return p;
+}
+
+static ex from_coefficients(const rational_poly & p, const ex & x)
+{
+	ex e;
+	for (unsigned k=0; k<p.size(); ++k)
+		e += numeric(p[k]) * pow(x, k);
+	return e;
+}
+
+/** Evaluate a matrix of coefficient lists at t. */
+static numeric_matrix evaluate(unsigned r, unsigned c, const std::vector<rational_poly> & m, const cln::cl_I & t)
+{
+	numeric_matrix mt(r, c);
+	for (unsigned i=0; i<r; ++i)
+		for (unsigned j=0; j<c; ++j)
+			mt(i,j) = evaluate(m[i*c+j], t);
+	return mt;
+}
+
+/** Degree bound for the determinant of the n x n matrix of univariate
+ *  polynomials m (whose rows are stride apart): the smaller of the sums of
+ *  the maximal degrees in the rows and in the columns. */
+static unsigned determinant_degree_bound(unsigned n, const std::vector<rational_poly> & m, unsigned stride)
+{
+	unsigned rowsum = 0, colsum = 0;
+	for (unsigned r=0; r<n; ++r) {
+		unsigned d = 0;
+		for (unsigned c=0; c<n; ++c)
+			d = std::max(d, degree(m[r*stride+c]));
+		rowsum += d;
+	}
+	for (unsigned c=0; c<n; ++c) {
+		unsigned d = 0;
+		for (unsigned r=0; r<n; ++r)
+			d = std::max(d, degree(m[r*stride+c]));
+		colsum += d;
+	}
+	return std::min(rowsum, colsum);
+}
+
+/** Determinant of a matrix of univariate polynomials with rational
+ *  coefficients.  It is evaluated at sufficiently many integer points, where
+ *  the numeric determinants are computed by multimodular arithmetic, and
+ *  recovered by interpolation.
+ *
+ *  @return coefficients of the determinant */
+static rational_poly determinant_interpolation(unsigned n, const std::vector<rational_poly> & m)
+{
+	const unsigned deg = determinant_degree_bound(n, m, n);
+	std::vector<cln::cl_I> pts;
+	rational_poly vals;
+	for (unsigned k=0; k<=deg; ++k) {
+		pts.push_back(interpolation_point(k));
+		vals.push_back(cln::the<cln::cl_RA>(evaluate(n, n, m, pts.back()).determinant()));
+	}
+	return interpolate(pts, vals);
+}
+
+/** Solve a square linear system of univariate polynomials with rational
+ *  coefficients by evaluation and interpolation.  With D the determinant of
+ *  the coefficients, the D*x are polynomials (by Cramer's rule), whose
+ *  values are found by solving numeric systems at points where D does not
+ *  vanish.
+ *
+ *  @param aug augmented n x (n+p) matrix of the system
+ *  @param sol is set to the n x p solution matrix, stored by rows
+ *  @return false if the system is singular */
+static bool solve_interpolation(unsigned n, unsigned p, const exvector & aug, const ex & x, exvector & sol)
+{
+	const std::vector<rational_poly> m = coefficient_lists(aug, x);
+	std::vector<rational_poly> coeff;
+	for (unsigned r=0; r<n; ++r)
+		coeff.insert(coeff.end(), m.begin()+r*(n+p), m.begin()+r*(n+p)+n);
+	const rational_poly det = determinant_interpolation(n, coeff);
+	bool singular = true;
+	for (rational_poly::const_iterator c=det.begin(); c!=det.end(); ++c)
+		if (!cln::zerop(*c))
+			singular = false;
+	if (singular)
+		return false;
+
+	// Cramer's rule: D*x are determinants with one column replaced by a
+	// right hand side
+	unsigned rhsdeg = 0;
+	for (unsigned r=0; r<n; ++r)
+		for (unsigned c=n; c<n+p; ++c)
+			rhsdeg = std::max(rhsdeg, degree(m[r*(n+p)+c]));
+	unsigned deg = 0;
+	for (unsigned c=0; c<n; ++c) {
+		unsigned d = rhsdeg;
+		for (unsigned r=0; r<n; ++r)
+			d = std::max(d, degree(m[r*(n+p)+c]));
+		deg += d;
+	}
+
+	std::vector<cln::cl_I> pts;
+	std::vector<rational_poly> vals(n*p);
+	for (unsigned k=0; pts.size()<=deg; ++k) {
+		const cln::cl_I t = interpolation_point(k);
+		const cln::cl_RA dt = evaluate(det, t);
+		if (cln::zerop(dt))
+			continue;
+		exvector xt;
+		evaluate(n, n+p, m, t).solve(n, xt);
+		pts.push_back(t);
+		for (unsigned i=0; i<n*p; ++i)
+			vals[i].push_back(dt * cln::the<cln::cl_RA>(ex_to<numeric>(xt[i]).to_cl_N()));
+	}
+
+	const ex d = from_coefficients(det, x);
+	sol.clear();
+	for (unsigned i=0; i<n*p; ++i)
+		sol.push_back((from_coefficients(interpolate(pts, vals[i]), x) / d).normal());
+	return true;
+}
+
+
+/** Determinants of the diagonal blocks of a matrix, which are stored as
+ *  factors after the sign of the row permutation.  The blocks themselves
+ *  are computed with the automatic choice of the algorithm. */
+class block_determinant_jobs : public row_update_jobs
+{
+public:
+	block_determinant_jobs(const std::vector<matrix> & blocks_, exvector & factors_)
+	 : blocks(blocks_), factors(factors_) {}
+	exvector compute(size_t i)
+	{
+		factors[i+1] = blocks[i].determinant();
+		return exvector(1, factors[i+1]);
+	}
+	void store(size_t i, const exvector & entries)
+	{
+		GINAC_ASSERT(entries.size()==1);
+		factors[i+1] = entries[0];
+	}
+private:
+	const std::vector<matrix> & blocks;
+	exvector & factors;
+};
+
 /** Determinant of square matrix.  This routine doesn't actually calculate the
  *  determinant, it only implements some heuristics about which algorithm to
  *  run.  If all the elements of the matrix are elements of an integral domain
@@ -763,7 +1102,8 @@ ex matrix::determinant(unsigned algo) const
 	}
 	
 	// Here is the heuristics in case this routine has to decide:
-	if (algo == determinant_algo::automatic) {
+	const bool automatic = algo == determinant_algo::automatic;
+	if (automatic) {
 		// Minor expansion is generally a good guess:
 		algo = determinant_algo::laplace;
 		// Does anybody know when a matrix is really sparse?
@@ -774,6 +1114,11 @@ ex matrix::determinant(unsigned algo) const
 		// This overrides any prior decisions.
 		if (numeric_flag)
 			algo = determinant_algo::gauss;
+		// Univariate polynomials suffer from coefficient growth in any
+		// elimination scheme, whereas their values are cheap to compute.
+		ex x;
+		if (row>3 && !numeric_flag && is_univariate_polynomial(m, x))
+			algo = determinant_algo::modular;
 	}
 	
 	// Trap the trivial case here, since some algorithms don't like it
@@ -785,9 +1130,50 @@ ex matrix::determinant(unsigned algo) const
 			return m[0].expand();
 	}
 
+	// Symbolic matrices that decouple are split into their blocks, whose
+	// determinants are multiplied.  Without a zero free diagonal in any
+	// permutation of the rows, every term of the determinant vanishes.
+	// The blocks are independent, so the parallel algorithm hands them to
+	// worker processes.
+	const bool parallel = algo == determinant_algo::parallel;
+	if ((automatic || parallel) && !numeric_flag && row>3) {
+		std::vector<unsigned> rows;
+		std::vector<std::vector<unsigned> > blocks;
+		if (!sparse_matrix(*this).block_triangular(rows, blocks))
+			return _ex0;
+		if (blocks.size()>1) {
+			std::vector<matrix> block_matrices;
+			block_matrices.reserve(blocks.size());
+			for (std::vector<std::vector<unsigned> >::const_iterator b=blocks.begin(); b!=blocks.end(); ++b) {
+				const unsigned k = b->size();
+				matrix block(k, k);
+				for (unsigned i=0; i<k; ++i)
+					for (unsigned j=0; j<k; ++j)
+						block.m[i*k+j] = m[rows[(*b)[i]]*col+(*b)[j]];
+				block_matrices.push_back(block);
+			}
+			exvector factors(blocks.size()+1);
+			std::vector<unsigned> perm(rows);
+			factors[0] = permutation_sign(perm.begin(), perm.end());
+			block_determinant_jobs jobs(block_matrices, factors);
+			if (parallel)
+				update_rows(jobs, blocks.size(), 0, m);
+			else
+				for (size_t i=0; i<blocks.size(); ++i)
+					jobs.compute(i);
+			const ex det = (new GiNaC::mul(factors))->setflag(status_flags::dynallocated);
+			if (normal_flag)
+				return det.normal();
+			else
+				return det.expand();
+		}
+	}
+
 	// Compute the determinant
 	switch(algo) {
 		case determinant_algo::gauss: {
+			if (numeric_flag)
+				return numeric(numeric_matrix(row, col, m).determinant());
 			ex det = 1;
 			matrix tmp(*this);
 			int sign = tmp.gauss_elimination(true);
@@ -798,10 +1184,22 @@ ex matrix::determinant(unsigned algo) const
 			else
 				return (sign*det).normal().expand();
 		}
-		case determinant_algo::bareiss: {
+		case determinant_algo::modular: {
+			if (numeric_flag)
+				return numeric(numeric_matrix(row, col, m).determinant());
+			ex x;
+			if (is_univariate_polynomial(m, x))
+				return from_coefficients(determinant_interpolation(row, coefficient_lists(m, x)), x);
+			// otherwise use Bareiss elimination
+		}
+		// fall through
+		case determinant_algo::bareiss:
+		case determinant_algo::parallel: {
+			if (numeric_flag && algo==determinant_algo::parallel)
+				return numeric(numeric_matrix(row, col, m).determinant(0));
 			matrix tmp(*this);
 			int sign;
-			sign = tmp.fraction_free_elimination(true);
+			sign = tmp.fraction_free_elimination(true, algo==determinant_algo::parallel ? 0 : 1);
 			if (normal_flag)
 				return (sign*tmp.m[row*col-1]).normal();
 			else
@@ -887,6 +1285,69 @@ ex matrix::trace() const
 }
 
 
+/** Coefficients of det(lambda*1 - M) by Berkowitz' algorithm, highest degree
+ *  first.  The characteristic polynomial of each leading r x r submatrix
+ *  follows from the one of its (r-1) x (r-1) predecessor A by multiplication
+ *  with the Toeplitz matrix of the numbers 1, -a, -R*S, -R*A*S, -R*A^2*S,...,
+ *  where a, R and S are the new diagonal entry, row and column.  There are no
+ *  divisions, so this works over any commutative ring and costs O(n^4) ring
+ *  operations.
+ *
+ *  @param m entries of a square matrix, stored by rows
+ *  @param n its dimension
+ *  @param normal_flag whether the entries have to be normalized rather than
+ *  expanded */
+static exvector berkowitz(const exvector & m, unsigned n, bool normal_flag)
+{
+	exvector vect(2);
+	vect[0] = _ex1;
+	vect[1] = -m[0];
+	for (unsigned r=1; r<n; ++r) {
+		// the numbers c[k] in the Toeplitz matrix
+		exvector c(r+2);
+		c[0] = _ex1;
+		c[1] = -m[r*n+r];
+		exvector v(r);
+		for (unsigned i=0; i<r; ++i)
+			v[i] = m[i*n+r];
+		for (unsigned k=2; k<=r+1; ++k) {
+			exvector terms;
+			terms.reserve(r);
+			for (unsigned j=0; j<r; ++j)
+				if (!m[r*n+j].is_zero() && !v[j].is_zero())
+					terms.push_back(m[r*n+j]*v[j]);
+			const ex sum = -(new GiNaC::add(terms))->setflag(status_flags::dynallocated);
+			c[k] = normal_flag ? sum.normal() : sum.expand();
+			if (k==r+1)
+				break;
+			exvector w(r);
+			for (unsigned i=0; i<r; ++i) {
+				exvector wterms;
+				wterms.reserve(r);
+				for (unsigned j=0; j<r; ++j)
+					if (!m[i*n+j].is_zero() && !v[j].is_zero())
+						wterms.push_back(m[i*n+j]*v[j]);
+				const ex wi = (new GiNaC::add(wterms))->setflag(status_flags::dynallocated);
+				w[i] = normal_flag ? wi.normal() : wi.expand();
+			}
+			v.swap(w);
+		}
+
+		exvector next(r+2);
+		for (unsigned i=0; i<=r+1; ++i) {
+			exvector terms;
+			for (unsigned j=0; j<=r && j<=i; ++j)
+				if (!c[i-j].is_zero() && !vect[j].is_zero())
+					terms.push_back(c[i-j]*vect[j]);
+			const ex sum = (new GiNaC::add(terms))->setflag(status_flags::dynallocated);
+			next[i] = normal_flag ? sum.normal() : sum.expand();
+		}
+		vect.swap(next);
+	}
+	return vect;
+}
+
+
 /** Characteristic Polynomial.  Following mathematica notation the
  *  characteristic polynomial of a matrix M is defined as the determiant of
  *  (M - lambda * 1) where 1 stands for the unit matrix of the same dimension
@@ -895,6 +1356,11 @@ ex matrix::trace() const
  *  returns the characteristic polynomial collected in powers of lambda as a
  *  new expression.
  *
+ *  Purely numeric matrices are reduced to upper Hessenberg form first, other
+ *  dense matrices use Berkowitz' division free algorithm.  Both go as row^3
+ *  or row^4, respectively.  Small or sparse symbolic matrices are expanded as
+ *  determinant of (M - lambda * 1) like in matrix::determinant().
+ *
  *  @return    characteristic polynomial as new expression
  *  @exception logic_error (matrix not square)
  *  @see       matrix::determinant() */
@@ -903,29 +1369,52 @@ ex matrix::charpoly(const ex & lambda) const
 	if (row != col)
 		throw (std::logic_error("matrix::charpoly(): matrix not square"));
 	
+	// Gather the same statistical information as matrix::determinant():
 	bool numeric_flag = true;
+	bool normal_flag = false;
+	bool lambda_flag = false;
+	unsigned sparse_count = 0;  // counts non-zero elements
 	exvector::const_iterator r = m.begin(), rend = m.end();
-	while (r!=rend && numeric_flag==true) {
+	while (r != rend) {
 		if (!r->info(info_flags::numeric))
 			numeric_flag = false;
+		if (r->has(lambda))
+			lambda_flag = true;
+		exmap srl;  // symbol replacement list
+		ex rtest = r->to_rational(srl);
+		if (!rtest.is_zero())
+			++sparse_count;
+		if (!rtest.info(info_flags::crational_polynomial) &&
+			 rtest.info(info_flags::rational_function))
+			normal_flag = true;
 		++r;
 	}
 	
 	// The pure numeric case is traditionally rather common.  Hence, it is
-	// trapped and we use Leverrier's algorithm which goes as row^3 for
-	// every coefficient.  The expensive part is the matrix multiplication.
+	// trapped and we use a Hessenberg reduction on the numbers.
 	if (numeric_flag) {
 
-		matrix B(*this);
-		ex c = B.trace();
-		ex poly = power(lambda, row) - c*power(lambda, row-1);
-		for (unsigned i=1; i<row; ++i) {
-			for (unsigned j=0; j<row; ++j)
-				B.m[j*col+j] -= c;
-			B = this->mul(B);
-			c = B.trace() / ex(i+1);
-			poly -= c*power(lambda, row-i-1);
-		}
+		const std::vector<cln::cl_N> coeffs = numeric_matrix(row, col, m).charpoly();
+		exvector terms;
+		terms.reserve(row+1);
+		for (unsigned k=0; k<=row; ++k)
+			if (!cln::zerop(coeffs[k]))
+				terms.push_back(numeric(coeffs[k])*power(lambda, k));
+		const ex poly = (new GiNaC::add(terms))->setflag(status_flags::dynallocated);
+		if (row%2)
+			return -poly;
+		else
+			return poly;
+
+	} else if (!lambda_flag && row>3 && 5*sparse_count>row*col) {
+
+		const exvector coeffs = berkowitz(m, row, normal_flag);
+		exvector terms;
+		terms.reserve(row+1);
+		for (unsigned k=0; k<=row; ++k)
+			if (!coeffs[k].is_zero())
+				terms.push_back(coeffs[k]*power(lambda, row-k));
+		const ex poly = (new GiNaC::add(terms))->setflag(status_flags::dynallocated);
 		if (row%2)
 			return -poly;
 		else
@@ -955,6 +1444,21 @@ matrix matrix::inverse() const
 	// This routine actually doesn't do anything fancy at all.  We compute the
 	// inverse of the matrix A by solving the system A * A^{-1} == Id.
 	
+	// Purely numeric matrices are inverted without any symbols by
+	// eliminating (*this|Id).
+	if (numeric_matrix::is_numeric(m)) {
+		numeric_matrix aug(row, 2*col);
+		for (unsigned r=0; r<row; ++r) {
+			for (unsigned c=0; c<col; ++c)
+				aug(r,c) = ex_to<numeric>(m[r*col+c]).to_cl_N();
+			aug(r,col+r) = 1;
+		}
+		exvector sol;
+		if (!aug.solve(col, sol))
+			throw (std::runtime_error("matrix::inverse(): singular matrix"));
+		return matrix(row, col, sol);
+	}
+
 	// First populate the identity matrix supposed to become the right hand side.
 	matrix identity(row,col);
 	for (unsigned i=0; i<row; ++i)
@@ -1008,6 +1512,9 @@ matrix matrix::solve(const matrix & vars,
 			if (!vars(ro,co).info(info_flags::symbol))
 				throw (std::invalid_argument("matrix::solve(): 1st argument must be matrix of symbols"));
 	
+	if (algo == solve_algo::sparse)
+		return sparse_matrix(*this).solve(vars, rhs);
+	
 	// build the augmented matrix of *this with rhs attached to the right
 	matrix aug(m,n+p);
 	for (unsigned r=0; r<m; ++r) {
@@ -1037,12 +1544,44 @@ matrix matrix::solve(const matrix & vars,
 		// This overrides any prior decisions.
 		if (numeric_flag)
 			algo = solve_algo::gauss;
+		// Larger systems of univariate polynomials are better solved from
+		// their values.
+		ex x;
+		if (m>3 && m==n && !numeric_flag && is_univariate_polynomial(aug.m, x))
+			algo = solve_algo::modular;
+	}
+	
+	if (algo == solve_algo::modular) {
+		ex x;
+		matrix sol(n,p);
+		if (numeric_flag)
+			algo = solve_algo::gauss;
+		else if (m==n && is_univariate_polynomial(aug.m, x) &&
+		         solve_interpolation(n, p, aug.m, x, sol.m))
+			return sol;
+		else
+			algo = solve_algo::bareiss;
 	}
 	
 	// Eliminate the augmented matrix:
 	switch(algo) {
 		case solve_algo::gauss:
-			aug.gauss_elimination();
+		case solve_algo::parallel:
+			if (numeric_flag) {
+				numeric_matrix naug(m, n+p, aug.m);
+				exvector nsol;
+				if (naug.solve(n, nsol, algo==solve_algo::parallel ? 0 : 1))
+					return matrix(n, p, nsol);
+				int sign;
+				cln::cl_I scale;
+				naug.eliminate(n, sign, scale);
+				aug = matrix(m, n+p, naug.to_exvector());
+				break;
+			}
+			if (algo==solve_algo::parallel)
+				aug.fraction_free_elimination(false, 0);
+			else
+				aug.gauss_elimination();
 			break;
 		case solve_algo::divfree:
 			aug.division_free_elimination();
@@ -1096,6 +1635,9 @@ unsigned matrix::rank() const
 
 	GINAC_ASSERT(row*col==m.capacity());
 
+	if (numeric_matrix::is_numeric(m))
+		return numeric_matrix(row, col, m).rank();
+
 	// Actually, any elimination scheme will do since we are only
 	// interested in the echelon matrix' zeros.
 	matrix to_eliminate = *this;
@@ -1233,6 +1775,100 @@ ex matrix::determinant_minor() const
 }
 
 
+/** One row update of Gauss elimination: subtract the multiple of the pivot
+ *  row r0 from row r2 that cancels the entry in column c0.  The update only
+ *  reads the pivot row and writes row r2, so the rows below the pivot are
+ *  independent of each other.  The multiplier is normalized once for the
+ *  row and zeros in the pivot row leave the corresponding entries alone.
+ *
+ *  @see matrix::gauss_elimination */
+static void gauss_row_update(exvector & m, unsigned n, unsigned r0, unsigned c0, unsigned r2)
+{
+	ex piv = m[r2*n+c0] / m[r0*n+c0];
+	if (!piv.info(info_flags::numeric))
+		piv = piv.normal();
+	for (unsigned c=c0+1; c<n; ++c) {
+		if (m[r0*n+c].is_zero())
+			continue;
+		m[r2*n+c] -= piv * m[r0*n+c];
+		if (!m[r2*n+c].info(info_flags::numeric))
+			m[r2*n+c] = m[r2*n+c].normal();
+	}
+}
+
+/** One row update of fraction free elimination on the numerators tmp_n and
+ *  denominators tmp_d of the entries, see matrix::fraction_free_elimination.
+ *  The products of the pivot with the entry in column c0 of row r2 are the
+ *  same for the whole row, so they are expanded only once.  Like in Gauss
+ *  elimination, only the pivot row is read and only row r2 is written. */
+static void fraction_free_row_update(exvector & tmp_n, exvector & tmp_d, unsigned n,
+                                     unsigned r0, unsigned c0, unsigned r2,
+                                     const ex & divisor_n, const ex & divisor_d)
+{
+	const ex piv_n = (tmp_n[r0*n+c0]*tmp_d[r2*n+c0]).expand();
+	const ex lead_n = (tmp_n[r2*n+c0]*tmp_d[r0*n+c0]).expand();
+	const ex lead_d = (tmp_d[r2*n+c0]*tmp_d[r0*n+c0]).expand();
+	for (unsigned c=c0+1; c<n; ++c) {
+		const ex dividend_n = (piv_n*tmp_n[r2*n+c]*tmp_d[r0*n+c]
+		                      -lead_n*tmp_n[r0*n+c]*tmp_d[r2*n+c]).expand();
+		const ex dividend_d = (lead_d*tmp_d[r0*n+c]*tmp_d[r2*n+c]).expand();
+		bool check = divide(dividend_n, divisor_n, tmp_n[r2*n+c], true);
+		check &= divide(dividend_d, divisor_d, tmp_d[r2*n+c], true);
+		GINAC_ASSERT(check);
+	}
+}
+
+/** Row updates of one step of Gauss elimination. */
+class gauss_row_jobs : public row_update_jobs
+{
+public:
+	gauss_row_jobs(exvector & m_, unsigned n_, unsigned r0_, unsigned c0_, const std::vector<unsigned> & rows_)
+	 : m(m_), n(n_), r0(r0_), c0(c0_), rows(rows_) {}
+	exvector compute(size_t i)
+	{
+		gauss_row_update(m, n, r0, c0, rows[i]);
+		return exvector(m.begin()+rows[i]*n+c0+1, m.begin()+(rows[i]+1)*n);
+	}
+	void store(size_t i, const exvector & entries)
+	{
+		std::copy(entries.begin(), entries.end(), m.begin()+rows[i]*n+c0+1);
+	}
+private:
+	exvector & m;
+	unsigned n, r0, c0;
+	const std::vector<unsigned> & rows;
+};
+
+/** Row updates of one step of fraction free elimination, the new numerators
+ *  of a row are followed by its new denominators. */
+class fraction_free_row_jobs : public row_update_jobs
+{
+public:
+	fraction_free_row_jobs(exvector & tmp_n_, exvector & tmp_d_, unsigned n_, unsigned r0_, unsigned c0_,
+	                       const ex & divisor_n_, const ex & divisor_d_)
+	 : tmp_n(tmp_n_), tmp_d(tmp_d_), n(n_), r0(r0_), c0(c0_), divisor_n(divisor_n_), divisor_d(divisor_d_) {}
+	exvector compute(size_t i)
+	{
+		const unsigned r2 = r0+1+i;
+		fraction_free_row_update(tmp_n, tmp_d, n, r0, c0, r2, divisor_n, divisor_d);
+		exvector entries(tmp_n.begin()+r2*n+c0+1, tmp_n.begin()+(r2+1)*n);
+		entries.insert(entries.end(), tmp_d.begin()+r2*n+c0+1, tmp_d.begin()+(r2+1)*n);
+		return entries;
+	}
+	void store(size_t i, const exvector & entries)
+	{
+		const unsigned r2 = r0+1+i;
+		const unsigned k = n-c0-1;
+		GINAC_ASSERT(entries.size()==2*k);
+		std::copy(entries.begin(), entries.begin()+k, tmp_n.begin()+r2*n+c0+1);
+		std::copy(entries.begin()+k, entries.end(), tmp_d.begin()+r2*n+c0+1);
+	}
+private:
+	exvector & tmp_n, & tmp_d;
+	unsigned n, r0, c0;
+	const ex & divisor_n, & divisor_d;
+};
+
 /** Perform the steps of an ordinary Gaussian elimination to bring the m x n
  *  matrix into an upper echelon form.  The algorithm is ok for matrices
  *  with numeric coefficients but quite unsuited for symbolic matrices.
@@ -1240,9 +1876,13 @@ ex matrix::determinant_minor() const
  *  @param det may be set to true to save a lot of space if one is only
  *  interested in the diagonal elements (i.e. for calculating determinants).
  *  The others are set to zero in this case.
+ *  @param processes number of worker processes that update the rows below
+ *  each pivot concurrently, 0 means one per processor (see
+ *  solve_algo::parallel for the limitations).  The result does not depend
+ *  on it.
  *  @return sign is 1 if an even number of rows was swapped, -1 if an odd
  *  number of rows was swapped and 0 if the matrix is singular. */
-int matrix::gauss_elimination(const bool det)
+int matrix::gauss_elimination(const bool det, unsigned processes)
 {
 	ensure_if_modifiable();
 	const unsigned m = this->rows();
@@ -1261,16 +1901,19 @@ int matrix::gauss_elimination(const bool det)
 		if (indx>=0) {
 			if (indx > 0)
 				sign = -sign;
+			if (processes == 1 || !have_worker_processes()) {
+				for (unsigned r2=r0+1; r2<m; ++r2)
+					if (!this->m[r2*n+c0].is_zero())
+						gauss_row_update(this->m, n, r0, c0, r2);
+			} else {
+				std::vector<unsigned> rows;
+				for (unsigned r2=r0+1; r2<m; ++r2)
+					if (!this->m[r2*n+c0].is_zero())
+						rows.push_back(r2);
+				gauss_row_jobs jobs(this->m, n, r0, c0, rows);
+				update_rows(jobs, rows.size(), processes, this->m);
+			}
 			for (unsigned r2=r0+1; r2<m; ++r2) {
-				if (!this->m[r2*n+c0].is_zero()) {
-					// yes, there is something to do in this row
-					ex piv = this->m[r2*n+c0] / this->m[r0*n+c0];
-					for (unsigned c=c0+1; c<n; ++c) {
-						this->m[r2*n+c] -= piv * this->m[r0*n+c];
-						if (!this->m[r2*n+c].info(info_flags::numeric))
-							this->m[r2*n+c] = this->m[r2*n+c].normal();
-					}
-				}
 				// fill up left hand side with zeros
 				for (unsigned c=r0; c<=c0; ++c)
 					this->m[r2*n+c] = _ex0;
@@ -1353,9 +1996,13 @@ int matrix::division_free_elimination(const bool det)
  *  @param det may be set to true to save a lot of space if one is only
  *  interested in the last element (i.e. for calculating determinants). The
  *  others are set to zero in this case.
+ *  @param processes number of worker processes that update the rows below
+ *  each pivot concurrently, 0 means one per processor (see
+ *  solve_algo::parallel for the limitations).  The result does not depend
+ *  on it.
  *  @return sign is 1 if an even number of rows was swapped, -1 if an odd
  *  number of rows was swapped and 0 if the matrix is singular. */
-int matrix::fraction_free_elimination(const bool det)
+int matrix::fraction_free_elimination(const bool det, unsigned processes)
 {
 	// Method:
 	// (single-step fraction free elimination scheme, already known to Jordan)
@@ -1390,8 +2037,6 @@ int matrix::fraction_free_elimination(const bool det)
 		return 1;
 	ex divisor_n = 1;
 	ex divisor_d = 1;
-	ex dividend_n;
-	ex dividend_d;
 	
 	// We populate temporary matrices to subsequently operate on.  There is
 	// one holding numerators and another holding denominators of entries.
@@ -1436,20 +2081,17 @@ int matrix::fraction_free_elimination(const bool det)
 					tmp_d.m[n*indx+c].swap(tmp_d.m[n*r0+c]);
 				}
 			}
+			if (processes == 1 || !have_worker_processes()) {
+				for (unsigned r2=r0+1; r2<m; ++r2)
+					fraction_free_row_update(tmp_n.m, tmp_d.m, n, r0, c0, r2,
+					                         divisor_n, divisor_d);
+			} else {
+				fraction_free_row_jobs jobs(tmp_n.m, tmp_d.m, n, r0, c0, divisor_n, divisor_d);
+				exvector entries(tmp_n.m);
+				entries.insert(entries.end(), tmp_d.m.begin(), tmp_d.m.end());
+				update_rows(jobs, m-r0-1, processes, entries);
+			}
 			for (unsigned r2=r0+1; r2<m; ++r2) {
-				for (unsigned c=c0+1; c<n; ++c) {
-					dividend_n = (tmp_n.m[r0*n+c0]*tmp_n.m[r2*n+c]*
-					              tmp_d.m[r2*n+c0]*tmp_d.m[r0*n+c]
-					             -tmp_n.m[r2*n+c0]*tmp_n.m[r0*n+c]*
-					              tmp_d.m[r0*n+c0]*tmp_d.m[r2*n+c]).expand();
-					dividend_d = (tmp_d.m[r2*n+c0]*tmp_d.m[r0*n+c]*
-					              tmp_d.m[r0*n+c0]*tmp_d.m[r2*n+c]).expand();
-					bool check = divide(dividend_n, divisor_n,
-					                    tmp_n.m[r2*n+c], true);
-					check &= divide(dividend_d, divisor_d,
-					                tmp_d.m[r2*n+c], true);
-					GINAC_ASSERT(check);
-				}
 				// fill up left hand side with zeros
 				for (unsigned c=r0; c<=c0; ++c)
 					tmp_n.m[r2*n+c] = _ex0;
@@ -141,7 +141,7 @@ public:
 		{ return col; }
 	matrix add(const matrix & other) const;
 	matrix sub(const matrix & other) const;
-	matrix mul(const matrix & other) const;
+	matrix mul(const matrix & other, unsigned processes = 1) const;
 	matrix mul(const numeric & other) const;
 	matrix mul_scalar(const ex & other) const;
 	matrix pow(const ex & expn) const;
@@ -159,9 +159,9 @@ public:
 	bool is_zero_matrix() const;
 protected:
 	ex determinant_minor() const;
-	int gauss_elimination(const bool det = false);
+	int gauss_elimination(const bool det = false, unsigned processes = 1);
 	int division_free_elimination(const bool det = false);
-	int fraction_free_elimination(const bool det = false);
+	int fraction_free_elimination(const bool det = false, unsigned processes = 1);
 	int pivot(unsigned ro, unsigned co, bool symbolic = true);
 
 	void print_elements(const print_context & c, const char *row_start, const char *row_end, const char *row_sep, const char *col_sep) const;
@@ -32,6 +32,7 @@
 #include "symbol.h"
 #include "compiler.h"
 
+#include <cmath>
 #include <iostream>
 #include <limits>
 #include <stdexcept>
@@ -631,6 +632,20 @@ ex mul::evalf(int level) const
 	return mul(s, overall_coeff.evalf(level));
 }
 
+double mul::evalf_double(const exmap & m) const
+{
+	double prod = overall_coeff.evalf_double(m);
+	epvector::const_iterator i = seq.begin(), end = seq.end();
+	while (i != end) {
+		if (i->coeff.is_equal(_ex1))
+			prod *= i->rest.evalf_double(m);
+		else
+			prod *= std::pow(i->rest.evalf_double(m), i->coeff.evalf_double(m));
+		++i;
+	}
+	return prod;
+}
+
 void mul::find_real_imag(ex & rp, ex & ip) const
 {
 	rp = overall_coeff.real_part();
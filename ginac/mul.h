@@ -56,6 +56,7 @@ public:
 	bool has(const ex & other, unsigned options = 0) const;
 	ex eval(int level=0) const;
 	ex evalf(int level=0) const;
+	double evalf_double(const exmap & m) const;
 	ex real_part() const;
 	ex imag_part() const;
 	ex evalm() const;
@@ -42,6 +42,8 @@
 #include "symbol.h"
 #include "utils.h"
 #include "polynomial/chinrem_gcd.h"
+#include "polynomial/sparse_gcd.h"
+#include "worker_processes.h"
 
 #include <algorithm>
 #include <map>
@@ -223,6 +225,27 @@ static void get_symbol_stats(const ex &a, const ex &b, sym_desc_vec &v)
 }
 
 
+/** Decide whether the GCD of two polynomials is better computed by the
+ *  sparse modular algorithm.  This is the case for six variables or more
+ *  when the polynomials have less than about one in sixteen of the terms
+ *  that dense polynomials with the degrees in the symbol statistics have.
+ *
+ *  @see get_symbol_stats */
+static bool is_sparse_gcd_problem(const ex &a, const ex &b, const sym_desc_vec &v)
+{
+	if (v.size() < 6)
+		return false;
+	const size_t terms = (is_exactly_a<add>(a) ? a.nops() : 1) + (is_exactly_a<add>(b) ? b.nops() : 1);
+	size_t dense = 1;
+	for (sym_desc_vec::const_iterator it = v.begin(); it != v.end(); ++it) {
+		dense *= it->max_deg + 1;
+		if (dense >= 16*terms)
+			return true;
+	}
+	return false;
+}
+
+
 /*
  *  Computation of LCM of denominators of coefficients of a polynomial
  */
@@ -1603,8 +1626,26 @@ ex gcd(const ex &a, const ex &b, ex *ca, ex *cb, bool check_args, unsigned optio
 		return g;
 	}
 
-	// Try heuristic algorithm first, fall back to PRS if that failed
+	// Sparse polynomials in many variables go to Zippel's algorithm first
 	ex g;
+	if ((options & gcd_options::use_sparse_gcd) ||
+	    (!(options & gcd_options::use_sr_gcd) && is_sparse_gcd_problem(aex, bex, sym_stats))) {
+		exvector vars;
+		for (std::size_t n = sym_stats.size(); n-- != 0; )
+			vars.push_back(sym_stats[n].sym);
+		if (sparse_gcd(g, aex, bex, vars, ca, cb)) {
+			if (g.is_equal(_ex1)) {
+				// keep the cofactors factored if possible
+				if (ca)
+					*ca = a;
+				if (cb)
+					*cb = b;
+			}
+			return g;
+		}
+	}
+
+	// Try heuristic algorithm, fall back to PRS if that failed
 	if (!(options & gcd_options::no_heur_gcd)) {
 		bool found = heur_gcd(g, aex, bex, ca, cb, var);
 		if (found) {
@@ -2163,6 +2204,107 @@ static ex frac_cancel(const ex &n, const ex &d)
 }
 
 
+/** Number of processes for the pairwise additions of the outermost sum
+ *  being normalized by ex::normal(), consumed by add::normal(). */
+static unsigned normal_processes = 1;
+
+/** Set normal_processes for the duration of one call of ex::normal(). */
+class normal_processes_guard {
+public:
+	normal_processes_guard(unsigned processes) : saved(normal_processes) { normal_processes = processes; }
+	~normal_processes_guard() { normal_processes = saved; }
+private:
+	unsigned saved;
+};
+
+/** Add the fractions fnums[i]/fdens[i] pairwise in a balanced tree.  On
+ *  return, fnums and fdens hold a single fraction. */
+static void add_fractions(exvector & fnums, exvector & fdens)
+{
+	while (fnums.size() > 1) {
+		size_t out = 0;
+		for (size_t i=0; i+1<fnums.size(); i+=2, ++out) {
+			// Addition of two fractions, taking advantage of the fact that
+			// the heuristic GCD algorithm computes the cofactors at no extra cost
+			ex co_den1, co_den2;
+			ex g = gcd(fdens[i], fdens[i+1], &co_den1, &co_den2, false);
+			fnums[out] = ((fnums[i] * co_den2) + (fnums[i+1] * co_den1)).expand();
+			fdens[out] = fdens[i] * co_den2;	// this is the lcm of the denominators
+		}
+		if (fnums.size() % 2) {
+			fnums[out] = fnums.back();
+			fdens[out] = fdens.back();
+			++out;
+		}
+		fnums.resize(out);
+		fdens.resize(out);
+	}
+}
+
+/** Jobs of add_fraction_blocks(): job i adds the fractions of block i and
+ *  delivers the numerator and denominator of the sum. */
+class fraction_block_jobs : public worker_jobs
+{
+public:
+	fraction_block_jobs(const exvector & n, const exvector & d, size_t b)
+	  : fnums(n), fdens(d), blocks(b) {}
+
+	size_t begin(size_t i) const { return i * fnums.size() / blocks; }
+
+	exvector compute(size_t i)
+	{
+		exvector nums(fnums.begin() + begin(i), fnums.begin() + begin(i+1));
+		exvector dens(fdens.begin() + begin(i), fdens.begin() + begin(i+1));
+		add_fractions(nums, dens);
+		exvector res;
+		res.push_back(nums[0]);
+		res.push_back(dens[0]);
+		return res;
+	}
+
+private:
+	const exvector & fnums;
+	const exvector & fdens;
+	size_t blocks;
+};
+
+/** Replace the fractions fnums[i]/fdens[i] by the sums of contiguous blocks
+ *  of them, computed in up to the given number of worker processes, 0
+ *  meaning one per processor.  Blocks whose worker fails are added here. */
+static void add_fraction_blocks(exvector & fnums, exvector & fdens, unsigned processes)
+{
+	if (!have_worker_processes())
+		return;
+	if (processes == 0)
+		processes = processor_count();
+	// at least two fractions per block
+	const size_t blocks = std::min(size_t(processes), fnums.size() / 2);
+	if (blocks < 2)
+		return;
+
+	// The temporary symbols of the normalization are named uniquely, but
+	// symbols of the input may share names
+	exvector all(fnums);
+	all.insert(all.end(), fdens.begin(), fdens.end());
+	lst syms;
+	if (!collect_worker_symbols(all, syms))
+		return;
+
+	fraction_block_jobs jobs(fnums, fdens, blocks);
+	std::vector<exvector> results;
+	std::vector<bool> done;
+	compute_in_processes(jobs, blocks, processes, syms, results, done);
+	exvector nums, dens;
+	for (size_t i=0; i<blocks; ++i) {
+		if (!done[i])
+			results[i] = jobs.compute(i);
+		nums.push_back(results[i][0]);
+		dens.push_back(results[i][1]);
+	}
+	fnums.swap(nums);
+	fdens.swap(dens);
+}
+
 /** Implementation of ex::normal() for a sum. It expands terms and performs
  *  fractional addition.
  *  @see ex::normal */
@@ -2173,6 +2315,10 @@ ex add::normal(exmap & repl, exmap & rev_lookup, int level) const
 	else if (level == -max_recursion_level)
 		throw(std::runtime_error("max recursion level reached"));
 
+	// Only the outermost sum is reduced in worker processes
+	const unsigned processes = normal_processes;
+	normal_processes = 1;
+
 	// Normalize children and split each one into numerator and denominator
 	exvector nums, dens;
 	nums.reserve(seq.size()+1);
@@ -2193,28 +2339,36 @@ ex add::normal(exmap & repl, exmap & rev_lookup, int level) const
 	// all denominators
 //std::clog << "add::normal uses " << nums.size() << " summands:\n";
 
-	// Add fractions sequentially
-	exvector::const_iterator num_it = nums.begin(), num_itend = nums.end();
-	exvector::const_iterator den_it = dens.begin(), den_itend = dens.end();
-//std::clog << " num = " << *num_it << ", den = " << *den_it << std::endl;
-	ex num = *num_it++, den = *den_it++;
-	while (num_it != num_itend) {
-//std::clog << " num = " << *num_it << ", den = " << *den_it << std::endl;
-		ex next_num = *num_it++, next_den = *den_it++;
-
-		// Trivially add sequences of fractions with identical denominators
-		while ((den_it != den_itend) && next_den.is_equal(*den_it)) {
-			next_num += *num_it;
-			num_it++; den_it++;
+	// Trivially add the fractions with identical denominators, in the order
+	// in which the denominators first occur
+	typedef std::map<ex, size_t, ex_is_less> den_index_map;
+	den_index_map den_index;
+	std::vector<exvector> group_nums;
+	exvector fnums, fdens;
+	for (size_t i=0; i<nums.size(); ++i) {
+		const std::pair<den_index_map::iterator, bool> ins = den_index.insert(std::make_pair(dens[i], fdens.size()));
+		if (ins.second) {
+			fdens.push_back(dens[i]);
+			group_nums.push_back(exvector());
 		}
-
-		// Additiion of two fractions, taking advantage of the fact that
-		// the heuristic GCD algorithm computes the cofactors at no extra cost
-		ex co_den1, co_den2;
-		ex g = gcd(den, next_den, &co_den1, &co_den2, false);
-		num = ((num * co_den2) + (next_num * co_den1)).expand();
-		den *= co_den2;		// this is the lcm(den, next_den)
+		group_nums[ins.first->second].push_back(nums[i]);
 	}
+	for (size_t i=0; i<group_nums.size(); ++i) {
+		if (group_nums[i].size() == 1)
+			fnums.push_back(group_nums[i][0]);
+		else
+			fnums.push_back(ex((new add(group_nums[i]))->setflag(status_flags::dynallocated)).expand());
+	}
+
+	// Add the fractions pairwise in a balanced tree, so the common
+	// denominators and numerators grow in few steps only; the outermost sum
+	// of a normalization that was asked to use several processes reduces
+	// contiguous blocks of fractions in worker processes first
+	if (processes != 1 && fnums.size() >= 4)
+		add_fraction_blocks(fnums, fdens, processes);
+	add_fractions(fnums, fdens);
+	const ex & num = fnums[0];
+	const ex & den = fdens[0];
 //std::clog << " common denominator = " << den << std::endl;
 
 	// Cancel common factors from num/den
@@ -2337,11 +2491,16 @@ ex pseries::normal(exmap & repl, exmap & rev_lookup, int level) const
  *  expression can be treated as a rational function). normal() is applied
  *  recursively to arguments of functions etc.
  *
+ *  The fractions of the outermost sum are added in up to the given number
+ *  of worker processes, 0 meaning one per processor.
+ *
  *  @param level maximum depth of recursion
+ *  @param processes number of processes
  *  @return normalized expression */
-ex ex::normal(int level) const
+ex ex::normal(int level, unsigned processes) const
 {
 	exmap repl, rev_lookup;
+	normal_processes_guard guard(processes);
 
 	ex e = bp->normal(repl, rev_lookup, level);
 	GINAC_ASSERT(is_a<lst>(e));
@@ -58,7 +58,16 @@ struct gcd_options
 		 * it's much faster than PRS (pseudo remainder sequence)
 		 * algorithm. This flag forces GiNaC to use PRS algorithm
 		 */
-		use_sr_gcd = 8
+		use_sr_gcd = 8,
+		/**
+		 * Sparse polynomials in many variables are handled by Zippel's
+		 * sparse modular algorithm, whose cost depends on the number
+		 * of terms of the GCD rather than on the degrees. GiNaC
+		 * chooses it automatically when the input polynomials have
+		 * few terms compared to dense ones of the same degrees. This
+		 * flag makes GiNaC try it first in any case.
+		 */
+		use_sparse_gcd = 16
 
 	};
 };
@@ -34,7 +34,10 @@
 #include "archive.h"
 #include "tostring.h"
 #include "utils.h"
+#include "binsplit.h"
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
 #include <sstream>
 #include <stdexcept>
@@ -797,6 +800,13 @@ ex numeric::evalf(int level) const
 	return numeric(cln::cl_float(1.0, cln::default_float_format) * value);
 }
 
+double numeric::evalf_double(const exmap & m) const
+{
+	if (!is_real())
+		return std::numeric_limits<double>::quiet_NaN();
+	return to_double();
+}
+
 ex numeric::conjugate() const
 {
 	if (is_real()) {
@@ -1637,6 +1647,10 @@ static cln::cl_N Li2_series(const cln::cl_N &x,
                             const cln::float_format_t &prec)
 {
 	// Note: argument must be in the unit circle
+	const std::vector<cln::cl_N> xv(1, x);
+	if (binary_split_applies(xv))
+		return binary_split_sum(std::vector<int>(1, 2), xv, prec);
+
 	cln::cl_N aug, acc;
 	cln::cl_N num = cln::complex(cln::cl_float(1, prec), 0);
 	cln::cl_I den = 0;
@@ -2034,20 +2048,173 @@ static const cln::float_format_t guess_precision(const cln::cl_N& x)
 	return prec;
 }
 
+/** Tables for the asymptotic expansions of lgamma and psi at one float
+ *  format.  They are built when the format changes and shared by all
+ *  evaluations in that format. */
+struct stirling_tables
+{
+	stirling_tables() : bits(0), bound(0) {}
+	long bits;                          ///< float format of the tables
+	long bound;                         ///< real part the arguments are shifted to
+	cln::cl_N log_2pi_2;                ///< log(2*Pi)/2
+	std::vector<cln::cl_N> lgamma_c;    ///< B_{2k}/(2k(2k-1)), k = 1, 2, ...
+	std::vector<cln::cl_N> psi_c;       ///< B_{2k}/(2k), k = 1, 2, ...
+};
+
+static const stirling_tables & stirling(const cln::float_format_t & prec)
+{
+	static stirling_tables t;
+	if (t.bits != long(prec)) {
+		// Beyond the real part bound the terms of the expansions drop
+		// below the precision, roughly like exp(-2*Pi*bound), before they
+		// start to grow again after about Pi*bound terms.
+		const long digits = long(prec)*30103/100000 + 1;
+		t.bound = 37*digits/100 + 2;
+		const long terms = 22*t.bound/7 + 2;
+		const cln::cl_F one = cln::cl_float(1, prec);
+		t.lgamma_c.clear();
+		t.psi_c.clear();
+		t.lgamma_c.reserve(terms);
+		t.psi_c.reserve(terms);
+		for (long k=1; k<=terms; ++k) {
+			const cln::cl_N b = bernoulli(numeric(2*k)).to_cl_N() * one;
+			t.lgamma_c.push_back(b / (2*k*(2*k-1)));
+			t.psi_c.push_back(b / (2*k));
+		}
+		t.log_2pi_2 = cln::log(2*cln::pi(prec))/2;
+		t.bits = long(prec);
+	}
+	return t;
+}
+
+/** Number of steps x has to be shifted to the right to reach the real part
+ *  bound of the tables. */
+static long stirling_shift(const cln::cl_N & x, const stirling_tables & t)
+{
+	const double re = cln::double_approx(cln::realpart(x));
+	return re >= t.bound ? 0 : long(std::ceil(t.bound - re));
+}
+
+/** lgamma(z) for z with real part beyond the bound of the tables, by the
+ *  Stirling series. */
+static cln::cl_N lgamma_asymptotic(const cln::cl_N & z, const stirling_tables & t)
+{
+	const cln::cl_N w = cln::recip(z);
+	const cln::cl_N w2 = cln::square(w);
+	cln::cl_N acc = (z - cln::cl_RA(1)/2)*cln::log(z) - z + t.log_2pi_2;
+	cln::cl_N aug;
+	cln::cl_N pw = w;
+	for (std::vector<cln::cl_N>::const_iterator it = t.lgamma_c.begin(); it != t.lgamma_c.end(); ++it) {
+		aug = (*it) * pw;
+		if (acc == acc + aug)
+			break;
+		acc = acc + aug;
+		pw = pw * w2;
+	}
+	return acc;
+}
+
+/** The Gamma function at any precision, by the Stirling series after
+ *  shifting the argument with the recurrence Gamma(x+1) = x*Gamma(x).  The
+ *  real part of x must be at least 1/2.  If logarithm is true, lgamma is
+ *  computed instead. */
+static cln::cl_N gamma_stirling(const cln::cl_N & x, const cln::float_format_t & prec, bool logarithm)
+{
+	const stirling_tables & t = stirling(prec);
+	const long n = stirling_shift(x, t);
+	cln::cl_N z = x * cln::cl_float(1, prec);
+	cln::cl_N prod = cln::cl_float(1, prec);
+	double phase = 0;  // sum of the arguments of the factors of prod
+	for (long i=0; i<n; ++i) {
+		prod = prod * z;
+		phase += std::atan2(cln::double_approx(cln::imagpart(z)), cln::double_approx(cln::realpart(z)));
+		z = z + 1;
+	}
+	const cln::cl_N s = lgamma_asymptotic(z, t);
+	if (!logarithm)
+		return cln::exp(s) / prod;
+
+	// lgamma is the analytic continuation, which differs from the principal
+	// logarithm of prod by a multiple of 2*Pi*I
+	cln::cl_N logprod = cln::log(prod);
+	if (!cln::zerop(cln::imagpart(prod))) {
+		const double twopi = 6.283185307179586;
+		const double k = std::floor((phase - cln::double_approx(cln::imagpart(logprod)))/twopi + 0.5);
+		if (k != 0)
+			logprod = logprod + cln::complex(0, 2*cln::cl_I(long(k))*cln::pi(prec));
+	}
+	return s - logprod;
+}
+
+/** The psi function and its derivatives psi(n,x) at any precision, by the
+ *  asymptotic expansion after shifting the argument with the recurrence
+ *  psi(n,x+1) = psi(n,x) + (-1)^n*n!/x^(n+1). */
+static cln::cl_N psi_stirling(unsigned n, const cln::cl_N & x, const cln::float_format_t & prec)
+{
+	const stirling_tables & t = stirling(prec);
+	const long shift = stirling_shift(x, t);
+	cln::cl_N z = x * cln::cl_float(1, prec);
+	cln::cl_N corr;
+	for (long i=0; i<shift; ++i) {
+		corr = corr + cln::expt(cln::recip(z), int(n+1));
+		z = z + 1;
+	}
+
+	const cln::cl_N w = cln::recip(z);
+	const cln::cl_N w2 = cln::square(w);
+	cln::cl_N acc;
+	cln::cl_N aug;
+	cln::cl_N pw;
+	if (n == 0) {
+		acc = cln::log(z) - w/2;
+		pw = w2;
+	} else {
+		const cln::cl_I nfac = cln::factorial(n);
+		acc = cln::expt(w, int(n)) * (nfac/n) + cln::expt(w, int(n+1)) * nfac/2;
+		pw = cln::expt(w, int(n+2));
+	}
+	for (unsigned k=1; k<=t.psi_c.size(); ++k) {
+		// B_{2k}*(2k+n-1)!/(2k)! = psi_c[k-1]*2k*(2k+1)*...*(2k+n-1)
+		cln::cl_I f = 1;
+		for (unsigned j=2*k; j<2*k+n; ++j)
+			f = f * cln::cl_I(j);
+		aug = t.psi_c[k-1] * f * pw;
+		if (acc == acc + aug)
+			break;
+		acc = (n == 0) ? acc - aug : acc + aug;
+		pw = pw * w2;
+	}
+	if (n == 0)
+		return acc - corr;
+	const cln::cl_I nfac = cln::factorial(n);
+	return (n & 1) ? acc + nfac*corr : -acc - nfac*corr;
+}
+
+/** Check whether x is one of the poles 0, -1, -2, ... of the psi
+ *  functions. */
+static bool is_psi_pole(const cln::cl_N & x)
+{
+	if (!cln::zerop(cln::imagpart(x)))
+		return false;
+	const cln::cl_R re = cln::realpart(x);
+	return !cln::plusp(re) && cln::zerop(re - cln::round1(re));
+}
+
 /** The Gamma function.
  *  Use the Lanczos approximation. If the coefficients used here are not
- *  sufficiently many or sufficiently accurate, more can be calculated
- *  using the program doc/examples/lanczos.cpp. In that case, be sure to
- *  read the comments in that file. */
+ *  sufficiently many or sufficiently accurate, the Stirling series is used
+ *  instead, with coefficients kept per precision.  More Lanczos coefficients
+ *  can be calculated using the program doc/examples/lanczos.cpp. In that
+ *  case, be sure to read the comments in that file. */
 const cln::cl_N lgamma(const cln::cl_N &x)
 {
 	cln::float_format_t prec = guess_precision(x);
 	lanczos_coeffs lc;
+	cln::cl_N pi_val = cln::pi(prec);
+	if (realpart(x) < 0.5)
+		return cln::log(pi_val) - cln::log(sin(pi_val*x))
+			- lgamma(1 - x);
 	if (lc.sufficiently_accurate(prec)) {
-		cln::cl_N pi_val = cln::pi(prec);
-		if (realpart(x) < 0.5)
-			return cln::log(pi_val) - cln::log(sin(pi_val*x))
-				- lgamma(1 - x);
 		cln::cl_N A = lc.calc_lanczos_A(x);
 		cln::cl_N temp = x + lc.get_order() - cln::cl_N(1)/2;
    	cln::cl_N result = log(cln::cl_I(2)*pi_val)/2
@@ -2057,7 +2224,7 @@ const cln::cl_N lgamma(const cln::cl_N &x)
    	return result;
 	}
 	else 
-		throw dunno();
+		return gamma_stirling(x, prec, true);
 }
 
 const numeric lgamma(const numeric &x)
@@ -2071,10 +2238,10 @@ const cln::cl_N tgamma(const cln::cl_N &x)
 {
 	cln::float_format_t prec = guess_precision(x);
 	lanczos_coeffs lc;
+	cln::cl_N pi_val = cln::pi(prec);
+	if (realpart(x) < 0.5)
+		return pi_val/(cln::sin(pi_val*x))/tgamma(1 - x);
 	if (lc.sufficiently_accurate(prec)) {
-		cln::cl_N pi_val = cln::pi(prec);
-		if (realpart(x) < 0.5)
-			return pi_val/(cln::sin(pi_val*x))/tgamma(1 - x);
 		cln::cl_N A = lc.calc_lanczos_A(x);
 		cln::cl_N temp = x + lc.get_order() - cln::cl_N(1)/2;
    	cln::cl_N result
@@ -2083,7 +2250,7 @@ const cln::cl_N tgamma(const cln::cl_N &x)
    	return result;
 	}
 	else
-		throw dunno();
+		return gamma_stirling(x, prec, false);
 }
 
 const numeric tgamma(const numeric &x)
@@ -2093,19 +2260,38 @@ const numeric tgamma(const numeric &x)
 	return numeric(result);
 }
 
-/** The psi function (aka polygamma function).
- *  This is only a stub! */
+/** The psi function (aka digamma function).
+ *
+ *  @exception pole_error("psi(): simple pole",1) if x is 0, -1, -2, ... */
 const numeric psi(const numeric &x)
 {
-	throw dunno();
+	const cln::cl_N x_ = x.to_cl_N();
+	if (is_psi_pole(x_))
+		throw pole_error("psi(): simple pole",1);
+	cln::float_format_t prec = guess_precision(x_);
+	if (realpart(x_) < 0.5) {
+		// psi(x) = psi(1-x) - Pi*cot(Pi*x)
+		const cln::cl_N pix = cln::pi(prec)*x_;
+		return numeric(psi_stirling(0, 1 - x_, prec)
+		               - cln::pi(prec)*cln::cos(pix)/cln::sin(pix));
+	}
+	return numeric(psi_stirling(0, x_, prec));
 }
 
 
 /** The psi functions (aka polygamma functions).
- *  This is only a stub! */
+ *
+ *  @exception pole_error("psi(): pole",n+1) if x is 0, -1, -2, ... */
 const numeric psi(const numeric &n, const numeric &x)
 {
-	throw dunno();
+	if (!n.is_nonneg_integer())
+		throw dunno();
+	if (n.is_zero())
+		return psi(x);
+	const cln::cl_N x_ = x.to_cl_N();
+	if (is_psi_pole(x_))
+		throw pole_error("psi(): pole",n.to_int()+1);
+	return numeric(psi_stirling(n.to_int(), x_, guess_precision(x_)));
 }
 
 
@@ -2178,32 +2364,26 @@ const numeric bernoulli(const numeric &nn)
 	//
 	//     B_n = - 1/(n+1) * sum_{k=0}^{n-1}(binomial(n+1,k)*B_k)
 	//
-	// with B(0) = 1.  Since the n'th Bernoulli number depends on all the
-	// previous ones, the computation is necessarily very expensive.  There are
-	// several other ways of computing them, a particularly good one being
-	// cl_I s = 1;
-	// cl_I c = n+1;
-	// cl_RA Bern = 0;
-	// for (unsigned i=0; i<n; i++) {
-	//     c = exquo(c*(i-n),(i+2));
-	//     Bern = Bern + c*s/(i+2);
-	//     s = s + expt_pos(cl_I(i+2),n);
-	// }
-	// return Bern;
-	// 
-	// But if somebody works with the n'th Bernoulli number she is likely to
-	// also need all previous Bernoulli numbers. So we need a complete remember
-	// table and above divide and conquer algorithm is not suited to build one
-	// up.  The formula below accomplishes this.  It is a modification of the
-	// defining formula above but the computation of the binomial coefficients
-	// is carried along in an inline fashion.  It also honors the fact that
-	// B_n is zero when n is odd and greater than 1.
-	// 
-	// (There is an interesting relation with the tangent polynomials described
-	// in `Concrete Mathematics', which leads to a program a little faster as
-	// our implementation below, but it requires storing one such polynomial in
-	// addition to the remember table.  This doubles the memory footprint so
-	// we don't use it.)
+	// with B(0) = 1.  But this needs rational arithmetic with a gcd in every
+	// step.  Instead, we compute the tangent numbers T_k, the coefficients of
+	// tan(x) = sum_{k>=1} T_k * x^(2*k-1)/(2*k-1)!, which are integers, and
+	// obtain the Bernoulli numbers from
+	//
+	//     B_{2*k} = (-1)^(k-1) * 2*k * T_k / (2^(2*k)*(2^(2*k)-1)).
+	//
+	// The tangent numbers T_1, ..., T_m are computed in place by the
+	// algorithm of Brent and Harvey ("Fast computation of Bernoulli, tangent
+	// and secant numbers", 2011):
+	//
+	//     T_k = (k-1)*T_{k-1}                      for k = 2, ..., m,
+	//     T_j = (j-k)*T_{j-1} + (j-k+2)*T_j        for k = 2, ..., m and
+	//                                                  j = k, ..., m,
+	//
+	// with T_1 = 1.  This takes O(m^2) operations on integers only.  If
+	// somebody works with the n'th Bernoulli number she is likely to also
+	// need all previous Bernoulli numbers, so we keep a complete remember
+	// table.  Since the algorithm cannot be resumed, the table is rebuilt
+	// with at least twice its size whenever it is too short.
 
 	const unsigned n = nn.to_int();
 
@@ -2213,41 +2393,28 @@ const numeric bernoulli(const numeric &nn)
 	if (!n)
 		return *_num1_p;
 
-	// store nonvanishing Bernoulli numbers here
+	// store nonvanishing Bernoulli numbers B_2, B_4, ... here
 	static std::vector< cln::cl_RA > results;
-	static unsigned next_r = 0;
 
-	// algorithm not applicable to B(2), so just store it
-	if (!next_r) {
-		results.push_back(cln::recip(cln::cl_RA(6)));
-		next_r = 4;
-	}
-	if (n<next_r)
-		return numeric(results[n/2-1]);
-
-	results.reserve(n/2);
-	for (unsigned p=next_r; p<=n;  p+=2) {
-		cln::cl_I  c = 1;  // seed for binonmial coefficients
-		cln::cl_RA b = cln::cl_RA(p-1)/-2;
-		// The CLN manual says: "The conversion from `unsigned int' works only
-		// if the argument is < 2^29" (This is for 32 Bit machines. More
-		// generally, cl_value_len is the limiting exponent of 2. We must make
-		// sure that no intermediates are created which exceed this value. The
-		// largest intermediate is (p+3-2*k)*(p/2-k+1) <= (p^2+p)/2.
-		if (p < (1UL<<cl_value_len/2)) {
-			for (unsigned k=1; k<=p/2-1; ++k) {
-				c = cln::exquo(c * ((p+3-2*k) * (p/2-k+1)), (2*k-1)*k);
-				b = b + c*results[k-1];
-			}
-		} else {
-			for (unsigned k=1; k<=p/2-1; ++k) {
-				c = cln::exquo((c * (p+3-2*k)) * (p/2-k+1), cln::cl_I(2*k-1)*k);
-				b = b + c*results[k-1];
-			}
- 		}
-		results.push_back(-b/(p+1));
+	if (n/2 > results.size()) {
+		const unsigned m = std::max<unsigned>(n/2, 2*results.size());
+		std::vector< cln::cl_I > T(m + 1);
+		T[1] = 1;
+		for (unsigned k=2; k<=m; ++k)
+			T[k] = (k-1) * T[k-1];
+		for (unsigned k=2; k<=m; ++k) {
+			for (unsigned j=k; j<=m; ++j)
+				T[j] = (j-k) * T[j-1] + (j-k+2) * T[j];
+		}
+		results.clear();
+		results.reserve(m);
+		cln::cl_I four_k = 1;  // 2^(2*k)
+		for (unsigned k=1; k<=m; ++k) {
+			four_k = four_k * 4;
+			const cln::cl_RA b = (2*k) * T[k] / (four_k * (four_k - 1));
+			results.push_back(k & 1 ? b : -b);
+		}
 	}
-	next_r = n+2;
 	return numeric(results[n/2-1]);
 }
 
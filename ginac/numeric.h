@@ -111,6 +111,7 @@ public:
 	bool has(const ex &other, unsigned options = 0) const;
 	ex eval(int level = 0) const;
 	ex evalf(int level = 0) const;
+	double evalf_double(const exmap & m) const;
 	ex subs(const exmap & m, unsigned options = 0) const { return subs_one_level(m, options); } // overwrites basic::subs() for performance reasons
 	ex normal(exmap & repl, exmap & rev_lookup, int level = 0) const;
 	ex to_rational(exmap & repl) const;
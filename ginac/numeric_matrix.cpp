@@ -0,0 +1,744 @@
+/** @file numeric_matrix.cpp
+ *
+ *  Implementation of the dense matrices of numbers behind the numeric fast
+ *  paths of class matrix. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "numeric_matrix.h"
+#include "numeric.h"
+#include "polynomial/cra_garner.h"
+#include "polynomial/primes_factory.h"
+#include "worker_processes.h"
+
+#include <algorithm>
+#include <cln/rational.h>
+#include <cln/real.h>
+#include <stdexcept>
+#include <string>
+
+namespace GiNaC {
+
+namespace {
+
+/** Smallest dimension of rational matrices for which the multimodular
+ *  methods beat fraction free elimination. */
+const unsigned modular_min_dim = 6;
+
+bool is_rational_entry(const cln::cl_N & x)
+{
+	return cln::instanceof(x, cln::cl_RA_ring);
+}
+
+bool is_exact_entry(const cln::cl_N & x)
+{
+	return cln::instanceof(cln::realpart(x), cln::cl_RA_ring)
+	    && cln::instanceof(cln::imagpart(x), cln::cl_RA_ring);
+}
+
+/** Smallest dimension of integer matrices for which a step of the
+ *  Strassen-Winograd scheme, trading one of eight block multiplications for
+ *  fifteen block additions, pays off. */
+const unsigned strassen_min_dim = 32;
+
+bool is_integer_entry(const cln::cl_N & x)
+{
+	return cln::instanceof(x, cln::cl_I_ring);
+}
+
+numeric_matrix block(const numeric_matrix & a, unsigned r0, unsigned c0, unsigned r, unsigned c)
+{
+	numeric_matrix b(r, c);
+	for (unsigned i=0; i<r; ++i)
+		for (unsigned j=0; j<c; ++j)
+			b(i,j) = a(r0+i, c0+j);
+	return b;
+}
+
+numeric_matrix operator+(const numeric_matrix & a, const numeric_matrix & b)
+{
+	numeric_matrix s(a.rows(), a.cols());
+	for (unsigned i=0; i<a.rows(); ++i)
+		for (unsigned j=0; j<a.cols(); ++j)
+			s(i,j) = a(i,j) + b(i,j);
+	return s;
+}
+
+numeric_matrix operator-(const numeric_matrix & a, const numeric_matrix & b)
+{
+	numeric_matrix s(a.rows(), a.cols());
+	for (unsigned i=0; i<a.rows(); ++i)
+		for (unsigned j=0; j<a.cols(); ++j)
+			s(i,j) = a(i,j) - b(i,j);
+	return s;
+}
+
+/** Add the product of the rows r0..r1-1 of a, restricted to the columns
+ *  k0..k1-1, and the columns c0..c1-1 of b to the entries of p. */
+void multiply_add(const numeric_matrix & a, const numeric_matrix & b, numeric_matrix & p,
+                  unsigned r0, unsigned r1, unsigned k0, unsigned k1, unsigned c0, unsigned c1)
+{
+	for (unsigned i=r0; i<r1; ++i) {
+		for (unsigned k=k0; k<k1; ++k) {
+			const cln::cl_N & aik = a(i,k);
+			if (cln::zerop(aik))
+				continue;
+			for (unsigned j=c0; j<c1; ++j)
+				p(i,j) = p(i,j) + aik * b(k,j);
+		}
+	}
+}
+
+/** Product by Winograd's variant of Strassen's scheme, with seven products
+ *  of half the size.  Odd rows and columns are peeled off and multiplied
+ *  classically. */
+numeric_matrix strassen_mul(const numeric_matrix & a, const numeric_matrix & b)
+{
+	const unsigned m = a.rows(), k = a.cols(), n = b.cols();
+	numeric_matrix c(m, n);
+	if (std::min(m, std::min(k, n)) < strassen_min_dim) {
+		multiply_add(a, b, c, 0, m, 0, k, 0, n);
+		return c;
+	}
+	const unsigned m2 = m/2, k2 = k/2, n2 = n/2;
+	const numeric_matrix a11 = block(a, 0, 0, m2, k2), a12 = block(a, 0, k2, m2, k2);
+	const numeric_matrix a21 = block(a, m2, 0, m2, k2), a22 = block(a, m2, k2, m2, k2);
+	const numeric_matrix b11 = block(b, 0, 0, k2, n2), b12 = block(b, 0, n2, k2, n2);
+	const numeric_matrix b21 = block(b, k2, 0, k2, n2), b22 = block(b, k2, n2, k2, n2);
+
+	const numeric_matrix s1 = a21 + a22, s2 = s1 - a11, s3 = a11 - a21, s4 = a12 - s2;
+	const numeric_matrix t1 = b12 - b11, t2 = b22 - t1, t3 = b22 - b12, t4 = t2 - b21;
+	const numeric_matrix p1 = strassen_mul(a11, b11);
+	const numeric_matrix p2 = strassen_mul(a12, b21);
+	const numeric_matrix p3 = strassen_mul(s4, b22);
+	const numeric_matrix p4 = strassen_mul(a22, t4);
+	const numeric_matrix p5 = strassen_mul(s1, t1);
+	const numeric_matrix p6 = strassen_mul(s2, t2);
+	const numeric_matrix p7 = strassen_mul(s3, t3);
+	const numeric_matrix u2 = p1 + p6, u3 = u2 + p7;
+	const numeric_matrix c11 = p1 + p2, c12 = u2 + p5 + p3, c21 = u3 - p4, c22 = u3 + p5;
+	for (unsigned i=0; i<m2; ++i) {
+		for (unsigned j=0; j<n2; ++j) {
+			c(i,j) = c11(i,j);
+			c(i,j+n2) = c12(i,j);
+			c(i+m2,j) = c21(i,j);
+			c(i+m2,j+n2) = c22(i,j);
+		}
+	}
+
+	if (k & 1)
+		multiply_add(a, b, c, 0, 2*m2, k-1, k, 0, 2*n2);
+	if (n & 1)
+		multiply_add(a, b, c, 0, m, 0, k, n-1, n);
+	if (m & 1)
+		multiply_add(a, b, c, m-1, m, 0, k, 0, 2*n2);
+	return c;
+}
+
+long mod_p(const cln::cl_I & a, long p)
+{
+	return cln::cl_I_to_long(cln::mod(a, p));
+}
+
+/** Symmetric representative of a mod p, for use with integer_cra(). */
+cln::cl_I symmetric_mod_p(long a, long p)
+{
+	return a > (p >> 1) ? cln::cl_I(a) - p : cln::cl_I(a);
+}
+
+long mul_mod_p(long a, long b, long p)
+{
+	return (long)((unsigned long long)a * (unsigned long long)b % (unsigned long long)p);
+}
+
+long sub_mod_p(long a, long b, long p)
+{
+	return a >= b ? a - b : a - b + p;
+}
+
+long recip_mod_p(long a, long p)
+{
+	long r0 = p, r1 = a;
+	long s0 = 0, s1 = 1;
+	while (r1 != 0) {
+		const long q = r0 / r1;
+		long t = r0 - q*r1;
+		r0 = r1;
+		r1 = t;
+		t = s0 - q*s1;
+		s0 = s1;
+		s1 = t;
+	}
+	return s0 < 0 ? s0 + p : s0;
+}
+
+/** Gauss-Jordan elimination of the n x cols matrix a over Z_p, choosing the
+ *  pivots in the first n columns.  If they form a regular matrix, the last
+ *  cols-n columns hold the solution of the linear system afterwards.  With
+ *  cols==n only the entries below the pivots are eliminated.
+ *
+ *  @return determinant of the first n columns mod p */
+long gauss_jordan_mod_p(std::vector<long> & a, unsigned n, unsigned cols, long p)
+{
+	long det = 1;
+	for (unsigned c0=0; c0<n; ++c0) {
+		unsigned k = c0;
+		while (k<n && a[k*cols+c0]==0)
+			++k;
+		if (k==n)
+			return 0;
+		if (k!=c0) {
+			for (unsigned c=c0; c<cols; ++c)
+				std::swap(a[k*cols+c], a[c0*cols+c]);
+			det = p - det;
+		}
+		det = mul_mod_p(det, a[c0*cols+c0], p);
+		const long inv = recip_mod_p(a[c0*cols+c0], p);
+		for (unsigned c=c0; c<cols; ++c)
+			a[c0*cols+c] = mul_mod_p(a[c0*cols+c], inv, p);
+		for (unsigned r=(cols>n ? 0 : c0+1); r<n; ++r) {
+			const long f = a[r*cols+c0];
+			if (r==c0 || f==0)
+				continue;
+			for (unsigned c=c0; c<cols; ++c)
+				a[r*cols+c] = sub_mod_p(a[r*cols+c], mul_mod_p(f, a[c0*cols+c], p), p);
+		}
+	}
+	return det;
+}
+
+cln::cl_I chinese_remainder(const std::vector<cln::cl_I> & residues,
+                            const std::vector<cln::cl_I> & moduli)
+{
+	if (moduli.size() == 1)
+		return residues[0];
+	return cln::integer_cra(residues, moduli);
+}
+
+cln::cl_I norm_squared(const std::vector<cln::cl_I> & a, unsigned start, unsigned stride, unsigned count)
+{
+	cln::cl_I s = 0;
+	for (unsigned i=0; i<count; ++i)
+		s = s + cln::square(a[start + i*stride]);
+	return s;
+}
+
+/** Word sized primes whose product exceeds twice the square root of
+ *  bound_squared, none of them dividing g. */
+std::vector<long> choose_primes(const cln::cl_I & bound_squared, const cln::cl_I & g,
+                                const char * caller)
+{
+	std::vector<long> moduli;
+	primes_factory primes;
+	cln::cl_I modulus = 1;
+	while (cln::square(modulus) <= 4*bound_squared) {
+		long p;
+		if (!primes(p, g))
+			throw (std::runtime_error(std::string(caller) + ": out of primes"));
+		moduli.push_back(p);
+		modulus = modulus * p;
+	}
+	return moduli;
+}
+
+/** Images of the integer n x cols matrix a modulo primes, one job per
+ *  prime.  With cols==n a job yields the determinant of a mod p, otherwise
+ *  det times the solution of the system mod p, det being the determinant of
+ *  the first n columns. */
+class modular_images_jobs : public worker_jobs
+{
+public:
+	modular_images_jobs(const std::vector<cln::cl_I> & a_, unsigned n_, unsigned cols_,
+	                    const cln::cl_I & det_, const std::vector<long> & primes_)
+	  : a(a_), n(n_), cols(cols_), det(det_), primes(primes_) {}
+
+	/** Number of images per prime. */
+	unsigned count() const { return cols==n ? 1 : n*(cols-n); }
+
+	exvector compute(size_t i)
+	{
+		const long p = primes[i];
+		std::vector<long> ap(n*cols);
+		for (unsigned j=0; j<n*cols; ++j)
+			ap[j] = mod_p(a[j], p);
+		const long det_p = gauss_jordan_mod_p(ap, n, cols, p);
+		exvector images;
+		if (cols==n) {
+			images.push_back(numeric(symmetric_mod_p(det_p, p)));
+			return images;
+		}
+		const long det_q = mod_p(det, p);
+		images.reserve(count());
+		for (unsigned r=0; r<n; ++r)
+			for (unsigned c=n; c<cols; ++c)
+				images.push_back(numeric(symmetric_mod_p(mul_mod_p(det_q, ap[r*cols+c], p), p)));
+		return images;
+	}
+
+private:
+	const std::vector<cln::cl_I> & a;
+	unsigned n;
+	unsigned cols;
+	cln::cl_I det;
+	const std::vector<long> & primes;
+};
+
+/** Combine the images modulo all primes by Chinese remaindering.  The
+ *  images are computed in worker processes if more than one process is
+ *  asked for (0 meaning one per processor); the remaindering is left to the
+ *  calling process. */
+std::vector<cln::cl_I> combine_images(modular_images_jobs & jobs, const std::vector<long> & primes,
+                                      unsigned processes)
+{
+	const size_t k = primes.size();
+	std::vector<exvector> images;
+	std::vector<bool> done(k, false);
+	if (processes!=1 && k>1 && have_worker_processes())
+		compute_in_processes(jobs, k, processes, lst(), images, done);
+	else
+		images.resize(k);
+
+	const unsigned count = jobs.count();
+	std::vector<std::vector<cln::cl_I> > residues(count);
+	std::vector<cln::cl_I> moduli;
+	moduli.reserve(k);
+	for (size_t i=0; i<k; ++i) {
+		bool ok = done[i] && images[i].size()==count;
+		for (unsigned j=0; ok && j<count; ++j)
+			ok = images[i][j].info(info_flags::integer);
+		if (!ok)
+			images[i] = jobs.compute(i);
+		for (unsigned j=0; j<count; ++j)
+			residues[j].push_back(cln::the<cln::cl_I>(ex_to<numeric>(images[i][j]).to_cl_N()));
+		moduli.push_back(primes[i]);
+	}
+
+	std::vector<cln::cl_I> values;
+	values.reserve(count);
+	for (unsigned j=0; j<count; ++j)
+		values.push_back(chinese_remainder(residues[j], moduli));
+	return values;
+}
+
+/** Determinant of the integer n x n matrix a, computed modulo word sized
+ *  primes until their product exceeds twice Hadamard's bound. */
+cln::cl_I modular_determinant(const std::vector<cln::cl_I> & a, unsigned n, unsigned processes)
+{
+	// |det(a)| is at most the product of the norms of the rows
+	cln::cl_I bound_squared = 1;
+	for (unsigned r=0; r<n; ++r)
+		bound_squared = bound_squared * norm_squared(a, r*n, 1, n);
+	if (cln::zerop(bound_squared))
+		return 0;
+
+	const std::vector<long> primes = choose_primes(bound_squared, 1, "modular_determinant()");
+	modular_images_jobs jobs(a, n, n, 1, primes);
+	return combine_images(jobs, primes, processes)[0];
+}
+
+} // anonymous namespace
+
+
+numeric_matrix::numeric_matrix(unsigned r, unsigned c)
+  : row(r), col(c), m(r*c, cln::cl_N(0))
+{
+}
+
+/** Construct from the entries of a matrix, which must all be numbers.
+ *
+ *  @see numeric_matrix::is_numeric */
+numeric_matrix::numeric_matrix(unsigned r, unsigned c, const exvector & m2)
+  : row(r), col(c)
+{
+	m.reserve(r*c);
+	for (exvector::const_iterator i=m2.begin(); i!=m2.end(); ++i)
+		m.push_back(ex_to<numeric>(*i).to_cl_N());
+}
+
+bool numeric_matrix::is_numeric(const exvector & m2)
+{
+	for (exvector::const_iterator i=m2.begin(); i!=m2.end(); ++i)
+		if (!is_exactly_a<numeric>(*i))
+			return false;
+	return true;
+}
+
+exvector numeric_matrix::to_exvector() const
+{
+	exvector v;
+	v.reserve(m.size());
+	for (std::vector<cln::cl_N>::const_iterator i=m.begin(); i!=m.end(); ++i)
+		v.push_back(numeric(*i));
+	return v;
+}
+
+bool numeric_matrix::is_rational() const
+{
+	for (std::vector<cln::cl_N>::const_iterator i=m.begin(); i!=m.end(); ++i)
+		if (!is_rational_entry(*i))
+			return false;
+	return true;
+}
+
+bool numeric_matrix::is_exact() const
+{
+	for (std::vector<cln::cl_N>::const_iterator i=m.begin(); i!=m.end(); ++i)
+		if (!is_exact_entry(*i))
+			return false;
+	return true;
+}
+
+/** Bring the matrix into an upper echelon form, choosing pivots only in the
+ *  first pivot_cols columns (those of the coefficient matrix of a linear
+ *  system, the others being its right hand sides).  The rows are only
+ *  swapped and multiplied by nonzero numbers, so the echelon form describes
+ *  the same linear system.
+ *
+ *  @param pivot_cols number of leading columns to search for pivots
+ *  @param sign is set to 1 if an even number of rows was swapped and to -1
+ *  otherwise
+ *  @param scale is set to the product of the factors the rows were
+ *  multiplied with, such that a square matrix has the determinant
+ *  sign*(product of the diagonal)/scale afterwards
+ *  @return rank of the first pivot_cols columns */
+unsigned numeric_matrix::eliminate(unsigned pivot_cols, int & sign, cln::cl_I & scale)
+{
+	sign = 1;
+	scale = 1;
+	if (is_rational())
+		return fraction_free_eliminate(pivot_cols, sign, scale);
+	return gauss_eliminate(pivot_cols, sign, !is_exact());
+}
+
+/** Entries of a rational matrix, each row multiplied with the lcm of its
+ *  denominators.
+ *
+ *  @param scale is set to the product of these lcms */
+std::vector<cln::cl_I> numeric_matrix::integer_rows(cln::cl_I & scale) const
+{
+	std::vector<cln::cl_I> a(row*col);
+	scale = 1;
+	for (unsigned r=0; r<row; ++r) {
+		cln::cl_I l = 1;
+		for (unsigned c=0; c<col; ++c)
+			l = cln::lcm(l, cln::denominator(cln::the<cln::cl_RA>(m[r*col+c])));
+		for (unsigned c=0; c<col; ++c)
+			a[r*col+c] = cln::the<cln::cl_I>(l * cln::the<cln::cl_RA>(m[r*col+c]));
+		scale = scale * l;
+	}
+	return a;
+}
+
+/** Fraction free elimination of a rational matrix.  Each row is multiplied
+ *  with the lcm of its denominators first, then Bareiss' scheme keeps all
+ *  entries integer and divides exactly by the previous pivot. */
+unsigned numeric_matrix::fraction_free_eliminate(unsigned pivot_cols, int & sign, cln::cl_I & scale)
+{
+	std::vector<cln::cl_I> a = integer_rows(scale);
+
+	cln::cl_I divisor = 1;
+	unsigned r0 = 0;
+	for (unsigned c0=0; c0<pivot_cols && r0<row; ++c0) {
+		unsigned k = r0;
+		while (k<row && cln::zerop(a[k*col+c0]))
+			++k;
+		if (k==row)
+			continue;
+		if (k!=r0) {
+			for (unsigned c=c0; c<col; ++c)
+				std::swap(a[k*col+c], a[r0*col+c]);
+			sign = -sign;
+		}
+		const cln::cl_I & piv = a[r0*col+c0];
+		for (unsigned r=r0+1; r<row; ++r) {
+			const cln::cl_I f = a[r*col+c0];
+			for (unsigned c=c0+1; c<col; ++c)
+				a[r*col+c] = cln::exquo(piv*a[r*col+c] - f*a[r0*col+c], divisor);
+			a[r*col+c0] = 0;
+		}
+		divisor = piv;
+		++r0;
+	}
+
+	for (unsigned i=0; i<row*col; ++i)
+		m[i] = a[i];
+	return r0;
+}
+
+/** Gauss elimination.  With partial_pivoting the entry of largest absolute
+ *  value is chosen as pivot, which keeps floating point errors small,
+ *  otherwise the first nonzero one. */
+unsigned numeric_matrix::gauss_eliminate(unsigned pivot_cols, int & sign, bool partial_pivoting)
+{
+	unsigned r0 = 0;
+	for (unsigned c0=0; c0<pivot_cols && r0<row; ++c0) {
+		unsigned k = row;
+		if (partial_pivoting) {
+			cln::cl_R maxabs = 0;
+			for (unsigned r=r0; r<row; ++r) {
+				const cln::cl_R absr = cln::abs(m[r*col+c0]);
+				if (!cln::zerop(m[r*col+c0]) && (k==row || absr>maxabs)) {
+					k = r;
+					maxabs = absr;
+				}
+			}
+		} else {
+			k = r0;
+			while (k<row && cln::zerop(m[k*col+c0]))
+				++k;
+		}
+		if (k==row)
+			continue;
+		if (k!=r0) {
+			for (unsigned c=c0; c<col; ++c)
+				std::swap(m[k*col+c], m[r0*col+c]);
+			sign = -sign;
+		}
+		const cln::cl_N piv = m[r0*col+c0];
+		for (unsigned r=r0+1; r<row; ++r) {
+			if (cln::zerop(m[r*col+c0]))
+				continue;
+			const cln::cl_N f = m[r*col+c0] / piv;
+			for (unsigned c=c0+1; c<col; ++c)
+				m[r*col+c] = m[r*col+c] - f*m[r0*col+c];
+			m[r*col+c0] = 0;
+		}
+		++r0;
+	}
+	return r0;
+}
+
+/** Solve the linear system after eliminate() found the first n columns to
+ *  be a regular upper triangular n x n matrix.  The remaining columns are
+ *  the right hand sides.
+ *
+ *  @return n x (cols()-n) solution matrix, stored by rows */
+exvector numeric_matrix::back_substitute(unsigned n) const
+{
+	GINAC_ASSERT(row==n);
+	const unsigned p = col - n;
+	std::vector<cln::cl_N> x(n*p);
+	for (unsigned co=0; co<p; ++co) {
+		for (int r=n-1; r>=0; --r) {
+			cln::cl_N e = m[r*col+n+co];
+			for (unsigned c=r+1; c<n; ++c)
+				e = e - m[r*col+c] * x[c*p+co];
+			x[r*p+co] = e / m[r*col+r];
+		}
+	}
+	exvector sol;
+	sol.reserve(n*p);
+	for (std::vector<cln::cl_N>::const_iterator i=x.begin(); i!=x.end(); ++i)
+		sol.push_back(numeric(*i));
+	return sol;
+}
+
+/** Matrix product.  Integer matrices are multiplied by the Strassen-Winograd
+ *  scheme once they are large enough, all others classically; floating
+ *  point entries in particular, where it would lose accuracy. */
+numeric_matrix numeric_matrix::mul(const numeric_matrix & other) const
+{
+	if (col!=other.row)
+		throw (std::logic_error("numeric_matrix::mul(): incompatible matrices"));
+	bool integer = true;
+	for (std::vector<cln::cl_N>::const_iterator i=m.begin(); integer && i!=m.end(); ++i)
+		integer = is_integer_entry(*i);
+	for (std::vector<cln::cl_N>::const_iterator i=other.m.begin(); integer && i!=other.m.end(); ++i)
+		integer = is_integer_entry(*i);
+	if (integer)
+		return strassen_mul(*this, other);
+	numeric_matrix prod(row, other.col);
+	multiply_add(*this, other, prod, 0, row, 0, col, 0, other.col);
+	return prod;
+}
+
+/** Characteristic polynomial det(lambda*1 - M) of a square matrix M.  The
+ *  matrix is first brought into upper Hessenberg form by similarity
+ *  transformations (elimination below the subdiagonal, undone in the
+ *  columns), whose characteristic polynomial then follows from a recurrence
+ *  over its leading principal submatrices.  This costs O(n^3) operations.
+ *  Floating point matrices choose the largest pivot in each column.
+ *
+ *  @return coefficients, lowest degree first */
+std::vector<cln::cl_N> numeric_matrix::charpoly() const
+{
+	if (row!=col)
+		throw (std::logic_error("numeric_matrix::charpoly(): matrix not square"));
+	const unsigned n = row;
+	const bool partial_pivoting = !is_exact();
+	numeric_matrix h(*this);
+
+	for (unsigned j=0; j+2<n; ++j) {
+		unsigned k = n;
+		cln::cl_R maxabs = 0;
+		for (unsigned i=j+1; i<n; ++i) {
+			if (cln::zerop(h(i,j)))
+				continue;
+			if (!partial_pivoting) {
+				k = i;
+				break;
+			}
+			const cln::cl_R absi = cln::abs(h(i,j));
+			if (k==n || absi>maxabs) {
+				k = i;
+				maxabs = absi;
+			}
+		}
+		if (k==n)
+			continue;
+		if (k!=j+1) {
+			for (unsigned c=0; c<n; ++c)
+				std::swap(h(k,c), h(j+1,c));
+			for (unsigned r=0; r<n; ++r)
+				std::swap(h(r,k), h(r,j+1));
+		}
+		for (unsigned i=j+2; i<n; ++i) {
+			if (cln::zerop(h(i,j)))
+				continue;
+			const cln::cl_N u = h(i,j) / h(j+1,j);
+			for (unsigned c=0; c<n; ++c)
+				h(i,c) = h(i,c) - u*h(j+1,c);
+			h(i,j) = 0;
+			for (unsigned r=0; r<n; ++r)
+				h(r,j+1) = h(r,j+1) + u*h(r,i);
+		}
+	}
+
+	// p[k] is the characteristic polynomial of the leading k x k submatrix
+	std::vector<std::vector<cln::cl_N> > p(n+1);
+	p[0].push_back(1);
+	for (unsigned k=1; k<=n; ++k) {
+		std::vector<cln::cl_N> & q = p[k];
+		q.push_back(0);
+		q.insert(q.end(), p[k-1].begin(), p[k-1].end());
+		for (unsigned d=0; d<p[k-1].size(); ++d)
+			q[d] = q[d] - h(k-1,k-1) * p[k-1][d];
+		cln::cl_N t = 1;
+		for (unsigned i=k-1; i>0; --i) {
+			t = t * h(i,i-1);
+			if (cln::zerop(t))
+				break;
+			const cln::cl_N f = h(i-1,k-1) * t;
+			for (unsigned d=0; d<p[i-1].size(); ++d)
+				q[d] = q[d] - f * p[i-1][d];
+		}
+	}
+	return p[n];
+}
+
+/** Solve the linear system whose coefficients are the first n columns and
+ *  whose right hand sides are the remaining columns, if it has a unique
+ *  solution.  Large rational systems are solved by Cramer's rule modulo
+ *  word sized primes, which are then combined by Chinese remaindering.
+ *
+ *  @param sol is set to the n x (cols()-n) solution matrix, stored by rows
+ *  @param processes  number of worker processes computing the images
+ *    modulo the primes, 0 meaning one per processor
+ *  @return false if the system is not square or not regular */
+bool numeric_matrix::solve(unsigned n, exvector & sol, unsigned processes) const
+{
+	if (row!=n || col<n)
+		return false;
+	if (n>=modular_min_dim && is_rational())
+		return modular_solve(n, sol, processes);
+	numeric_matrix tmp(*this);
+	int sign;
+	cln::cl_I scale;
+	if (tmp.eliminate(n, sign, scale) < n)
+		return false;
+	sol = tmp.back_substitute(n);
+	return true;
+}
+
+/** Multimodular solution of a regular rational system.  With D the
+ *  determinant of the coefficients, D*x are integers, namely determinants
+ *  where one column is replaced by the right hand side (Cramer's rule), so
+ *  their images mod p suffice once the product of the primes exceeds twice
+ *  Hadamard's bound for these determinants. */
+bool numeric_matrix::modular_solve(unsigned n, exvector & sol, unsigned processes) const
+{
+	const unsigned p = col - n;
+	cln::cl_I scale;
+	const std::vector<cln::cl_I> a = integer_rows(scale);
+
+	std::vector<cln::cl_I> coeff(n*n);
+	for (unsigned r=0; r<n; ++r)
+		for (unsigned c=0; c<n; ++c)
+			coeff[r*n+c] = a[r*col+c];
+	const cln::cl_I det = modular_determinant(coeff, n, processes);
+	if (cln::zerop(det))
+		return false;
+
+	// bound every column by the largest of its own norm and those of the
+	// right hand sides
+	cln::cl_I rhs_squared = 0;
+	for (unsigned c=n; c<col; ++c)
+		rhs_squared = std::max(rhs_squared, norm_squared(a, c, col, n));
+	cln::cl_I bound_squared = 1;
+	for (unsigned c=0; c<n; ++c)
+		bound_squared = bound_squared * std::max(rhs_squared, norm_squared(a, c, col, n));
+
+	const std::vector<long> primes = choose_primes(bound_squared, det, "numeric_matrix::modular_solve()");
+	modular_images_jobs jobs(a, n, col, det, primes);
+	const std::vector<cln::cl_I> values = combine_images(jobs, primes, processes);
+
+	sol.clear();
+	sol.reserve(n*p);
+	for (unsigned i=0; i<n*p; ++i)
+		sol.push_back(numeric(values[i] / det));
+	return true;
+}
+
+/** Determinant of a square matrix.  Large rational matrices are scaled to
+ *  integers, whose determinant is computed modulo word sized primes, in
+ *  worker processes if more than one process is asked for.
+ *
+ *  @param processes  number of worker processes, 0 meaning one per processor */
+cln::cl_N numeric_matrix::determinant(unsigned processes) const
+{
+	if (row!=col)
+		throw (std::logic_error("numeric_matrix::determinant(): matrix not square"));
+	const bool rational = is_rational();
+	if (rational && row>=modular_min_dim) {
+		cln::cl_I scale;
+		const std::vector<cln::cl_I> a = integer_rows(scale);
+		return modular_determinant(a, row, processes) / scale;
+	}
+	numeric_matrix tmp(*this);
+	int sign;
+	cln::cl_I scale;
+	if (tmp.eliminate(col, sign, scale) < row)
+		return 0;
+	if (rational)
+		return sign * cln::the<cln::cl_I>(tmp.m[row*col-1]) / scale;
+	cln::cl_N det = sign;
+	for (unsigned d=0; d<row; ++d)
+		det = det * tmp.m[d*col+d];
+	return det;
+}
+
+unsigned numeric_matrix::rank() const
+{
+	numeric_matrix tmp(*this);
+	int sign;
+	cln::cl_I scale;
+	return tmp.eliminate(col, sign, scale);
+}
+
+} // namespace GiNaC
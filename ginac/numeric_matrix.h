@@ -0,0 +1,84 @@
+/** @file numeric_matrix.h
+ *
+ *  Interface to the dense matrices of numbers behind the numeric fast paths
+ *  of class matrix. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef GINAC_NUMERIC_MATRIX_H
+#define GINAC_NUMERIC_MATRIX_H
+
+#include "ex.h"
+
+#include <cln/complex.h>
+#include <cln/integer.h>
+#include <vector>
+
+namespace GiNaC {
+
+/** Dense matrix of CLN numbers.  Class matrix hands purely numeric matrices
+ *  over to this class, which eliminates them without creating a numeric
+ *  object (and the ex around it) for every intermediate value.  The kernel
+ *  depends on the entries:
+ *
+ *  - rational matrices are scaled to integer rows and eliminated fraction
+ *    free (Bareiss), so no gcd is ever computed; large ones are rather
+ *    handled modulo word sized primes and Chinese remaindering,
+ *  - matrices with a floating point entry are eliminated at the current
+ *    precision with partial pivoting (the largest entry of the column),
+ *  - other exact matrices (complex rationals) by Gauss elimination. */
+class numeric_matrix
+{
+public:
+	numeric_matrix(unsigned r, unsigned c);
+	numeric_matrix(unsigned r, unsigned c, const exvector & m2);
+
+	/** Check whether all the entries are numbers. */
+	static bool is_numeric(const exvector & m2);
+
+	unsigned rows() const { return row; }
+	unsigned cols() const { return col; }
+	const cln::cl_N & operator()(unsigned ro, unsigned co) const { return m[ro*col+co]; }
+	cln::cl_N & operator()(unsigned ro, unsigned co) { return m[ro*col+co]; }
+	exvector to_exvector() const;
+
+	numeric_matrix mul(const numeric_matrix & other) const;
+	unsigned eliminate(unsigned pivot_cols, int & sign, cln::cl_I & scale);
+	exvector back_substitute(unsigned n) const;
+	bool solve(unsigned n, exvector & sol, unsigned processes = 1) const;
+	cln::cl_N determinant(unsigned processes = 1) const;
+	std::vector<cln::cl_N> charpoly() const;
+	unsigned rank() const;
+
+private:
+	bool is_rational() const;
+	bool is_exact() const;
+	std::vector<cln::cl_I> integer_rows(cln::cl_I & scale) const;
+	bool modular_solve(unsigned n, exvector & sol, unsigned processes) const;
+	unsigned fraction_free_eliminate(unsigned pivot_cols, int & sign, cln::cl_I & scale);
+	unsigned gauss_eliminate(unsigned pivot_cols, int & sign, bool partial_pivoting);
+
+	unsigned row;                ///< number of rows
+	unsigned col;                ///< number of columns
+	std::vector<cln::cl_N> m;    ///< entries, stored by rows
+};
+
+} // namespace GiNaC
+
+#endif // ndef GINAC_NUMERIC_MATRIX_H
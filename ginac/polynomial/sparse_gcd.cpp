@@ -0,0 +1,729 @@
+/** @file sparse_gcd.cpp
+ *
+ *  Sparse modular GCD of multivariate polynomials (Zippel's algorithm). */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "sparse_gcd.h"
+#include "add.h"
+#include "mul.h"
+#include "normal.h"
+#include "numeric.h"
+#include "operators.h"
+#include "power.h"
+#include "primes_factory.h"
+#include "smod_helpers.h"
+
+#include <cln/integer.h>
+#include <cln/random.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace GiNaC {
+
+namespace {
+
+/*
+ *  Polynomials in packed representation: the exponents of all variables of
+ *  a term are stored in the bit fields of one machine word, the main
+ *  variable in the highest bits.  Sorting the terms by decreasing words
+ *  thus sorts them lexicographically, with the main variable first.
+ */
+
+typedef unsigned long long monomial;
+
+/** Polynomial with coefficients in Z_p, terms sorted by decreasing monomials. */
+typedef std::vector<std::pair<monomial, long> > mod_poly;
+
+/** Polynomial with integer coefficients, terms sorted by decreasing monomials. */
+typedef std::vector<std::pair<monomial, cln::cl_I> > int_poly;
+
+/** Dense univariate polynomial with coefficients in Z_p, lowest degree first. */
+typedef std::vector<long> dense_poly;
+
+/** Positions of the exponents of the variables in a monomial. */
+struct packing {
+	std::vector<unsigned> shift;
+	std::vector<monomial> mask;
+
+	unsigned exponent(monomial m, unsigned v) const
+	{
+		return unsigned((m >> shift[v]) & mask[v]);
+	}
+	monomial clear(monomial m, unsigned v) const
+	{
+		return m & ~(mask[v] << shift[v]);
+	}
+	monomial power(unsigned v, unsigned e) const
+	{
+		return monomial(e) << shift[v];
+	}
+};
+
+/** Choose the bit fields for the given maximal exponents.
+ *
+ *  @return false if they do not fit into one word */
+bool make_packing(const std::vector<unsigned>& maxdeg, packing& pk)
+{
+	const unsigned word_bits = 8*sizeof(monomial);
+	unsigned sh = word_bits;
+	pk.shift.resize(maxdeg.size());
+	pk.mask.resize(maxdeg.size());
+	for (unsigned v=0; v<maxdeg.size(); ++v) {
+		unsigned bits = 1;
+		while (bits < word_bits && (monomial(1) << bits) <= maxdeg[v])
+			++bits;
+		if (bits > sh)
+			return false;
+		sh -= bits;
+		pk.shift[v] = sh;
+		pk.mask[v] = (monomial(1) << bits) - 1;
+	}
+	return true;
+}
+
+/** Outcome of the computation of a modular image. */
+enum image_status {
+	image_ok,          ///< the image was computed
+	image_bad_point,   ///< the evaluation point was unlucky, choose another one
+	image_restart,     ///< the skeleton from a previous image is wrong
+	image_failed       ///< no image after several attempts
+};
+
+/** Attempts to find good evaluation points before giving up. */
+const unsigned max_attempts = 8;
+
+/** Primes to try over Z before giving up. */
+const unsigned max_primes = 32;
+
+inline long add_mod(long a, long b, long p)
+{
+	const long s = a + b;
+	return s >= p ? s - p : s;
+}
+
+inline long sub_mod(long a, long b, long p)
+{
+	const long s = a - b;
+	return s < 0 ? s + p : s;
+}
+
+inline long mul_mod(long a, long b, long p)
+{
+	return long((unsigned long long)a * (unsigned long long)b % (unsigned long long)p);
+}
+
+long pow_mod(long a, unsigned e, long p)
+{
+	long r = 1;
+	while (e) {
+		if (e & 1)
+			r = mul_mod(r, a, p);
+		a = mul_mod(a, a, p);
+		e >>= 1;
+	}
+	return r;
+}
+
+/** Inverse of a nonzero a modulo the prime p. */
+inline long recip_mod(long a, long p)
+{
+	return pow_mod(a, unsigned(p - 2), p);
+}
+
+/** Random nonzero element of Z_p. */
+long random_mod(long p)
+{
+	return 1 + cln::cl_I_to_long(cln::random_I(cln::cl_I(p - 1)));
+}
+
+inline bool term_greater(const std::pair<monomial, long>& a, const std::pair<monomial, long>& b)
+{
+	return a.first > b.first;
+}
+
+inline bool int_term_greater(const std::pair<monomial, cln::cl_I>& a, const std::pair<monomial, cln::cl_I>& b)
+{
+	return a.first > b.first;
+}
+
+/** Sort the terms and combine those with equal monomials. */
+void canonicalize(mod_poly& a, long p)
+{
+	std::sort(a.begin(), a.end(), term_greater);
+	size_t out = 0;
+	for (size_t i=0; i<a.size(); ) {
+		const monomial m = a[i].first;
+		long c = 0;
+		for (; i<a.size() && a[i].first==m; ++i)
+			c = add_mod(c, a[i].second, p);
+		if (c != 0)
+			a[out++] = std::make_pair(m, c);
+	}
+	a.resize(out);
+}
+
+/** Degree of a in the variable v, -1 for the zero polynomial. */
+int degree(const mod_poly& a, const packing& pk, unsigned v)
+{
+	int d = -1;
+	for (mod_poly::const_iterator i=a.begin(); i!=a.end(); ++i)
+		d = std::max(d, int(pk.exponent(i->first, v)));
+	return d;
+}
+
+/** Substitute value for the variable v. */
+mod_poly evaluate(const mod_poly& a, const packing& pk, unsigned v, long value, long p)
+{
+	mod_poly r;
+	r.reserve(a.size());
+	for (mod_poly::const_iterator i=a.begin(); i!=a.end(); ++i)
+		r.push_back(std::make_pair(pk.clear(i->first, v),
+		                           mul_mod(i->second, pow_mod(value, pk.exponent(i->first, v), p), p)));
+	canonicalize(r, p);
+	return r;
+}
+
+/** Substitute values[v-1] for the variables v = 1, ..., values.size() of a
+ *  polynomial in these and the main variable. */
+dense_poly to_univariate(const mod_poly& a, const packing& pk, const std::vector<long>& values, long p)
+{
+	dense_poly u(degree(a, pk, 0) + 1, 0);
+	for (mod_poly::const_iterator i=a.begin(); i!=a.end(); ++i) {
+		long c = i->second;
+		for (unsigned v=1; v<=values.size(); ++v) {
+			const unsigned e = pk.exponent(i->first, v);
+			if (e != 0)
+				c = mul_mod(c, pow_mod(values[v-1], e, p), p);
+		}
+		const unsigned d = pk.exponent(i->first, 0);
+		u[d] = add_mod(u[d], c, p);
+	}
+	while (!u.empty() && u.back() == 0)
+		u.pop_back();
+	return u;
+}
+
+/** Monic GCD of two nonzero univariate polynomials, by Euclid's algorithm. */
+dense_poly monic_gcd(dense_poly a, dense_poly b, long p)
+{
+	while (!b.empty()) {
+		const long inv = recip_mod(b.back(), p);
+		while (a.size() >= b.size()) {
+			const long f = mul_mod(a.back(), inv, p);
+			const size_t sh = a.size() - b.size();
+			for (size_t i=0; i<b.size(); ++i)
+				a[sh+i] = sub_mod(a[sh+i], mul_mod(f, b[i], p), p);
+			while (!a.empty() && a.back() == 0)
+				a.pop_back();
+		}
+		a.swap(b);
+	}
+	const long inv = recip_mod(a.back(), p);
+	for (size_t i=0; i<a.size(); ++i)
+		a[i] = mul_mod(a[i], inv, p);
+	return a;
+}
+
+/** Solve the transposed Vandermonde system sum_m x[m]*k[m]^s = y[s],
+ *  s = 0, ..., n-1, for distinct nodes k in O(n^2) operations.  The
+ *  solution is x[m] = sum_s q_m[s]*y[s] / q_m(k[m]) with the polynomial
+ *  q_m = prod_{i != m} (z - k[i]). */
+std::vector<long> solve_vandermonde(const std::vector<long>& k, const std::vector<long>& y, long p)
+{
+	const size_t n = k.size();
+	std::vector<long> master(1, 1);
+	for (size_t m=0; m<n; ++m) {
+		std::vector<long> next(master.size() + 1, 0);
+		for (size_t i=0; i<master.size(); ++i) {
+			next[i+1] = add_mod(next[i+1], master[i], p);
+			next[i] = sub_mod(next[i], mul_mod(k[m], master[i], p), p);
+		}
+		master.swap(next);
+	}
+	std::vector<long> x(n), q(n);
+	for (size_t m=0; m<n; ++m) {
+		// q = master/(z - k[m]) by synthetic division
+		long b = master[n];
+		for (size_t i=n; i-->0; ) {
+			q[i] = b;
+			b = add_mod(master[i], mul_mod(b, k[m], p), p);
+		}
+		long num = 0, den = 0;
+		for (size_t s=0; s<n; ++s)
+			num = add_mod(num, mul_mod(q[s], y[s], p), p);
+		for (size_t s=n; s-->0; )
+			den = add_mod(mul_mod(den, k[m], p), q[s], p);
+		x[m] = mul_mod(num, recip_mod(den, p), p);
+	}
+	return x;
+}
+
+/** Coefficients, lowest degree first, of the polynomial of degree less
+ *  than n which takes the values y at the points x, by Newton's divided
+ *  differences. */
+std::vector<long> newton_interpolate(const std::vector<long>& x, std::vector<long> y, long p)
+{
+	const size_t n = x.size();
+	for (size_t j=1; j<n; ++j)
+		for (size_t i=n-1; i>=j; --i)
+			y[i] = mul_mod(sub_mod(y[i], y[i-1], p), recip_mod(sub_mod(x[i], x[i-j], p), p), p);
+	std::vector<long> c(n, 0);
+	for (size_t i=n; i-->0; ) {
+		// c = c*(z - x[i]) + y[i]
+		for (size_t e=n-1; e>0; --e)
+			c[e] = sub_mod(c[e-1], mul_mod(x[i], c[e], p), p);
+		c[0] = sub_mod(y[i], mul_mod(x[i], c[0], p), p);
+	}
+	return c;
+}
+
+/** Univariate image: the monic GCD of A and B times the value of gamma.
+ *  The evaluation point is bad if it lowers the degree of A or B.  The
+ *  image is in g, lowest degree first. */
+image_status univariate_image(const mod_poly& A, const mod_poly& B, const mod_poly& gamma,
+                              const packing& pk, const std::vector<long>& values,
+                              int da, int db, long p, dense_poly& g)
+{
+	const dense_poly a = to_univariate(A, pk, values, p);
+	const dense_poly b = to_univariate(B, pk, values, p);
+	if (int(a.size()) != da + 1 || int(b.size()) != db + 1)
+		return image_bad_point;
+	const dense_poly gv = to_univariate(gamma, pk, values, p);
+	if (gv.empty())
+		return image_bad_point;
+	g = monic_gcd(a, b, p);
+	for (size_t i=0; i<g.size(); ++i)
+		g[i] = mul_mod(g[i], gv[0], p);
+	return image_ok;
+}
+
+/** Image of the GCD in the variables 0, ..., l-1 by sparse interpolation,
+ *  assuming it has the terms of the skeleton S.  The coefficient of each
+ *  power of the main variable is a linear combination of the monomials of
+ *  S with that power, which is determined by univariate images at the
+ *  powers r^1, r^2, ... of a random point r: this is a transposed
+ *  Vandermonde system.
+ *
+ *  @param coeffs on return, the coefficients of the terms of S */
+image_status sparse_image(const mod_poly& A, const mod_poly& B, const mod_poly& gamma,
+                          const mod_poly& S, unsigned l, const packing& pk,
+                          int da, int db, long p, std::vector<long>& coeffs)
+{
+	const int D = degree(S, pk, 0);
+	coeffs.assign(S.size(), 0);
+
+	if (l == 1) {
+		dense_poly g;
+		const image_status st = univariate_image(A, B, gamma, pk, std::vector<long>(), da, db, p, g);
+		if (st != image_ok)
+			return st;
+		const int dg = int(g.size()) - 1;
+		if (dg > D)
+			return image_bad_point;
+		if (dg < D)
+			return image_restart;
+		// every nonzero coefficient must belong to a term of S
+		size_t found = 0, nonzero = 0;
+		for (size_t t=0; t<S.size(); ++t) {
+			coeffs[t] = g[pk.exponent(S[t].first, 0)];
+			if (coeffs[t] != 0)
+				++found;
+		}
+		for (size_t d=0; d<g.size(); ++d)
+			if (g[d] != 0)
+				++nonzero;
+		if (found != nonzero)
+			return image_restart;
+		return image_ok;
+	}
+
+	// the terms of S grouped by powers of the main variable, in
+	// decreasing order
+	std::vector<unsigned> group_deg;
+	std::vector<size_t> group_begin;
+	for (size_t t=0; t<S.size(); ++t) {
+		const unsigned d = pk.exponent(S[t].first, 0);
+		if (group_deg.empty() || group_deg.back() != d) {
+			group_deg.push_back(d);
+			group_begin.push_back(t);
+		}
+	}
+	group_begin.push_back(S.size());
+	size_t n = 0;
+	for (size_t i=0; i+1<group_begin.size(); ++i)
+		n = std::max(n, group_begin[i+1] - group_begin[i]);
+	std::vector<bool> in_skeleton(D + 1, false);
+	for (size_t i=0; i<group_deg.size(); ++i)
+		in_skeleton[group_deg[i]] = true;
+
+	for (unsigned attempt=0; attempt<max_attempts; ++attempt) {
+		std::vector<long> r(l - 1);
+		for (unsigned v=0; v<l-1; ++v)
+			r[v] = random_mod(p);
+
+		// the values of the monomials at r, distinct within each group
+		std::vector<long> nodes(S.size());
+		bool distinct = true;
+		for (size_t i=0; i+1<group_begin.size() && distinct; ++i) {
+			for (size_t t=group_begin[i]; t<group_begin[i+1]; ++t) {
+				long k = 1;
+				for (unsigned v=1; v<l; ++v)
+					k = mul_mod(k, pow_mod(r[v-1], pk.exponent(S[t].first, v), p), p);
+				nodes[t] = k;
+			}
+			std::vector<long> sorted(nodes.begin() + group_begin[i], nodes.begin() + group_begin[i+1]);
+			std::sort(sorted.begin(), sorted.end());
+			distinct = std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end();
+		}
+		if (!distinct)
+			continue;
+
+		std::vector<dense_poly> images(n);
+		std::vector<long> point(r);
+		bool bad = false;
+		for (size_t s=0; s<n && !bad; ++s) {
+			const image_status st = univariate_image(A, B, gamma, pk, point, da, db, p, images[s]);
+			const int dg = int(images[s].size()) - 1;
+			if (st != image_ok || dg > D) {
+				bad = true;
+				break;
+			}
+			if (dg < D)
+				return image_restart;
+			for (int d=0; d<=D; ++d)
+				if (images[s][d] != 0 && !in_skeleton[d])
+					return image_restart;
+			for (unsigned v=0; v<l-1; ++v)
+				point[v] = mul_mod(point[v], r[v], p);
+		}
+		if (bad)
+			continue;
+
+		for (size_t i=0; i+1<group_begin.size(); ++i) {
+			const size_t b = group_begin[i], ni = group_begin[i+1] - b;
+			const std::vector<long> k(nodes.begin() + b, nodes.begin() + b + ni);
+			std::vector<long> y(n);
+			for (size_t s=0; s<n; ++s)
+				y[s] = images[s][group_deg[i]];
+			const std::vector<long> x = solve_vandermonde(k, std::vector<long>(y.begin(), y.begin() + ni), p);
+			for (size_t t=0; t<ni; ++t)
+				coeffs[b+t] = mul_mod(x[t], recip_mod(k[t], p), p);
+			// the remaining images must agree with the solution
+			for (size_t s=ni; s<n; ++s) {
+				long sum = 0;
+				for (size_t t=0; t<ni; ++t)
+					sum = add_mod(sum, mul_mod(coeffs[b+t], pow_mod(k[t], unsigned(s + 1), p), p), p);
+				if (sum != y[s])
+					return image_restart;
+			}
+		}
+		return image_ok;
+	}
+	return image_failed;
+}
+
+/** Image of gamma*G/lcoeff(G) modulo p in the variables 0, ..., j-1, where
+ *  G is the GCD of A and B and gamma the GCD of their leading coefficients
+ *  in the main variable.  The last variable is interpolated densely from
+ *  images at random values: the first one is computed recursively and
+ *  gives the skeleton for the others, which are found by sparse
+ *  interpolation. */
+image_status zippel_image(const mod_poly& A, const mod_poly& B, const mod_poly& gamma,
+                          unsigned j, const packing& pk, int da, int db, long p, mod_poly& H)
+{
+	if (j == 1) {
+		dense_poly g;
+		const image_status st = univariate_image(A, B, gamma, pk, std::vector<long>(), da, db, p, g);
+		if (st != image_ok)
+			return st;
+		H.clear();
+		for (size_t d=g.size(); d-->0; )
+			if (g[d] != 0)
+				H.push_back(std::make_pair(pk.power(0, unsigned(d)), g[d]));
+		return image_ok;
+	}
+
+	const unsigned v = j - 1;
+	const int bound = std::min(degree(A, pk, v), degree(B, pk, v)) + std::max(degree(gamma, pk, v), 0);
+	for (unsigned attempt=0; attempt<max_attempts; ++attempt) {
+		const long x0 = random_mod(p);
+		mod_poly S;
+		image_status st = zippel_image(evaluate(A, pk, v, x0, p), evaluate(B, pk, v, x0, p),
+		                               evaluate(gamma, pk, v, x0, p), j - 1, pk, da, db, p, S);
+		if (st == image_bad_point)
+			continue;
+		if (st != image_ok)
+			return st;
+
+		std::vector<long> xs(1, x0);
+		std::vector<std::vector<long> > values(1);
+		for (size_t t=0; t<S.size(); ++t)
+			values[0].push_back(S[t].second);
+		bool restart = false;
+		for (unsigned tries=0; int(xs.size())<=bound && tries<3*unsigned(bound)+max_attempts; ++tries) {
+			const long x = random_mod(p);
+			if (std::find(xs.begin(), xs.end(), x) != xs.end())
+				continue;
+			std::vector<long> coeffs;
+			st = sparse_image(evaluate(A, pk, v, x, p), evaluate(B, pk, v, x, p),
+			                  evaluate(gamma, pk, v, x, p), S, j - 1, pk, da, db, p, coeffs);
+			if (st == image_restart) {
+				restart = true;
+				break;
+			}
+			if (st != image_ok)
+				continue;
+			xs.push_back(x);
+			values.push_back(coeffs);
+		}
+		if (restart || int(xs.size()) <= bound)
+			continue;
+
+		H.clear();
+		for (size_t t=0; t<S.size(); ++t) {
+			std::vector<long> y(xs.size());
+			for (size_t i=0; i<xs.size(); ++i)
+				y[i] = values[i][t];
+			const std::vector<long> c = newton_interpolate(xs, y, p);
+			for (size_t e=0; e<c.size(); ++e)
+				if (c[e] != 0)
+					H.push_back(std::make_pair(S[t].first | pk.power(v, unsigned(e)), c[e]));
+		}
+		std::sort(H.begin(), H.end(), term_greater);
+		return image_ok;
+	}
+	return image_failed;
+}
+
+/** Convert a factor of a term of an expanded polynomial. */
+bool factor_to_packed(const ex& f, const exvector& vars, const packing& pk, monomial& m, cln::cl_I& c)
+{
+	if (is_exactly_a<numeric>(f)) {
+		if (!f.info(info_flags::integer))
+			return false;
+		c = c * to_cl_I(f);
+		return true;
+	}
+	ex base = f;
+	unsigned e = 1;
+	if (is_exactly_a<power>(f)) {
+		if (!f.op(1).info(info_flags::posint))
+			return false;
+		base = f.op(0);
+		e = ex_to<numeric>(f.op(1)).to_int();
+	}
+	for (unsigned v=0; v<vars.size(); ++v) {
+		if (vars[v].is_equal(base)) {
+			m += pk.power(v, e);
+			return true;
+		}
+	}
+	return false;
+}
+
+/** Convert an expanded polynomial with integer coefficients. */
+bool to_packed(const ex& e, const exvector& vars, const packing& pk, int_poly& a)
+{
+	a.clear();
+	const size_t nterms = is_exactly_a<add>(e) ? e.nops() : 1;
+	for (size_t i=0; i<nterms; ++i) {
+		const ex t = is_exactly_a<add>(e) ? e.op(i) : e;
+		monomial m = 0;
+		cln::cl_I c = 1;
+		if (is_exactly_a<mul>(t)) {
+			for (size_t k=0; k<t.nops(); ++k)
+				if (!factor_to_packed(t.op(k), vars, pk, m, c))
+					return false;
+		} else if (!factor_to_packed(t, vars, pk, m, c))
+			return false;
+		a.push_back(std::make_pair(m, c));
+	}
+	std::sort(a.begin(), a.end(), int_term_greater);
+	return true;
+}
+
+ex from_packed(const std::vector<monomial>& monos, const std::vector<cln::cl_I>& coeffs,
+               const exvector& vars, const packing& pk)
+{
+	exvector terms;
+	terms.reserve(monos.size());
+	for (size_t t=0; t<monos.size(); ++t) {
+		exvector factors;
+		factors.push_back(numeric(coeffs[t]));
+		for (unsigned v=0; v<vars.size(); ++v) {
+			const unsigned e = pk.exponent(monos[t], v);
+			if (e != 0)
+				factors.push_back(power(vars[v], e));
+		}
+		terms.push_back((new mul(factors))->setflag(status_flags::dynallocated));
+	}
+	return (new add(terms))->setflag(status_flags::dynallocated);
+}
+
+mod_poly reduce(const int_poly& a, long p)
+{
+	mod_poly r;
+	r.reserve(a.size());
+	for (int_poly::const_iterator i=a.begin(); i!=a.end(); ++i) {
+		const long c = cln::cl_I_to_long(cln::mod(i->second, p));
+		if (c != 0)
+			r.push_back(std::make_pair(i->first, c));
+	}
+	return r;
+}
+
+/** GCD of two polynomials with integer coefficients which are primitive
+ *  with respect to the main variable vars[0].  Modular images of
+ *  H = gamma*G/lcoeff(G) are combined by Chinese remaindering, where
+ *  gamma is the GCD of the leading coefficients: the first one by Zippel's
+ *  algorithm, the others by sparse interpolation with its terms.  As soon
+ *  as the integer coefficients of H do not change with another prime any
+ *  more, the primitive part of H is the GCD if it divides A and B.
+ *
+ *  @param ca, cb on success, the cofactors A/g and B/g */
+bool sparse_gcd_primitive(ex& g, const ex& A, const ex& B, const exvector& vars, ex& ca, ex& cb)
+{
+	const ex& x = vars[0];
+	const ex gamma = gcd(A.lcoeff(x), B.lcoeff(x), 0, 0, false);
+
+	std::vector<unsigned> maxdeg(vars.size());
+	for (unsigned v=0; v<vars.size(); ++v)
+		maxdeg[v] = std::max(A.degree(vars[v]), B.degree(vars[v])) + gamma.degree(vars[v]);
+	packing pk;
+	if (!make_packing(maxdeg, pk))
+		return false;
+	int_poly Az, Bz, gz;
+	if (!to_packed(A, vars, pk, Az) || !to_packed(B, vars, pk, Bz) || !to_packed(gamma.expand(), vars, pk, gz))
+		return false;
+	const int da = A.degree(x), db = B.degree(x);
+
+	primes_factory primes;
+	const cln::cl_I lc = Az[0].second * Bz[0].second;
+	mod_poly S;
+	std::vector<monomial> monos;
+	std::vector<cln::cl_I> coeffs;
+	cln::cl_I modulus;
+	for (unsigned n=0; n<max_primes; ++n) {
+		long p;
+		if (!primes(p, lc))
+			return false;
+		const mod_poly Ap = reduce(Az, p), Bp = reduce(Bz, p), gp = reduce(gz, p);
+		const bool fresh = S.empty();
+		if (fresh) {
+			if (zippel_image(Ap, Bp, gp, vars.size(), pk, da, db, p, S) != image_ok) {
+				S.clear();
+				continue;
+			}
+			monos.clear();
+			coeffs.clear();
+			for (mod_poly::const_iterator t=S.begin(); t!=S.end(); ++t) {
+				monos.push_back(t->first);
+				coeffs.push_back(smod(cln::cl_I(t->second), p));
+			}
+			modulus = p;
+		} else {
+			std::vector<long> image;
+			const image_status st = sparse_image(Ap, Bp, gp, S, vars.size(), pk, da, db, p, image);
+			if (st == image_restart) {
+				S.clear();
+				continue;
+			}
+			if (st != image_ok)
+				continue;
+			// Chinese remaindering in the symmetric representation
+			const long minv = recip_mod(cln::cl_I_to_long(cln::mod(modulus, p)), p);
+			const cln::cl_I new_modulus = modulus * p;
+			const cln::cl_I half = new_modulus >> 1;
+			bool changed = false;
+			for (size_t t=0; t<coeffs.size(); ++t) {
+				const long cp = cln::cl_I_to_long(cln::mod(coeffs[t], p));
+				const long f = mul_mod(sub_mod(image[t], cp, p), minv, p);
+				if (f == 0)
+					continue;
+				cln::cl_I c = coeffs[t] + modulus * f;
+				if (c > half)
+					c = c - new_modulus;
+				coeffs[t] = c;
+				changed = true;
+			}
+			modulus = new_modulus;
+			if (changed)
+				continue;
+		}
+
+		const ex G = from_packed(monos, coeffs, vars, pk).primpart(x);
+		if (divide(A, G, ca, false) && divide(B, G, cb, false)) {
+			g = G;
+			return true;
+		}
+		// The coefficients of a new skeleton may still need more primes,
+		// but once they are stable the skeleton itself lacks terms (their
+		// coefficients vanished at the evaluation point or modulo p), and
+		// no further prime can repair it
+		if (!fresh) {
+			S.clear();
+			monos.clear();
+			coeffs.clear();
+		}
+	}
+	return false;
+}
+
+} // anonymous namespace
+
+/** Compute the GCD of multivariate polynomials by Zippel's sparse modular
+ *  algorithm.  Its cost grows with the number of terms of the GCD rather
+ *  than with the number of terms of a dense polynomial of the same degrees,
+ *  so it suits sparse polynomials in many variables.  The terms are kept
+ *  in packed form, with the exponents in one machine word, and the images
+ *  are computed modulo word sized primes.  The GCD of the contents with
+ *  respect to the main variable is computed separately.
+ *
+ *  @param g on success, the GCD
+ *  @param A, B expanded polynomials with rational coefficients
+ *  @param vars their variables, the main variable last, which must occur in
+ *  both polynomials
+ *  @param ca, cb pointers to expressions that receive the cofactors, or 0
+ *  @return false if the exponents do not fit into one word or no image
+ *  could be found, which leaves the GCD to the other methods */
+bool sparse_gcd(ex& g, const ex& A, const ex& B, const exvector& vars, ex* ca, ex* cb)
+{
+	const ex& x = vars.back();
+	ex ua, conta, ppa, ub, contb, ppb;
+	A.unitcontprim(x, ua, conta, ppa);
+	B.unitcontprim(x, ub, contb, ppb);
+
+	ex gp, qa, qb;
+	const exvector order(vars.rbegin(), vars.rend());
+	if (!sparse_gcd_primitive(gp, ppa, ppb, order, qa, qb))
+		return false;
+
+	ex cofa, cofb;
+	const ex c = gcd(conta, contb, &cofa, &cofb, false);
+	g = (c * gp).expand();
+	if (ca)
+		*ca = (ua * cofa * qa).expand();
+	if (cb)
+		*cb = (ub * cofb * qb).expand();
+	return true;
+}
+
+} // namespace GiNaC
@@ -0,0 +1,35 @@
+/** @file sparse_gcd.h
+ *
+ *  Interface to the sparse modular GCD of multivariate polynomials. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef GINAC_SPARSE_GCD_H
+#define GINAC_SPARSE_GCD_H
+
+#include "ex.h"
+
+namespace GiNaC {
+
+extern bool sparse_gcd(ex& g, const ex& A, const ex& B, const exvector& vars,
+                       ex* ca = 0, ex* cb = 0);
+
+} // namespace GiNaC
+
+#endif // ndef GINAC_SPARSE_GCD_H
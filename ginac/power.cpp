@@ -38,6 +38,7 @@
 #include "relational.h"
 #include "compiler.h"
 
+#include <cmath>
 #include <iostream>
 #include <limits>
 #include <stdexcept>
@@ -600,6 +601,14 @@ ex power::evalf(int level) const
 	return power(ebasis,eexponent);
 }
 
+double power::evalf_double(const exmap & m) const
+{
+	const double b = basis.evalf_double(m);
+	if (exponent.is_equal(_ex1_2))
+		return std::sqrt(b);
+	return std::pow(b, exponent.evalf_double(m));
+}
+
 ex power::evalm() const
 {
 	const ex ebasis = basis.evalm();
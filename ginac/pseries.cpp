@@ -696,6 +696,234 @@ ex symbol::series(const relational & r, int order, unsigned options) const
 }
 
 
+/** Dense representation of the coefficients of a series, used by the
+ *  arithmetic kernels below.  The coefficient of the power ldeg+i is
+ *  coeffs[i], zero coefficients included, so that coefficients are looked
+ *  up in constant time.  The Order term is kept separately by its
+ *  exponent. */
+struct dense_series {
+	dense_series() : ldeg(0), truncated(false), order(0) {}
+	dense_series(const epvector & seq);
+	epvector to_epvector() const;
+
+	/** Exponent from which on coefficients are unknown. */
+	int limit() const { return truncated ? order : std::numeric_limits<int>::max(); }
+
+	int ldeg;
+	exvector coeffs;
+	bool truncated;
+	int order;
+};
+
+dense_series::dense_series(const epvector & seq) : ldeg(0), truncated(false), order(0)
+{
+	if (seq.empty())
+		return;
+	ldeg = ex_to<numeric>(seq.begin()->coeff).to_int();
+	epvector::const_iterator it = seq.begin(), itend = seq.end();
+	for (; it!=itend; ++it) {
+		const int deg = ex_to<numeric>(it->coeff).to_int();
+		if (is_order_function(it->rest)) {
+			truncated = true;
+			order = deg;
+			break;
+		}
+		coeffs.resize(deg - ldeg + 1, _ex0);
+		coeffs[deg - ldeg] = it->rest;
+	}
+}
+
+/** Convert back to the sparse representation used by pseries. */
+epvector dense_series::to_epvector() const
+{
+	epvector seq;
+	seq.reserve(coeffs.size() + 1);
+	for (size_t i=0; i<coeffs.size(); ++i) {
+		if (!coeffs[i].is_zero())
+			seq.push_back(expair(coeffs[i], numeric(ldeg + int(i))));
+	}
+	if (truncated)
+		seq.push_back(expair(Order(_ex1), numeric(order)));
+	return seq;
+}
+
+/** Sum of the terms, built in one go instead of term by term. */
+static ex sum_of_terms(const exvector & terms)
+{
+	if (terms.empty())
+		return _ex0;
+	if (terms.size() == 1)
+		return terms[0];
+	return (new add(terms))->setflag(status_flags::dynallocated);
+}
+
+/** Coefficients lo, ..., hi-1 of the product of two dense coefficient
+ *  vectors.  Zero coefficients are skipped. */
+static exvector product_range(const exvector & a, const exvector & b, size_t lo, size_t hi)
+{
+	exvector c;
+	c.reserve(hi > lo ? hi - lo : 0);
+	exvector terms;
+	for (size_t k=lo; k<hi; ++k) {
+		terms.clear();
+		const size_t imin = k < b.size() ? 0 : k - b.size() + 1;
+		for (size_t i=imin; i<=k && i<a.size(); ++i) {
+			if (!a[i].is_zero() && !b[k - i].is_zero())
+				terms.push_back(a[i] * b[k - i]);
+		}
+		c.push_back(sum_of_terms(terms));
+	}
+	return c;
+}
+
+
+/*
+ *  Newton iteration kernels
+ *
+ *  The following functions work on the coefficients c[0], c[1], ... of
+ *  truncated power series c[0] + c[1]*x + c[2]*x^2 + ...  Each Newton step
+ *  doubles the number of correct coefficients.  Since the coefficients
+ *  below that number are correct already, a step only computes the new
+ *  ones, i.e. the corrections are formed from the higher part of the
+ *  residual only.  This keeps the coefficients in the form in which they
+ *  were computed first, which matters when they are symbolic.
+ */
+
+/** Coefficients lo, ..., hi-1 of a coefficient vector, the lower ones
+ *  replaced by zeros. */
+static exvector upper_part(const exvector & a, size_t lo, size_t hi)
+{
+	exvector c(lo, _ex0);
+	for (size_t k=lo; k<hi; ++k)
+		c.push_back(k < a.size() ? a[k] : _ex0);
+	return c;
+}
+
+/** Reciprocal of a series with a[0] != 0 modulo x^n, by the iteration
+ *  g <- g + g*(1 - a*g). */
+static exvector reciprocal_dense(const exvector & a, size_t n)
+{
+	exvector g(1, power(a[0], _ex_1));
+	while (g.size() < n) {
+		const size_t m0 = g.size(), m = std::min(2*m0, n);
+		// a*g = 1 + e, where e = O(x^m0)
+		const exvector e = upper_part(product_range(a, g, 0, m), m0, m);
+		const exvector d = product_range(g, e, m0, m);
+		for (size_t k=0; k<d.size(); ++k)
+			g.push_back(-d[k]);
+	}
+	return g;
+}
+
+/** Logarithm of a series with a[0] != 0 modulo x^n, as the integral of
+ *  a'/a. */
+static exvector log_dense(const exvector & a, size_t n)
+{
+	exvector c(1, log(a[0]));
+	if (n <= 1)
+		return c;
+	exvector da;
+	for (size_t k=1; k<a.size() && k<n; ++k)
+		da.push_back(int(k) * a[k]);
+	const exvector q = product_range(da, reciprocal_dense(a, n - 1), 0, n - 1);
+	for (size_t k=1; k<n; ++k)
+		c.push_back(q[k - 1] / int(k));
+	return c;
+}
+
+/** Exponential of a series modulo x^n, by the iteration
+ *  g <- g + g*(h - log(g)) for the part h of a without constant term. */
+static exvector exp_dense(const exvector & a, size_t n)
+{
+	exvector g(1, _ex1);
+	while (g.size() < n) {
+		const size_t m0 = g.size(), m = std::min(2*m0, n);
+		const exvector l = log_dense(g, m);
+		// h - log(g) = O(x^m0)
+		exvector e(m0, _ex0);
+		for (size_t k=m0; k<m; ++k)
+			e.push_back((k < a.size() ? a[k] : _ex0) - l[k]);
+		const exvector d = product_range(g, e, m0, m);
+		g.insert(g.end(), d.begin(), d.end());
+	}
+	if (!a.empty() && !a[0].is_zero()) {
+		const ex c = exp(a[0]);
+		for (size_t k=0; k<g.size(); ++k)
+			g[k] = c * g[k];
+	}
+	return g;
+}
+
+/** Square root of a series with a[0] != 0 modulo x^n, by the iteration
+ *  g <- g + (a - g^2)/(2*g). */
+static exvector sqrt_dense(const exvector & a, size_t n)
+{
+	exvector g(1, power(a[0], _ex1_2));
+	while (g.size() < n) {
+		const size_t m0 = g.size(), m = std::min(2*m0, n);
+		// a - g^2 = O(x^m0)
+		const exvector sq = product_range(g, g, m0, m);
+		exvector e(m0, _ex0);
+		for (size_t k=m0; k<m; ++k)
+			e.push_back((k < a.size() ? a[k] : _ex0) - sq[k - m0]);
+		const exvector d = product_range(reciprocal_dense(g, m), e, m0, m);
+		for (size_t k=0; k<d.size(); ++k)
+			g.push_back(d[k] / 2);
+	}
+	return g;
+}
+
+/** Composition f(h) modulo x^n of two series with h[0] == 0, by Horner's
+ *  rule. */
+static exvector compose_dense(const exvector & f, const exvector & h, size_t n)
+{
+	exvector c;
+	for (size_t k=f.size(); k-->0; ) {
+		if (!c.empty())
+			c = product_range(c, h, 0, std::min(c.size() + h.size(), n));
+		if (c.empty())
+			c.push_back(f[k]);
+		else
+			c[0] = c[0] + f[k];
+	}
+	c.resize(n, _ex0);
+	return c;
+}
+
+/** Compositional inverse modulo x^n of a series with f[0] == 0 and
+ *  f[1] != 0, i.e. the series g with f(g(x)) = x, by the iteration
+ *  g <- g - (f(g) - x)/f'(g). */
+static exvector revert_dense(const exvector & f, size_t n)
+{
+	exvector g(2, _ex0);
+	g[1] = power(f[1], _ex_1);
+	exvector df;
+	for (size_t k=1; k<f.size(); ++k)
+		df.push_back(int(k) * f[k]);
+	while (g.size() < n) {
+		const size_t m0 = g.size(), m = std::min(2*m0, n);
+		// f(g) - x = O(x^m0)
+		const exvector e = upper_part(compose_dense(f, g, m), m0, m);
+		const exvector r = reciprocal_dense(compose_dense(df, g, m), m);
+		const exvector d = product_range(r, e, m0, m);
+		for (size_t k=0; k<d.size(); ++k)
+			g.push_back(-d[k]);
+	}
+	g.resize(n, _ex0);
+	return g;
+}
+
+/** Coefficients of the powers 0, ..., n-1 of a series without pole. */
+static exvector taylor_coeffs(const dense_series & a, size_t n)
+{
+	exvector c(std::min(size_t(std::max(a.ldeg, 0)), n), _ex0);
+	for (size_t i=0; i<a.coeffs.size() && c.size()<n; ++i)
+		c.push_back(a.coeffs[i]);
+	c.resize(n, _ex0);
+	return c;
+}
+
+
 /** Add one series object to another, producing a pseries object that
  *  represents the sum.
  *
@@ -711,62 +939,32 @@ ex pseries::add_series(const pseries &other) const
 		return pseries(relational(var,point), nul);
 	}
 	
-	// Series addition
-	epvector new_seq;
-	epvector::const_iterator a = seq.begin();
-	epvector::const_iterator b = other.seq.begin();
-	epvector::const_iterator a_end = seq.end();
-	epvector::const_iterator b_end = other.seq.end();
-	int pow_a = std::numeric_limits<int>::max(), pow_b = std::numeric_limits<int>::max();
-	for (;;) {
-		// If a is empty, fill up with elements from b and stop
-		if (a == a_end) {
-			while (b != b_end) {
-				new_seq.push_back(*b);
-				++b;
-			}
-			break;
-		} else
-			pow_a = ex_to<numeric>((*a).coeff).to_int();
-		
-		// If b is empty, fill up with elements from a and stop
-		if (b == b_end) {
-			while (a != a_end) {
-				new_seq.push_back(*a);
-				++a;
-			}
-			break;
-		} else
-			pow_b = ex_to<numeric>((*b).coeff).to_int();
-		
-		// a and b are non-empty, compare powers
-		if (pow_a < pow_b) {
-			// a has lesser power, get coefficient from a
-			new_seq.push_back(*a);
-			if (is_order_function((*a).rest))
-				break;
-			++a;
-		} else if (pow_b < pow_a) {
-			// b has lesser power, get coefficient from b
-			new_seq.push_back(*b);
-			if (is_order_function((*b).rest))
-				break;
-			++b;
-		} else {
-			// Add coefficient of a and b
-			if (is_order_function((*a).rest) || is_order_function((*b).rest)) {
-				new_seq.push_back(expair(Order(_ex1), (*a).coeff));
-				break;  // Order term ends the sequence
-			} else {
-				ex sum = (*a).rest + (*b).rest;
-				if (!(sum.is_zero()))
-					new_seq.push_back(expair(sum, numeric(pow_a)));
-				++a;
-				++b;
-			}
-		}
+	// Adding zero
+	if (seq.empty())
+		return pseries(relational(var,point), other.seq);
+	if (other.seq.empty())
+		return *this;
+
+	// Series addition, up to the lower of the Order terms
+	const dense_series a(seq), b(other.seq);
+	dense_series c;
+	c.truncated = a.truncated || b.truncated;
+	c.order = std::min(a.limit(), b.limit());
+	c.ldeg = std::min(a.ldeg, b.ldeg);
+	const int hi = std::min(std::max(a.ldeg + int(a.coeffs.size()), b.ldeg + int(b.coeffs.size())), c.limit());
+	for (int deg=c.ldeg; deg<hi; ++deg) {
+		const bool in_a = deg >= a.ldeg && deg < a.ldeg + int(a.coeffs.size());
+		const bool in_b = deg >= b.ldeg && deg < b.ldeg + int(b.coeffs.size());
+		if (in_a && in_b)
+			c.coeffs.push_back(a.coeffs[deg - a.ldeg] + b.coeffs[deg - b.ldeg]);
+		else if (in_a)
+			c.coeffs.push_back(a.coeffs[deg - a.ldeg]);
+		else if (in_b)
+			c.coeffs.push_back(b.coeffs[deg - b.ldeg]);
+		else
+			c.coeffs.push_back(_ex0);
 	}
-	return pseries(relational(var,point), new_seq);
+	return pseries(relational(var,point), c.to_epvector());
 }
 
 
@@ -841,40 +1039,27 @@ ex pseries::mul_series(const pseries &other) const
 		       ->setflag(status_flags::dynallocated);
 	}
 	
-	// Series multiplication
-	epvector new_seq;
-	int a_max = degree(var);
-	int b_max = other.degree(var);
-	int a_min = ldegree(var);
-	int b_min = other.ldegree(var);
-	int cdeg_min = a_min + b_min;
-	int cdeg_max = a_max + b_max;
-	
-	int higher_order_a = std::numeric_limits<int>::max();
-	int higher_order_b = std::numeric_limits<int>::max();
-	if (is_order_function(coeff(var, a_max)))
-		higher_order_a = a_max + b_min;
-	if (is_order_function(other.coeff(var, b_max)))
-		higher_order_b = b_max + a_min;
-	int higher_order_c = std::min(higher_order_a, higher_order_b);
-	if (cdeg_max >= higher_order_c)
-		cdeg_max = higher_order_c - 1;
-	
-	for (int cdeg=cdeg_min; cdeg<=cdeg_max; ++cdeg) {
-		ex co = _ex0;
-		// c(i)=a(0)b(i)+...+a(i)b(0)
-		for (int i=a_min; cdeg-i>=b_min; ++i) {
-			ex a_coeff = coeff(var, i);
-			ex b_coeff = other.coeff(var, cdeg-i);
-			if (!is_order_function(a_coeff) && !is_order_function(b_coeff))
-				co += a_coeff * b_coeff;
-		}
-		if (!co.is_zero())
-			new_seq.push_back(expair(co, numeric(cdeg)));
-	}
-	if (higher_order_c < std::numeric_limits<int>::max())
-		new_seq.push_back(expair(Order(_ex1), numeric(higher_order_c)));
-	return pseries(relational(var, point), new_seq);
+	// Series multiplication: the Order term of a product is the lower one
+	// of O(a)*b and a*O(b), below it the coefficients are the convolution
+	// of the coefficients of the factors
+	const dense_series a(seq), b(other.seq);
+	dense_series c;
+	c.ldeg = a.ldeg + b.ldeg;
+	c.truncated = a.truncated || b.truncated;
+	c.order = std::numeric_limits<int>::max();
+	if (a.truncated)
+		c.order = a.order + b.ldeg;
+	if (b.truncated)
+		c.order = std::min(c.order, b.order + a.ldeg);
+
+	int ncoeffs = 0;
+	if (!a.coeffs.empty() && !b.coeffs.empty())
+		ncoeffs = a.coeffs.size() + b.coeffs.size() - 1;
+	if (c.truncated)
+		ncoeffs = std::max(std::min(ncoeffs, c.order - c.ldeg), 0);
+
+	c.coeffs = product_range(a.coeffs, b.coeffs, 0, ncoeffs);
+	return pseries(relational(var, point), c.to_epvector());
 }
 
 
@@ -1049,51 +1234,222 @@ ex pseries::power_const(const numeric &p, int deg) const
 	if (seq.size() == 1 && is_order_function(seq[0].rest) && p.real().is_negative())
 		throw pole_error("pseries::power_const(): division by zero",1);
 	
+	const dense_series a(seq);
+	if (a.coeffs.empty()) {
+		// O(x^n)^m == O(x^(n*m))
+		epvector epv;
+		epv.push_back(expair(Order(_ex1), p * ldeg));
+		return pseries(relational(var,point), epv);
+	}
+
+	// Coefficients are known up to the Order term of the series
+	if (a.truncated)
+		numcoeff = std::min(numcoeff, a.order - ldeg);
+
 	// Compute coefficients of the powered series
-	exvector co;
+	dense_series c;
+	c.ldeg = (p * ldeg).to_int();
+	c.truncated = true;
+	c.order = c.ldeg + numcoeff;
+	exvector & co = c.coeffs;
 	co.reserve(numcoeff);
-	co.push_back(power(coeff(var, ldeg), p));
+	co.push_back(power(a.coeffs[0], p));
+	exvector terms;
 	for (int i=1; i<numcoeff; ++i) {
-		ex sum = _ex0;
-		for (int j=1; j<=i; ++j) {
-			ex c = coeff(var, j + ldeg);
-			if (is_order_function(c)) {
-				co.push_back(Order(_ex1));
-				break;
-			} else
-				sum += (p * j - (i - j)) * co[i - j] * c;
+		terms.clear();
+		for (int j=1; j<=i && j<int(a.coeffs.size()); ++j) {
+			if (!a.coeffs[j].is_zero() && !co[i - j].is_zero())
+				terms.push_back((p * j - (i - j)) * co[i - j] * a.coeffs[j]);
 		}
-		co.push_back(sum / coeff(var, ldeg) / i);
+		co.push_back(sum_of_terms(terms) / a.coeffs[0] / i);
 	}
-	
-	// Construct new series (of non-zero coefficients)
-	epvector new_seq;
-	bool higher_order = false;
-	for (int i=0; i<numcoeff; ++i) {
-		if (!co[i].is_zero())
-			new_seq.push_back(expair(co[i], p * ldeg + i));
-		if (is_order_function(co[i])) {
-			higher_order = true;
-			break;
-		}
+
+	return pseries(relational(var,point), c.to_epvector());
+}
+
+
+/** Compute the reciprocal 1/A(x) of a series by Newton iteration.
+ *
+ *  @param deg  truncation order of series calculation
+ *  @exception pole_error (series is zero) */
+ex pseries::inverse_series(int deg) const
+{
+	const dense_series a(seq);
+	if (a.coeffs.empty())
+		throw pole_error("pseries::inverse_series(): division by zero", 1);
+
+	// The leading coefficient is non-zero, the leading power just changes
+	// its sign
+	dense_series c;
+	c.ldeg = -a.ldeg;
+	c.truncated = true;
+	int n = deg - c.ldeg;
+	if (a.truncated)
+		n = std::min(n, a.order - a.ldeg);
+	c.order = n > 0 ? c.ldeg + n : deg;
+	if (n > 0)
+		c.coeffs = reciprocal_dense(a.coeffs, n);
+	return pseries(relational(var,point), c.to_epvector());
+}
+
+
+/** Compute the exponential exp(A(x)) of a series by Newton iteration.
+ *
+ *  @param deg  truncation order of series calculation
+ *  @exception pole_error (series has a pole) */
+ex pseries::exp_series(int deg) const
+{
+	const dense_series a(seq);
+	if (!a.coeffs.empty() && a.ldeg < 0)
+		throw pole_error("pseries::exp_series(): essential singularity", -a.ldeg);
+
+	dense_series c;
+	c.truncated = true;
+	c.order = std::min(deg, a.limit());
+	if (c.order > 0)
+		c.coeffs = exp_dense(taylor_coeffs(a, c.order), c.order);
+	return pseries(relational(var,point), c.to_epvector());
+}
+
+
+/** Compute the logarithm log(A(x)) of a series by Newton iteration.  The
+ *  series must start with a non-zero constant term, branch points are
+ *  handled by the series expansion of the function log.
+ *
+ *  @param deg  truncation order of series calculation
+ *  @exception domain_error (series has no constant term) */
+ex pseries::log_series(int deg) const
+{
+	const dense_series a(seq);
+	if (a.coeffs.empty() || a.ldeg != 0)
+		throw std::domain_error("pseries::log_series(): series does not start with a constant term");
+
+	dense_series c;
+	c.truncated = true;
+	c.order = std::min(deg, a.limit());
+	if (c.order > 0)
+		c.coeffs = log_dense(taylor_coeffs(a, c.order), c.order);
+	return pseries(relational(var,point), c.to_epvector());
+}
+
+
+/** Compute the square root of a series by Newton iteration.  The series
+ *  must start with a non-zero constant term.
+ *
+ *  @param deg  truncation order of series calculation
+ *  @exception domain_error (series has no constant term) */
+ex pseries::sqrt_series(int deg) const
+{
+	const dense_series a(seq);
+	if (a.coeffs.empty() || a.ldeg != 0)
+		throw std::domain_error("pseries::sqrt_series(): series does not start with a constant term");
+
+	dense_series c;
+	c.truncated = true;
+	c.order = std::min(deg, a.limit());
+	if (c.order > 0)
+		c.coeffs = sqrt_dense(taylor_coeffs(a, c.order), c.order);
+	return pseries(relational(var,point), c.to_epvector());
+}
+
+
+/** Substitute a series B(y) for the variable of this series A(x), i.e.
+ *  compute the series of A(B(y)) in the variable of B(y).  The constant
+ *  term of B(y) must be the expansion point of A(x).
+ *
+ *  @param inner  series B(y) to substitute
+ *  @param deg  truncation order of series calculation
+ *  @exception pole_error (one of the series has a pole)
+ *  @exception invalid_argument (constant term of B(y) is not the expansion point) */
+ex pseries::compose_series(const pseries &inner, int deg) const
+{
+	const dense_series f(seq), b(inner.seq);
+	if (!f.coeffs.empty() && f.ldeg < 0)
+		throw pole_error("pseries::compose_series(): outer series has a pole", -f.ldeg);
+	if (!b.coeffs.empty() && b.ldeg < 0)
+		throw pole_error("pseries::compose_series(): inner series has a pole", -b.ldeg);
+
+	const relational rel(inner.var, inner.point);
+	int n = std::min(deg, b.limit());
+	if (n <= 0) {
+		epvector epv(1, expair(Order(_ex1), n));
+		return pseries(rel, epv);
 	}
-	if (!higher_order)
-		new_seq.push_back(expair(Order(_ex1), p * ldeg + numcoeff));
 
-	return pseries(relational(var,point), new_seq);
+	// h(y) = B(y) - point, v is its valuation
+	exvector h = taylor_coeffs(b, n);
+	if (!(h[0] - point).expand().is_zero())
+		throw std::invalid_argument("pseries::compose_series(): constant term of inner series is not the expansion point");
+	h[0] = _ex0;
+	int v = 1;
+	while (v < n && h[v].is_zero())
+		++v;
+
+	// The power h(y)^k starts with y^(k*v), so only the coefficients of A(x)
+	// with k*v < n are needed
+	if (f.truncated)
+		n = std::min(n, f.order * v);
+	if (n <= 0) {
+		epvector epv(1, expair(Order(_ex1), n));
+		return pseries(rel, epv);
+	}
+	int nf = (n - 1) / v + 1;
+	if (!f.truncated)
+		nf = std::min(nf, f.ldeg + int(f.coeffs.size()));
+
+	dense_series c;
+	c.order = n;
+	c.truncated = f.truncated || b.truncated;
+	if (!c.truncated) {
+		// Both series are polynomials, is the composition cut off?
+		const long fdeg = f.coeffs.empty() ? 0 : f.ldeg + f.coeffs.size() - 1;
+		const long hdeg = b.coeffs.empty() ? 0 : b.ldeg + b.coeffs.size() - 1;
+		c.truncated = fdeg * hdeg >= n;
+	}
+	c.coeffs = compose_dense(taylor_coeffs(f, nf), h, n);
+	return pseries(rel, c.to_epvector());
+}
+
+
+/** Compute the series of the inverse function of a series A(x) by Newton
+ *  iteration.  The result B(y) satisfies A(B(y)) = y, its variable is the
+ *  variable of A(x) and its expansion point is the constant term of A(x).
+ *  The linear coefficient of A(x) must not vanish.
+ *
+ *  @param deg  truncation order of series calculation
+ *  @exception domain_error (series is not invertible) */
+ex pseries::revert_series(int deg) const
+{
+	const dense_series a(seq);
+	if ((!a.coeffs.empty() && a.ldeg < 0) || a.limit() < 2)
+		throw std::domain_error("pseries::revert_series(): series is not invertible");
+	const int n = std::min(deg, a.limit());
+	exvector f = taylor_coeffs(a, std::max(n, 2));
+	if (f[1].is_zero())
+		throw std::domain_error("pseries::revert_series(): series is not invertible");
+	const ex c0 = f[0];
+	f[0] = _ex0;
+
+	dense_series c;
+	c.truncated = true;
+	c.order = n;
+	if (n > 0) {
+		c.coeffs = revert_dense(f, n);
+		c.coeffs[0] = point;
+	}
+	return pseries(relational(var, c0), c.to_epvector());
 }
 
 
 /** Return a new pseries object with the powers shifted by deg. */
 pseries pseries::shift_exponents(int deg) const
 {
-	epvector newseq = seq;
-	epvector::iterator i = newseq.begin(), end  = newseq.end();
-	while (i != end) {
-		i->coeff += deg;
-		++i;
-	}
-	return pseries(relational(var, point), newseq);
+	if (seq.empty())
+		return *this;
+	dense_series d(seq);
+	d.ldeg += deg;
+	d.order += deg;
+	return pseries(relational(var, point), d.to_epvector());
 }
 
 
@@ -99,6 +99,12 @@ public:
 	ex mul_const(const numeric &other) const;
 	ex mul_series(const pseries &other) const;
 	ex power_const(const numeric &p, int deg) const;
+	ex inverse_series(int deg) const;
+	ex exp_series(int deg) const;
+	ex log_series(int deg) const;
+	ex sqrt_series(int deg) const;
+	ex compose_series(const pseries &inner, int deg) const;
+	ex revert_series(int deg) const;
 	pseries shift_exponents(int deg) const;
 
 protected:
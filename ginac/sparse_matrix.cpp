@@ -0,0 +1,575 @@
+/** @file sparse_matrix.cpp
+ *
+ *  Implementation of sparse matrices and their linear systems. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "sparse_matrix.h"
+#include "flags.h"
+#include "normal.h"
+#include "numeric.h"
+#include "operators.h"
+#include "utils.h"
+#include "worker_processes.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <stdexcept>
+
+namespace GiNaC {
+
+sparse_matrix::sparse_matrix(unsigned r, unsigned c) : row(r), col(c), m(r)
+{
+}
+
+/** Construct from the nonzero entries of a dense matrix. */
+sparse_matrix::sparse_matrix(const matrix & mat) : row(mat.rows()), col(mat.cols()), m(mat.rows())
+{
+	for (unsigned r=0; r<row; ++r)
+		for (unsigned c=0; c<col; ++c)
+			if (!mat(r,c).is_zero())
+				m[r][c] = mat(r,c);
+}
+
+/** Number of nonzero entries. */
+size_t sparse_matrix::nnz() const
+{
+	size_t n = 0;
+	for (std::vector<row_type>::const_iterator r=m.begin(); r!=m.end(); ++r)
+		n += r->size();
+	return n;
+}
+
+/** Whether linear systems with this matrix are better eliminated sparsely,
+ *  which is the case for more than eight columns with less than about one
+ *  fifth of nonzero entries. */
+bool sparse_matrix::is_sparse() const
+{
+	return col > 8 && 5*nnz() <= size_t(row)*col;
+}
+
+/** Entry in row ro and column co, zero if it is not stored.
+ *
+ *  @exception range_error (index out of range) */
+ex sparse_matrix::operator() (unsigned ro, unsigned co) const
+{
+	if (ro>=row || co>=col)
+		throw (std::range_error("sparse_matrix::operator(): index out of range"));
+	const row_type::const_iterator i = m[ro].find(co);
+	return i==m[ro].end() ? _ex0 : i->second;
+}
+
+/** Set the entry in row ro and column co, dropping it if it is zero.
+ *
+ *  @exception range_error (index out of range) */
+sparse_matrix & sparse_matrix::set(unsigned ro, unsigned co, const ex & value)
+{
+	if (ro>=row || co>=col)
+		throw (std::range_error("sparse_matrix::set(): index out of range"));
+	if (value.is_zero())
+		m[ro].erase(co);
+	else
+		m[ro][co] = value;
+	return *this;
+}
+
+/** Nonzero entries of row ro, by column index.
+ *
+ *  @exception range_error (index out of range) */
+const sparse_matrix::row_type & sparse_matrix::row_entries(unsigned ro) const
+{
+	if (ro>=row)
+		throw (std::range_error("sparse_matrix::row_entries(): index out of range"));
+	return m[ro];
+}
+
+matrix sparse_matrix::to_matrix() const
+{
+	matrix mat(row, col);
+	for (unsigned r=0; r<row; ++r)
+		for (row_type::const_iterator i=m[r].begin(); i!=m[r].end(); ++i)
+			mat(r, i->first) = i->second;
+	return mat;
+}
+
+namespace {
+
+/** Divide a row of polynomials by the gcd of its entries. */
+void remove_content(sparse_matrix::row_type & r)
+{
+	if (r.empty())
+		return;
+	sparse_matrix::row_type::iterator i = r.begin();
+	ex g = i->second;
+	for (++i; i!=r.end() && !g.is_equal(_ex1) && !g.is_equal(_ex_1); ++i)
+		g = gcd(g, i->second);
+	if (g.is_equal(_ex1) || g.is_equal(_ex_1))
+		return;
+	for (i=r.begin(); i!=r.end(); ++i) {
+		ex q;
+		bool check = divide(i->second, g, q);
+		GINAC_ASSERT(check);
+		i->second = q;
+	}
+}
+
+/** Number of entries of a row in the first n columns. */
+unsigned count_below(const sparse_matrix::row_type & r, unsigned n)
+{
+	unsigned count = 0;
+	for (sparse_matrix::row_type::const_iterator i=r.begin(); i!=r.end() && i->first<n; ++i)
+		++count;
+	return count;
+}
+
+/** Find an augmenting path for the row r in the bipartite graph of rows and
+ *  columns, in the manner of Kuhn's algorithm.
+ *
+ *  @param col_row row matched to each column, or the number of rows
+ *  @param visited columns already visited in this search
+ *  @return true if row r could be matched */
+bool augment(const std::vector<sparse_matrix::row_type> & m, unsigned r,
+             std::vector<unsigned> & col_row, std::vector<bool> & visited)
+{
+	for (sparse_matrix::row_type::const_iterator i=m[r].begin(); i!=m[r].end(); ++i) {
+		if (visited[i->first])
+			continue;
+		visited[i->first] = true;
+		if (col_row[i->first]==m.size() || augment(m, col_row[i->first], col_row, visited)) {
+			col_row[i->first] = r;
+			return true;
+		}
+	}
+	return false;
+}
+
+/** State of Tarjan's algorithm for the strongly connected components of the
+ *  graph with an edge from column c to each other column in row rows[c]. */
+struct tarjan_state {
+	tarjan_state(const std::vector<sparse_matrix::row_type> & m_, const std::vector<unsigned> & rows_)
+	  : m(m_), rows(rows_), index(rows_.size(), unsigned(-1)), lowlink(rows_.size()),
+	    on_stack(rows_.size(), false), next_index(0) {}
+
+	void visit(unsigned c);
+
+	const std::vector<sparse_matrix::row_type> & m;
+	const std::vector<unsigned> & rows;
+	std::vector<unsigned> index;
+	std::vector<unsigned> lowlink;
+	std::vector<bool> on_stack;
+	std::vector<unsigned> stack;
+	std::vector<std::vector<unsigned> > blocks;
+	unsigned next_index;
+};
+
+void tarjan_state::visit(unsigned c)
+{
+	index[c] = lowlink[c] = next_index++;
+	stack.push_back(c);
+	on_stack[c] = true;
+	const sparse_matrix::row_type & r = m[rows[c]];
+	for (sparse_matrix::row_type::const_iterator i=r.begin(); i!=r.end(); ++i) {
+		const unsigned k = i->first;
+		if (index[k]==unsigned(-1)) {
+			visit(k);
+			lowlink[c] = std::min(lowlink[c], lowlink[k]);
+		} else if (on_stack[k])
+			lowlink[c] = std::min(lowlink[c], index[k]);
+	}
+	if (lowlink[c]==index[c]) {
+		// c is the root of a component, which lies on top of the stack
+		blocks.push_back(std::vector<unsigned>());
+		unsigned k;
+		do {
+			k = stack.back();
+			stack.pop_back();
+			on_stack[k] = false;
+			blocks.back().push_back(k);
+		} while (k!=c);
+		std::sort(blocks.back().begin(), blocks.back().end());
+	}
+}
+
+} // anonymous namespace
+
+/** Block triangular form of a square matrix (the fine Dulmage-Mendelsohn
+ *  decomposition).  A row is matched to every column such that the matched
+ *  entries are nonzero, by augmenting paths.  Then the equation in row
+ *  rows[c] determines the unknown of column c, and the strongly connected
+ *  components of the dependencies between the unknowns, found by Tarjan's
+ *  algorithm, are the irreducible diagonal blocks.  The determinant is the
+ *  product of the determinants of the blocks times the sign of the
+ *  permutation rows, and a linear system can be solved block by block.
+ *
+ *  @param rows on return, the row matched to each column
+ *  @param blocks on return, the columns of the blocks, in an order such that
+ *  the rows of each block have entries only in the columns of this and of
+ *  the previous blocks
+ *  @return false if the matrix is structurally singular, i.e. every term of
+ *  its determinant vanishes because no such matching exists
+ *  @exception logic_error (matrix not square) */
+bool sparse_matrix::block_triangular(std::vector<unsigned> & rows, std::vector<std::vector<unsigned> > & blocks) const
+{
+	if (row!=col)
+		throw (std::logic_error("sparse_matrix::block_triangular(): matrix not square"));
+
+	std::vector<unsigned> col_row(col, row);
+	for (unsigned r=0; r<row; ++r) {
+		std::vector<bool> visited(col, false);
+		if (!augment(m, r, col_row, visited))
+			return false;
+	}
+
+	tarjan_state state(m, col_row);
+	for (unsigned c=0; c<col; ++c)
+		if (state.index[c]==unsigned(-1))
+			state.visit(c);
+	rows.swap(col_row);
+	blocks.swap(state.blocks);
+	return true;
+}
+
+/** Solve the block b of the block triangular form (rows, blocks) of a,
+ *  with the unknowns of the blocks it depends on substituted from sol. */
+static matrix solve_block(const sparse_matrix & a, const std::vector<unsigned> & rows,
+                          const std::vector<unsigned> & b, const matrix & vars, const matrix & rhs,
+                          const matrix & sol, unsigned algo)
+{
+	const unsigned k = b.size();
+	const unsigned p = rhs.cols();
+	std::map<unsigned, unsigned> position;
+	for (unsigned i=0; i<k; ++i)
+		position[b[i]] = i;
+	sparse_matrix sys(k, k);
+	matrix brhs(k, p), bvars(k, p);
+	for (unsigned i=0; i<k; ++i) {
+		const sparse_matrix::row_type & r = a.row_entries(rows[b[i]]);
+		for (unsigned co=0; co<p; ++co) {
+			bvars(i,co) = vars(b[i],co);
+			brhs(i,co) = rhs(rows[b[i]],co);
+		}
+		for (sparse_matrix::row_type::const_iterator e=r.begin(); e!=r.end(); ++e) {
+			const unsigned c = e->first;
+			if (std::binary_search(b.begin(), b.end(), c))
+				sys.set(i, position[c], e->second);
+			else
+				for (unsigned co=0; co<p; ++co)
+					brhs(i,co) -= e->second*sol(c,co);
+		}
+	}
+	if (algo==solve_algo::sparse || (algo==solve_algo::automatic && sys.is_sparse()))
+		return sys.solve(bvars, brhs);
+	return sys.to_matrix().solve(bvars, brhs, algo);
+}
+
+/** Blocks of the block triangular form that do not depend on each other,
+ *  solved by worker processes. */
+class block_solve_jobs : public worker_jobs
+{
+public:
+	block_solve_jobs(const sparse_matrix & a_, const std::vector<unsigned> & rows_,
+	                 const std::vector<std::vector<unsigned> > & blocks_, const std::vector<unsigned> & level_,
+	                 const matrix & vars_, const matrix & rhs_, const matrix & sol_, unsigned algo_)
+	 : a(a_), rows(rows_), blocks(blocks_), level(level_), vars(vars_), rhs(rhs_), sol(sol_), algo(algo_) {}
+	exvector compute(size_t i)
+	{
+		const matrix bsol = solve_block(a, rows, blocks[level[i]], vars, rhs, sol, algo);
+		exvector entries;
+		for (unsigned r=0; r<bsol.rows(); ++r)
+			for (unsigned co=0; co<bsol.cols(); ++co)
+				entries.push_back(bsol(r,co));
+		return entries;
+	}
+private:
+	const sparse_matrix & a;
+	const std::vector<unsigned> & rows;
+	const std::vector<std::vector<unsigned> > & blocks;
+	const std::vector<unsigned> & level;
+	const matrix & vars, & rhs, & sol;
+	unsigned algo;
+};
+
+/** Solve a linear system consisting of this square matrix and a right hand
+ *  side block by block, following its block triangular form.  The blocks
+ *  are solved with matrix::solve() and algorithm algo, or sparsely by
+ *  sparse_matrix::solve() if algo is solve_algo::sparse or the block is
+ *  large and sparse.  The unknowns of the previous blocks are substituted
+ *  into the right hand sides.  Structurally singular matrices are solved
+ *  as a whole.
+ *
+ *  With solve_algo::parallel, the blocks whose unknowns do not depend on
+ *  each other are solved concurrently by worker processes, one per
+ *  processor, each of them by Bareiss elimination.  Where only one block
+ *  can be solved at a time, its rows are updated concurrently instead.
+ *
+ *  @param vars n x p matrix, all elements must be symbols
+ *  @param rhs n x p matrix
+ *  @param algo selects the solving algorithm of the blocks
+ *  @return n x p solution matrix
+ *  @exception logic_error (incompatible matrices)
+ *  @exception runtime_error (inconsistent linear system)
+ *  @see sparse_matrix::block_triangular */
+matrix sparse_matrix::block_solve(const matrix & vars, const matrix & rhs, unsigned algo) const
+{
+	const unsigned p = rhs.cols();
+	if ((row!=col) || (rhs.rows()!=row) || (vars.rows()!=col) || (vars.cols()!=p))
+		throw (std::logic_error("sparse_matrix::block_solve(): incompatible matrices"));
+
+	std::vector<unsigned> rows;
+	std::vector<std::vector<unsigned> > blocks;
+	if (!block_triangular(rows, blocks) || blocks.size()==1) {
+		if (algo==solve_algo::sparse || (algo==solve_algo::automatic && is_sparse()))
+			return solve(vars, rhs);
+		return to_matrix().solve(vars, rhs, algo);
+	}
+
+	// A block depends on the blocks of the unknowns in its rows, which come
+	// before it.  All blocks of a level only depend on lower levels.
+	std::vector<unsigned> block_of(col), depth(blocks.size(), 0);
+	for (unsigned b=0; b<blocks.size(); ++b)
+		for (std::vector<unsigned>::const_iterator c=blocks[b].begin(); c!=blocks[b].end(); ++c)
+			block_of[*c] = b;
+	for (unsigned b=0; b<blocks.size(); ++b) {
+		for (std::vector<unsigned>::const_iterator c=blocks[b].begin(); c!=blocks[b].end(); ++c) {
+			const row_type & r = m[rows[*c]];
+			for (row_type::const_iterator e=r.begin(); e!=r.end(); ++e)
+				if (block_of[e->first]!=b && depth[block_of[e->first]]+1>depth[b])
+					depth[b] = depth[block_of[e->first]]+1;
+		}
+	}
+	std::vector<std::vector<unsigned> > levels(*std::max_element(depth.begin(), depth.end())+1);
+	for (unsigned b=0; b<blocks.size(); ++b)
+		levels[depth[b]].push_back(b);
+
+	matrix sol(col, p);
+	for (std::vector<std::vector<unsigned> >::const_iterator l=levels.begin(); l!=levels.end(); ++l) {
+		const size_t count = l->size();
+		std::vector<exvector> results;
+		std::vector<bool> done(count, false);
+		if (algo==solve_algo::parallel && count>1) {
+			exvector entries;
+			for (unsigned r=0; r<row; ++r)
+				for (row_type::const_iterator e=m[r].begin(); e!=m[r].end(); ++e)
+					entries.push_back(e->second);
+			for (unsigned r=0; r<row; ++r)
+				for (unsigned co=0; co<p; ++co) {
+					entries.push_back(rhs(r,co));
+					entries.push_back(vars(r,co));
+					entries.push_back(sol(r,co));
+				}
+			lst syms;
+			if (collect_worker_symbols(entries, syms)) {
+				block_solve_jobs jobs(*this, rows, blocks, *l, vars, rhs, sol, solve_algo::bareiss);
+				compute_in_processes(jobs, count, 0, syms, results, done);
+			}
+		}
+		for (size_t i=0; i<count; ++i) {
+			const std::vector<unsigned> & b = blocks[(*l)[i]];
+			const unsigned k = b.size();
+			if (done[i] && results[i].size()==k*p) {
+				for (unsigned j=0; j<k; ++j)
+					for (unsigned co=0; co<p; ++co)
+						sol(b[j],co) = results[i][j*p+co];
+			} else {
+				const matrix bsol = solve_block(*this, rows, b, vars, rhs, sol, algo);
+				for (unsigned j=0; j<k; ++j)
+					for (unsigned co=0; co<p; ++co)
+						sol(b[j],co) = bsol(j,co);
+			}
+		}
+	}
+	return sol;
+}
+
+/** Solve a linear system consisting of this m x n matrix and a m x p right
+ *  hand side, like matrix::solve().  The rows are multiplied with the
+ *  denominators of their entries and eliminated fraction free: the row r is
+ *  reduced by the pivot row k as b*r - a*k, where a/b is the ratio of their
+ *  entries in the pivot column in lowest terms, and afterwards divided by
+ *  the gcd of its entries.  Pivots are chosen by Markowitz' rule, that is
+ *  the product of the other nonzero entries in the pivot's row and column
+ *  is minimized, which keeps the fill-in small.
+ *
+ *  @param vars n x p matrix, all elements must be symbols
+ *  @param rhs m x p matrix
+ *  @return n x p solution matrix
+ *  @exception logic_error (incompatible matrices)
+ *  @exception invalid_argument (1st argument must be matrix of symbols)
+ *  @exception runtime_error (inconsistent linear system) */
+matrix sparse_matrix::solve(const matrix & vars, const matrix & rhs) const
+{
+	const unsigned n = col;
+	const unsigned p = rhs.cols();
+
+	// syntax checks
+	if ((rhs.rows() != row) || (vars.rows() != n) || (vars.cols() != p))
+		throw (std::logic_error("sparse_matrix::solve(): incompatible matrices"));
+	for (unsigned ro=0; ro<n; ++ro)
+		for (unsigned co=0; co<p; ++co)
+			if (!vars(ro,co).info(info_flags::symbol))
+				throw (std::invalid_argument("sparse_matrix::solve(): 1st argument must be matrix of symbols"));
+
+	// The rows of the augmented system, with the right hand sides in the
+	// columns n, ..., n+p-1, made polynomial.
+	exmap srl;  // symbol replacement list
+	std::vector<row_type> a(row);
+	for (unsigned r=0; r<row; ++r) {
+		row_type nums, dens;
+		for (row_type::const_iterator i=m[r].begin(); i!=m[r].end(); ++i) {
+			const ex nd = i->second.normal().to_rational(srl).numer_denom();
+			nums[i->first] = nd.op(0);
+			dens[i->first] = nd.op(1);
+		}
+		for (unsigned c=0; c<p; ++c) {
+			if (rhs(r,c).is_zero())
+				continue;
+			const ex nd = rhs(r,c).normal().to_rational(srl).numer_denom();
+			nums[n+c] = nd.op(0);
+			dens[n+c] = nd.op(1);
+		}
+		ex l = _ex1;
+		for (row_type::const_iterator i=dens.begin(); i!=dens.end(); ++i)
+			l = lcm(l, i->second);
+		for (row_type::const_iterator i=nums.begin(); i!=nums.end(); ++i) {
+			if (i->second.is_zero())
+				continue;
+			ex q;
+			divide(l, dens[i->first], q);
+			a[r][i->first] = (i->second*q).expand();
+		}
+		remove_content(a[r]);
+	}
+
+	// rows with a nonzero entry in each column of the coefficients
+	std::vector<std::set<unsigned> > col_rows(n);
+	for (unsigned r=0; r<row; ++r)
+		for (row_type::const_iterator i=a[r].begin(); i!=a[r].end() && i->first<n; ++i)
+			col_rows[i->first].insert(r);
+
+	std::vector<bool> active(row, true);
+	std::vector<std::pair<unsigned, unsigned> > pivots;
+	for (;;) {
+		// Markowitz' rule, preferring numeric pivots among equals
+		unsigned kbest = row, cbest = n;
+		unsigned long costbest = 0;
+		bool numericbest = false;
+		for (unsigned r=0; r<row; ++r) {
+			if (!active[r])
+				continue;
+			const unsigned count = count_below(a[r], n);
+			if (count==0)
+				continue;
+			const unsigned long rcount = count - 1;
+			for (row_type::const_iterator i=a[r].begin(); i!=a[r].end() && i->first<n; ++i) {
+				const unsigned long cost = rcount * (col_rows[i->first].size() - 1);
+				const bool num = is_exactly_a<numeric>(i->second);
+				if (kbest==row || cost<costbest || (cost==costbest && num && !numericbest)) {
+					kbest = r;
+					cbest = i->first;
+					costbest = cost;
+					numericbest = num;
+				}
+			}
+		}
+		if (kbest==row)
+			break;
+
+		const unsigned k = kbest, c = cbest;
+		const row_type & pivrow = a[k];
+		active[k] = false;
+		for (row_type::const_iterator i=pivrow.begin(); i!=pivrow.end() && i->first<n; ++i)
+			col_rows[i->first].erase(k);
+		pivots.push_back(std::make_pair(k, c));
+
+		const std::set<unsigned> targets = col_rows[c];
+		for (std::set<unsigned>::const_iterator t=targets.begin(); t!=targets.end(); ++t) {
+			row_type & r = a[*t];
+			ex pc, fc;
+			gcd(pivrow.find(c)->second, r[c], &pc, &fc);
+			row_type reduced;
+			row_type::const_iterator i = r.begin(), j = pivrow.begin();
+			while (i!=r.end() || j!=pivrow.end()) {
+				unsigned co;
+				ex e;
+				if (j==pivrow.end() || (i!=r.end() && i->first<j->first)) {
+					co = i->first;
+					e = (pc*i->second).expand();
+					++i;
+				} else if (i==r.end() || j->first<i->first) {
+					co = j->first;
+					e = (-fc*j->second).expand();
+					++j;
+				} else {
+					co = i->first;
+					e = (pc*i->second - fc*j->second).expand();
+					++i;
+					++j;
+				}
+				if (co!=c && !e.is_zero())
+					reduced[co] = e;
+			}
+			remove_content(reduced);
+
+			// update the column index for the changed pattern
+			for (row_type::const_iterator o=r.begin(); o!=r.end() && o->first<n; ++o)
+				if (reduced.find(o->first)==reduced.end())
+					col_rows[o->first].erase(*t);
+			for (row_type::const_iterator o=reduced.begin(); o!=reduced.end() && o->first<n; ++o)
+				col_rows[o->first].insert(*t);
+			r.swap(reduced);
+		}
+	}
+
+	// the remaining rows have no coefficients left, so their right hand
+	// sides must vanish, too
+	for (unsigned r=0; r<row; ++r)
+		if (active[r] && !a[r].empty())
+			throw (std::runtime_error("sparse_matrix::solve(): inconsistent linear system"));
+
+	// back-substitution, unknowns without pivot are free parameters
+	matrix sol(n, p);
+	std::vector<bool> pivoted(n, false);
+	for (std::vector<std::pair<unsigned, unsigned> >::const_iterator pv=pivots.begin(); pv!=pivots.end(); ++pv)
+		pivoted[pv->second] = true;
+	for (unsigned c=0; c<n; ++c)
+		if (!pivoted[c])
+			for (unsigned co=0; co<p; ++co)
+				sol(c,co) = vars(c,co);
+	for (std::vector<std::pair<unsigned, unsigned> >::reverse_iterator pv=pivots.rbegin(); pv!=pivots.rend(); ++pv) {
+		const row_type & r = a[pv->first];
+		const unsigned c = pv->second;
+		for (unsigned co=0; co<p; ++co) {
+			const row_type::const_iterator b = r.find(n+co);
+			ex e = b==r.end() ? _ex0 : b->second;
+			for (row_type::const_iterator i=r.begin(); i!=r.end() && i->first<n; ++i)
+				if (i->first!=c)
+					e -= i->second*sol(i->first,co);
+			sol(c,co) = (e/r.find(c)->second).normal();
+		}
+	}
+
+	if (!srl.empty())
+		for (unsigned c=0; c<n; ++c)
+			for (unsigned co=0; co<p; ++co)
+				sol(c,co) = sol(c,co).subs(srl, subs_options::no_pattern).normal();
+	return sol;
+}
+
+} // namespace GiNaC
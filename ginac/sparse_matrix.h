@@ -0,0 +1,72 @@
+/** @file sparse_matrix.h
+ *
+ *  Interface to sparse matrices and their linear systems. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef GINAC_SPARSE_MATRIX_H
+#define GINAC_SPARSE_MATRIX_H
+
+#include "ex.h"
+#include "matrix.h"
+
+#include <map>
+#include <vector>
+
+namespace GiNaC {
+
+/** Sparse matrix of expressions.  Each row maps the column indices of its
+ *  nonzero entries to the entries, so the memory grows with the number of
+ *  nonzero entries only.  This is meant for large linear systems with few
+ *  unknowns per equation, which are solved by sparse fraction free
+ *  elimination.  Systems that decouple are split into their irreducible
+ *  blocks first.
+ *
+ *  @see sparse_matrix::solve, sparse_matrix::block_solve */
+class sparse_matrix
+{
+public:
+	typedef std::map<unsigned, ex> row_type;
+
+	sparse_matrix(unsigned r, unsigned c);
+	explicit sparse_matrix(const matrix & m);
+
+	unsigned rows() const { return row; }
+	unsigned cols() const { return col; }
+	size_t nnz() const;
+	bool is_sparse() const;
+
+	ex operator()(unsigned ro, unsigned co) const;
+	sparse_matrix & set(unsigned ro, unsigned co, const ex & value);
+	const row_type & row_entries(unsigned ro) const;
+
+	matrix to_matrix() const;
+	matrix solve(const matrix & vars, const matrix & rhs) const;
+	bool block_triangular(std::vector<unsigned> & rows, std::vector<std::vector<unsigned> > & blocks) const;
+	matrix block_solve(const matrix & vars, const matrix & rhs, unsigned algo) const;
+
+private:
+	unsigned row;                ///< number of rows
+	unsigned col;                ///< number of columns
+	std::vector<row_type> m;     ///< nonzero entries of the rows
+};
+
+} // namespace GiNaC
+
+#endif // ndef GINAC_SPARSE_MATRIX_H
@@ -221,6 +221,16 @@ bool symbol::info(unsigned inf) const
 	return inherited::info(inf);
 }
 
+double symbol::evalf_double(const exmap & m) const
+{
+	static const exmap no_values;
+	exmap::const_iterator it = m.find(*this);
+	if (it == m.end())
+		throw(std::runtime_error("evalf_double(): no value given for symbol " + get_name()));
+	// The value is not subject to further substitutions, just like in subs()
+	return it->second.evalf_double(no_values);
+}
+
 ex symbol::conjugate() const
 {
 	return conjugate_function(*this).hold();
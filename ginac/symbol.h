@@ -48,6 +48,7 @@ public:
 	bool info(unsigned inf) const;
 	ex eval(int level = 0) const { return *this; } // for performance reasons
 	ex evalf(int level = 0) const { return *this; } // overwrites basic::evalf() for performance reasons
+	double evalf_double(const exmap & m) const;
 	ex series(const relational & s, int order, unsigned options = 0) const;
 	ex subs(const exmap & m, unsigned options = 0) const { return subs_one_level(m, options); } // overwrites basic::subs() for performance reasons
 	ex normal(exmap & repl, exmap & rev_lookup, int level = 0) const;
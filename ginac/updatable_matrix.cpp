@@ -0,0 +1,174 @@
+/** @file updatable_matrix.cpp
+ *
+ *  Implementation of square matrices with incrementally updated determinant
+ *  and inverse. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "updatable_matrix.h"
+#include "add.h"
+#include "operators.h"
+#include "utils.h"
+
+#include <stdexcept>
+
+namespace GiNaC {
+
+/** Construct from a square matrix, computing its determinant and, if it is
+ *  regular, its inverse.
+ *
+ *  @exception logic_error (matrix not square) */
+updatable_matrix::updatable_matrix(const matrix & m) : mat(m)
+{
+	if (m.rows()!=m.cols())
+		throw (std::logic_error("updatable_matrix::updatable_matrix(): matrix not square"));
+	recompute();
+}
+
+/** Inverse of the matrix.
+ *
+ *  @exception runtime_error (singular matrix) */
+const matrix & updatable_matrix::inverse() const
+{
+	if (det.is_zero())
+		throw (std::runtime_error("updatable_matrix::inverse(): singular matrix"));
+	return inv;
+}
+
+/** Replace the entry in row ro and column co.  This is a replacement of the
+ *  row ro.
+ *
+ *  @exception range_error (index out of range) */
+updatable_matrix & updatable_matrix::set(unsigned ro, unsigned co, const ex & value)
+{
+	if (ro>=rows() || co>=cols())
+		throw (std::range_error("updatable_matrix::set(): index out of range"));
+	matrix values(1, cols());
+	for (unsigned c=0; c<cols(); ++c)
+		values(0,c) = c==co ? value : mat(ro,c);
+	return set_row(ro, values);
+}
+
+/** Replace the row ro by the 1 x n matrix values.  The new matrix differs
+ *  by e_ro*v^T, where v is the difference of the rows, and y = values*A^-1
+ *  gives the new determinant det*y[ro] and y - e_ro^T = v^T*A^-1 for the
+ *  Sherman-Morrison formula.
+ *
+ *  @exception range_error (index out of range)
+ *  @exception logic_error (incompatible matrices) */
+updatable_matrix & updatable_matrix::set_row(unsigned ro, const matrix & values)
+{
+	const unsigned n = rows();
+	if (ro>=n)
+		throw (std::range_error("updatable_matrix::set_row(): index out of range"));
+	if (values.rows()!=1 || values.cols()!=n)
+		throw (std::logic_error("updatable_matrix::set_row(): incompatible matrices"));
+
+	const bool regular = !det.is_zero();
+	for (unsigned c=0; c<n; ++c)
+		mat(ro,c) = values(0,c);
+	if (!regular) {
+		recompute();
+		return *this;
+	}
+
+	exvector w(n), z(n);
+	for (unsigned j=0; j<n; ++j) {
+		exvector terms;
+		for (unsigned k=0; k<n; ++k)
+			if (!values(0,k).is_zero() && !inv(k,j).is_zero())
+				terms.push_back(values(0,k)*inv(k,j));
+		z[j] = (new add(terms))->setflag(status_flags::dynallocated);
+		z[j] = z[j].normal();
+		w[j] = inv(j,ro);
+	}
+	const ex f = z[ro];
+	z[ro] -= _ex1;
+	update(w, z, f);
+	return *this;
+}
+
+/** Replace the column co by the n x 1 matrix values.  The new matrix
+ *  differs by u*e_co^T, where u is the difference of the columns, and
+ *  y = A^-1*values gives the new determinant det*y[co] and y - e_co = A^-1*u
+ *  for the Sherman-Morrison formula.
+ *
+ *  @exception range_error (index out of range)
+ *  @exception logic_error (incompatible matrices) */
+updatable_matrix & updatable_matrix::set_col(unsigned co, const matrix & values)
+{
+	const unsigned n = rows();
+	if (co>=n)
+		throw (std::range_error("updatable_matrix::set_col(): index out of range"));
+	if (values.rows()!=n || values.cols()!=1)
+		throw (std::logic_error("updatable_matrix::set_col(): incompatible matrices"));
+
+	const bool regular = !det.is_zero();
+	for (unsigned r=0; r<n; ++r)
+		mat(r,co) = values(r,0);
+	if (!regular) {
+		recompute();
+		return *this;
+	}
+
+	exvector w(n), z(n);
+	for (unsigned i=0; i<n; ++i) {
+		exvector terms;
+		for (unsigned k=0; k<n; ++k)
+			if (!inv(i,k).is_zero() && !values(k,0).is_zero())
+				terms.push_back(inv(i,k)*values(k,0));
+		w[i] = (new add(terms))->setflag(status_flags::dynallocated);
+		w[i] = w[i].normal();
+		z[i] = inv(co,i);
+	}
+	const ex f = w[co];
+	w[co] -= _ex1;
+	update(w, z, f);
+	return *this;
+}
+
+/** Compute determinant and inverse from scratch. */
+void updatable_matrix::recompute()
+{
+	det = mat.determinant();
+	if (!det.is_zero())
+		inv = mat.inverse();
+}
+
+/** Sherman-Morrison update of the inverse by the rank one matrix w*z^T,
+ *  divided by the factor f of the determinant:
+ *  (A + a*b^T)^-1 = A^-1 - A^-1*a*b^T*A^-1 / (1 + b^T*A^-1*a),
+ *  with w = A^-1*a, z^T = b^T*A^-1 and f = 1 + b^T*A^-1*a. */
+void updatable_matrix::update(const exvector & w, const exvector & z, const ex & f)
+{
+	const unsigned n = rows();
+	det = (det*f).normal();
+	if (det.is_zero())
+		return;
+	for (unsigned i=0; i<n; ++i) {
+		if (w[i].is_zero())
+			continue;
+		const ex wf = (w[i]/f).normal();
+		for (unsigned j=0; j<n; ++j)
+			if (!z[j].is_zero())
+				inv(i,j) = (inv(i,j) - wf*z[j]).normal();
+	}
+}
+
+} // namespace GiNaC
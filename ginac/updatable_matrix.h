@@ -0,0 +1,69 @@
+/** @file updatable_matrix.h
+ *
+ *  Interface to square matrices with incrementally updated determinant and
+ *  inverse. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef GINAC_UPDATABLE_MATRIX_H
+#define GINAC_UPDATABLE_MATRIX_H
+
+#include "ex.h"
+#include "matrix.h"
+
+namespace GiNaC {
+
+/** Square matrix which keeps its determinant and inverse up to date while
+ *  single rows, columns or entries are replaced.  Such a replacement adds a
+ *  matrix of rank one, so the new determinant follows from the matrix
+ *  determinant lemma and the new inverse from the Sherman-Morrison formula,
+ *  each with O(n^2) operations on the entries instead of the O(n^3) of a
+ *  computation from scratch.  Only when the matrix becomes singular, the
+ *  inverse is lost and recomputed with the next regular matrix.
+ *
+ *  @see matrix::determinant, matrix::inverse */
+class updatable_matrix
+{
+public:
+	explicit updatable_matrix(const matrix & m);
+
+	unsigned rows() const { return mat.rows(); }
+	unsigned cols() const { return mat.cols(); }
+	const matrix & get_matrix() const { return mat; }
+	const ex & operator()(unsigned ro, unsigned co) const { return mat(ro, co); }
+
+	const ex & determinant() const { return det; }
+	const matrix & inverse() const;
+
+	updatable_matrix & set(unsigned ro, unsigned co, const ex & value);
+	updatable_matrix & set_row(unsigned ro, const matrix & values);
+	updatable_matrix & set_col(unsigned co, const matrix & values);
+
+private:
+	void recompute();
+	void update(const exvector & w, const exvector & z, const ex & f);
+
+	matrix mat;                  ///< the matrix itself
+	matrix inv;                  ///< its inverse, if it is regular
+	ex det;                      ///< its determinant
+};
+
+} // namespace GiNaC
+
+#endif // ndef GINAC_UPDATABLE_MATRIX_H
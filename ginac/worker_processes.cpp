@@ -0,0 +1,211 @@
+/** @file worker_processes.cpp
+ *
+ *  Implementation of the worker processes that carry out independent parts
+ *  of a computation concurrently. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "worker_processes.h"
+#include "archive.h"
+#include "symbol.h"
+#include "tostring.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#if defined(HAVE_UNISTD_H) && !defined(_WIN32)
+#define GINAC_WORKER_PROCESSES 1
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace GiNaC {
+
+unsigned processor_count()
+{
+#ifdef GINAC_WORKER_PROCESSES
+	const long online = sysconf(_SC_NPROCESSORS_ONLN);
+	if (online > 0)
+		return unsigned(online);
+#endif
+	return 1;
+}
+
+bool have_worker_processes()
+{
+#ifdef GINAC_WORKER_PROCESSES
+	return true;
+#else
+	return false;
+#endif
+}
+
+static void collect_symbols(const ex & e, exset & syms)
+{
+	if (is_a<symbol>(e)) {
+		syms.insert(e);
+		return;
+	}
+	for (size_t i=0; i<e.nops(); ++i)
+		collect_symbols(e.op(i), syms);
+}
+
+bool collect_worker_symbols(const exvector & exprs, lst & syms)
+{
+	exset found;
+	for (exvector::const_iterator it=exprs.begin(); it!=exprs.end(); ++it)
+		collect_symbols(*it, found);
+	std::set<std::string> names;
+	for (exset::const_iterator it=found.begin(); it!=found.end(); ++it) {
+		syms.append(*it);
+		names.insert(ex_to<symbol>(*it).get_name());
+	}
+	return names.size() == found.size();
+}
+
+#ifdef GINAC_WORKER_PROCESSES
+
+/** Compute the jobs w, w+k, w+2k, ... and archive the results of each of
+ *  them as a list under the number of the job. */
+static std::string work(worker_jobs & jobs, size_t n, size_t w, size_t k)
+{
+	archive ar;
+	for (size_t i=w; i<n; i+=k) {
+		try {
+			const exvector res = jobs.compute(i);
+			lst l;
+			for (exvector::const_iterator it=res.begin(); it!=res.end(); ++it)
+				l.append(*it);
+			ar.archive_ex(l, ToString(i).c_str());
+		} catch (...) {
+			// left to the caller, which reports the error
+		}
+	}
+	std::ostringstream os;
+	os << ar;
+	return os.str();
+}
+
+static bool write_all(int fd, const std::string & data)
+{
+	size_t done = 0;
+	while (done < data.size()) {
+		const ssize_t n = write(fd, data.data() + done, data.size() - done);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		done += n;
+	}
+	return true;
+}
+
+static std::string read_all(int fd)
+{
+	std::string data;
+	char buf[4096];
+	for (;;) {
+		const ssize_t n = read(fd, buf, sizeof(buf));
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return data;
+		data.append(buf, n);
+	}
+}
+
+#endif // def GINAC_WORKER_PROCESSES
+
+size_t compute_in_processes(worker_jobs & jobs, size_t n, unsigned processes, const lst & syms,
+                            std::vector<exvector> & results, std::vector<bool> & done)
+{
+	results.assign(n, exvector());
+	done.assign(n, false);
+	size_t count = 0;
+#ifdef GINAC_WORKER_PROCESSES
+	if (processes == 0)
+		processes = processor_count();
+	const size_t k = std::min(size_t(processes), n);
+	std::vector<pid_t> pids;
+	std::vector<int> fds;
+	for (size_t w=0; w<k; ++w) {
+		int fd[2];
+		if (pipe(fd) != 0)
+			break;
+		const pid_t pid = fork();
+		if (pid == 0) {
+			// _exit() leaves the buffers and static objects of the
+			// parent alone
+			close(fd[0]);
+			const bool ok = write_all(fd[1], work(jobs, n, w, k));
+			_exit(ok ? 0 : 1);
+		}
+		close(fd[1]);
+		if (pid < 0) {
+			close(fd[0]);
+			break;
+		}
+		pids.push_back(pid);
+		fds.push_back(fd[0]);
+	}
+
+	// Workers write their results in one go when they are done, so reading
+	// them one after the other does not hold up the others
+	for (size_t w=0; w<pids.size(); ++w) {
+		const std::string data = read_all(fds[w]);
+		close(fds[w]);
+		int status = 0;
+		pid_t waited;
+		while ((waited = waitpid(pids[w], &status, 0)) < 0 && errno == EINTR)
+			;
+		// e.g. ECHILD if SIGCHLD is ignored: the exit status is unknown
+		if (waited != pids[w] || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			continue;
+		try {
+			std::istringstream is(data);
+			archive ar;
+			is >> ar;
+			for (unsigned j=0; j<ar.num_expressions(); ++j) {
+				std::string name;
+				const ex l = ar.unarchive_ex(syms, name, j);
+				size_t i = n;
+				std::istringstream(name) >> i;
+				if (i >= n || done[i] || !is_a<lst>(l))
+					continue;
+				results[i].assign(l.begin(), l.end());
+				done[i] = true;
+				++count;
+			}
+		} catch (std::exception &) {
+			// the caller computes what is missing
+		}
+	}
+#endif // def GINAC_WORKER_PROCESSES
+	return count;
+}
+
+} // namespace GiNaC
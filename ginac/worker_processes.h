@@ -0,0 +1,79 @@
+/** @file worker_processes.h
+ *
+ *  Interface to the worker processes that carry out independent parts of a
+ *  computation concurrently. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef GINAC_WORKER_PROCESSES_H
+#define GINAC_WORKER_PROCESSES_H
+
+#include "ex.h"
+#include "lst.h"
+
+#include <vector>
+
+namespace GiNaC {
+
+/** Independent jobs for worker processes.  Reference counting of
+ *  expressions and numbers is not thread safe, and neither are the tables
+ *  of the numerical kernels, so concurrent work is done in forked processes
+ *  instead of threads.  Every worker has its own copy of all objects, may
+ *  modify them freely and sends its results back in archived form. */
+class worker_jobs
+{
+public:
+	virtual ~worker_jobs() {}
+
+	/** Compute the results of job i.  This is called in a worker process. */
+	virtual exvector compute(size_t i) = 0;
+};
+
+/** Number of processors online, at least 1. */
+unsigned processor_count();
+
+/** Check whether worker processes can be started on this system. */
+bool have_worker_processes();
+
+/** Collect the symbols occurring in the expressions into syms, for
+ *  unarchiving results of workers that may contain them.
+ *
+ *  @return false if two different symbols share a name, in which case the
+ *    results cannot be matched with them */
+bool collect_worker_symbols(const exvector & exprs, lst & syms);
+
+/** Compute the jobs 0, ..., n-1 in up to the given number of worker
+ *  processes, 0 meaning one per processor.  Jobs that throw, whose worker
+ *  fails or cannot be started are left out; the caller computes those
+ *  itself.  The results are unarchived with the symbols in syms, which must
+ *  contain every symbol that may occur in them, each under its own name.
+ *
+ *  @param jobs  jobs to compute
+ *  @param n  number of jobs
+ *  @param processes  number of worker processes
+ *  @param syms  symbols occuring in the results
+ *  @param results  on return, results[i] holds the results of job i
+ *  @param done  on return, done[i] tells whether job i was computed
+ *  @return number of jobs computed */
+size_t compute_in_processes(worker_jobs & jobs, size_t n, unsigned processes, const lst & syms,
+                            std::vector<exvector> & results, std::vector<bool> & done);
+
+} // namespace GiNaC
+
+#endif // ndef GINAC_WORKER_PROCESSES_H